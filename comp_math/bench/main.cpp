@@ -0,0 +1,496 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <cstdint>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <span>
+#include <filesystem>
+
+#include "matrix.h"
+#include "gemm.h"
+#include "elimination.h"
+#include "lu.h"
+#include "tridiagonal.h"
+#include "spline.h"
+#include "quadrature.h"
+#include "ode.h"
+#include "thread_pool.h"
+#include "binary_io.h"
+#include "chebyshev.h"
+
+// Замеры производительности ядер comp_math по размерам задачи и числу потоков.
+// Каждый замер повторяет ядро, пока не наберется min_time секунд, и выводит время на итерацию,
+// GFLOP/s и байты на элемент результата по модели ядра (минимальный объем чтения и записи), а также
+// число вычислений функции на итерацию для квадратур и ОДУ.
+// Лабораторные обертки (multiply, LU_dec, solve_lu, solve_tridiagonal) - тонкий слой над этими ядрами,
+// поэтому замеряются сами ядра из common/.
+//
+// Запуск: comp_math_bench [--filter=подстрока] [--sizes=n1,n2,...] [--threads=t1,t2,...]
+//                         [--min-time=секунды] [--csv] [--list]
+
+// Состояние одного замера: размер задачи, число потоков и счетчики работы одной итерации
+class BenchState {
+public:
+    BenchState(std::size_t size, std::size_t threads, double min_time)
+        : size_(size), threads_(threads), min_time_(min_time) {}
+
+    std::size_t size() const { return size_; }
+    std::size_t threads() const { return threads_; }
+
+    // Цикл замера: while (state.keep_running()) { ... }. Подготовка до цикла в замер не входит.
+    bool keep_running() {
+        const auto now = std::chrono::steady_clock::now();
+        if (iterations_ == 0) {
+            start_ = now;
+        } else {
+            elapsed_ = std::chrono::duration<double>(now - start_).count();
+            if (elapsed_ >= min_time_) return false;
+        }
+        ++iterations_;
+        return true;
+    }
+
+    // Модель работы одной итерации
+    void set_flops(double flops) { flops_ = flops; }
+    void set_bytes(double bytes) { bytes_ = bytes; }
+    void set_elements(double elements) { elements_ = elements; }
+    void set_evaluations(long long evaluations) { evaluations_ = evaluations; }
+
+    long long iterations() const { return iterations_; }
+    double seconds_per_iteration() const { return iterations_ > 0 ? elapsed_ / iterations_ : 0.0; }
+    double gflops() const { return elapsed_ > 0.0 ? flops_ * iterations_ / elapsed_ * 1e-9 : 0.0; }
+    double bytes_per_element() const { return elements_ > 0.0 ? bytes_ / elements_ : 0.0; }
+    long long evaluations() const { return evaluations_; }
+
+private:
+    std::size_t size_;
+    std::size_t threads_;
+    double min_time_;
+    long long iterations_ = 0;
+    double elapsed_ = 0.0;
+    std::chrono::steady_clock::time_point start_;
+    double flops_ = 0.0;
+    double bytes_ = 0.0;
+    double elements_ = 0.0;
+    long long evaluations_ = -1; // -1 - не применимо
+};
+
+struct BenchCase {
+    const char* name;
+    std::vector<std::size_t> default_sizes;
+    std::function<void(BenchState&)> run;
+    std::size_t min_size = 1; // Меньшие размеры из --sizes пропускаются
+};
+
+// Результат ядра, который компилятор не может выбросить
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Воспроизводимое заполнение (линейный конгруэнтный генератор)
+inline double bench_random(std::uint64_t& seed) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<double>(seed >> 11) * (1.0 / 9007199254740992.0) - 0.5;
+}
+
+// Матрица с диагональным преобладанием (для Гаусса и LU без вырождения)
+Matrix bench_matrix(std::size_t n, std::uint64_t seed) {
+    Matrix A(n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        double* row = A.row_data(i);
+        for (std::size_t j = 0; j < n; ++j) row[j] = bench_random(seed);
+        row[i] += static_cast<double>(n);
+    }
+    return A;
+}
+
+std::vector<double> bench_vector(std::size_t n, std::uint64_t seed) {
+    std::vector<double> v(n);
+    for (double& value : v) value = bench_random(seed);
+    return v;
+}
+
+// Подынтегральная функция лабораторной 4: f(x) = (x+3) / (x^2+4), примерно 5 операций
+double bench_integrand(double x) {
+    return (x + 3.0) / (x * x + 4.0);
+}
+constexpr double INTEGRAND_FLOPS = 5.0;
+
+// Пул потоков для параллельных квадратур (nullptr при одном потоке - последовательное суммирование)
+ThreadPool* bench_pool(const BenchState& state) {
+    return state.threads() > 1 ? &default_thread_pool() : nullptr;
+}
+
+// --- Плотная линейная алгебра ---
+
+void bench_multiply(BenchState& state) {
+    const std::size_t n = state.size();
+    const Matrix A = bench_matrix(n, 1), B = bench_matrix(n, 2);
+    Matrix C(n, n);
+    while (state.keep_running()) {
+        gemm(n, n, n, 1.0, A.data(), A.stride(), B.data(), B.stride(), 0.0, C.data(), C.stride());
+        keep(C(0, 0));
+    }
+    state.set_flops(2.0 * n * n * n);
+    state.set_bytes(3.0 * n * n * sizeof(double)); // Чтение A, B и запись C
+    state.set_elements(static_cast<double>(n) * n);
+}
+
+void bench_gauss(BenchState& state) {
+    const std::size_t n = state.size();
+    const Matrix A = bench_matrix(n, 3);
+    const std::vector<double> b = bench_vector(n, 4);
+    while (state.keep_running()) {
+        keep(gauss(A, b)[0]);
+    }
+    state.set_flops(2.0 / 3.0 * n * n * n + 2.0 * n * n);
+    state.set_bytes(2.0 * n * n * sizeof(double)); // Копия A и проход исключения
+    state.set_elements(static_cast<double>(n) * n);
+}
+
+void bench_lu_decompose(BenchState& state) {
+    const std::size_t n = state.size();
+    const Matrix A = bench_matrix(n, 5);
+    while (state.keep_running()) {
+        LUFactorization<double> lu(A);
+        keep(lu.size());
+    }
+    state.set_flops(2.0 / 3.0 * n * n * n);
+    state.set_bytes(2.0 * n * n * sizeof(double)); // Копия A и запись L, U
+    state.set_elements(static_cast<double>(n) * n);
+}
+
+void bench_lu_solve(BenchState& state) {
+    const std::size_t n = state.size();
+    const LUFactorization<double> lu(bench_matrix(n, 6));
+    const std::vector<double> b = bench_vector(n, 7);
+    while (state.keep_running()) {
+        keep(lu.solve(b)[0]);
+    }
+    state.set_flops(2.0 * n * n);
+    state.set_bytes((static_cast<double>(n) * n + 2.0 * n) * sizeof(double)); // L, U, b и x
+    state.set_elements(static_cast<double>(n));
+}
+
+// Открытие двоичного файла с плотной матрицей n x n (отображение в память) и чтение одного элемента;
+// время не должно зависеть от n
+void bench_binary_load(BenchState& state) {
+    const std::size_t n = state.size();
+    const std::string path = (std::filesystem::temp_directory_path() / "comp_math_bench_matrix.bin").string();
+    write_binary_matrix(path, bench_matrix(n, 12));
+    while (state.keep_running()) {
+        const BinaryFile file(path);
+        keep(file.matrix<double>()(n - 1, n - 1));
+    }
+    std::filesystem::remove(path);
+    state.set_bytes(0.0);
+    state.set_elements(static_cast<double>(n) * n);
+}
+
+// --- Прогонка ---
+
+void bench_tridiagonal(BenchState& state, TridiagonalEngine engine) {
+    const std::size_t n = state.size();
+    std::vector<double> sub = bench_vector(n - 1, 8), super = bench_vector(n - 1, 9);
+    std::vector<double> diag(n, 4.0);
+    const std::vector<double> rhs = bench_vector(n, 10);
+    std::vector<double> x(n);
+    TridiagonalWorkspace<double> workspace;
+    while (state.keep_running()) {
+        solve_tridiagonal_system(n, sub.data(), diag.data(), super.data(), rhs.data(), x.data(), workspace, engine);
+        keep(x[0]);
+    }
+    state.set_flops(8.0 * n);
+    state.set_bytes(7.0 * n * sizeof(double)); // a, b, c, d, x и запись/чтение c'
+    state.set_elements(static_cast<double>(n));
+}
+
+// --- Кубический сплайн ---
+
+void bench_spline_build(BenchState& state) {
+    const std::size_t n = state.size();
+    std::vector<double> y(n);
+    for (std::size_t i = 0; i < n; ++i) y[i] = std::sin(3.0 * i / (n - 1));
+    SplineData spline;
+    SplineWorkspace workspace;
+    while (state.keep_running()) {
+        build_natural_cubic_spline(spline, 0.0, 3.0, y, workspace);
+        keep(spline.coeffs[0]);
+    }
+    state.set_flops(25.0 * n); // Правая часть, прогонка и коэффициенты интервалов
+    state.set_bytes(9.0 * n * sizeof(double)); // y, x, M и 4 коэффициента, проходы прогонки
+    state.set_elements(static_cast<double>(n));
+}
+
+void bench_spline_evaluate(BenchState& state) {
+    constexpr std::size_t nodes = 1024;
+    const std::size_t points = state.size();
+    std::vector<double> y(nodes);
+    for (std::size_t i = 0; i < nodes; ++i) y[i] = std::sin(3.0 * i / (nodes - 1));
+    SplineData spline;
+    SplineWorkspace workspace;
+    build_natural_cubic_spline(spline, 0.0, 3.0, y, workspace);
+    std::vector<double> xs(points), out(points);
+    std::uint64_t seed = 11;
+    for (double& x : xs) x = 1.5 + 3.0 * bench_random(seed);
+    while (state.keep_running()) {
+        evaluate_spline(spline, xs, out);
+        keep(out[0]);
+    }
+    state.set_flops(10.0 * points); // Номер интервала и схема Горнера
+    state.set_bytes(2.0 * points * sizeof(double)); // Точка и значение; коэффициенты в кэше
+    state.set_elements(static_cast<double>(points));
+}
+
+void bench_chebyshev_evaluate(BenchState& state) {
+    const std::size_t points = state.size();
+    const ChebyshevApproximation approx = build_chebyshev([](double x) { return std::sin(3.0 * x); }, 0.0, 3.0, 1e-12);
+    std::vector<double> xs(points), out(points);
+    std::uint64_t seed = 13;
+    for (double& x : xs) x = 1.5 + 3.0 * bench_random(seed);
+    while (state.keep_running()) {
+        evaluate_chebyshev(approx, xs.data(), out.data(), points);
+        keep(out[0]);
+    }
+    state.set_flops((3.0 * approx.degree() + 8.0) * points); // Номер куска, координата и схема Кленшоу
+    state.set_bytes(2.0 * points * sizeof(double)); // Точка и значение; коэффициенты в кэше
+    state.set_elements(static_cast<double>(points));
+}
+
+// --- Квадратуры ---
+
+// Число вычислений функции одним (непараллельным) вызовом rule(f); в замер не входит
+template <typename Rule>
+long long count_evaluations(Rule&& rule) {
+    long long evaluations = 0;
+    rule([&evaluations](double x) { ++evaluations; return bench_integrand(x); });
+    return evaluations;
+}
+
+template <typename Rule>
+void bench_quadrature_rule(BenchState& state, Rule&& rule) {
+    const int n = static_cast<int>(state.size());
+    ThreadPool* pool = bench_pool(state);
+    const long long evaluations = count_evaluations([&](auto&& f) { return rule(f, n, nullptr); });
+    while (state.keep_running()) {
+        keep(rule(bench_integrand, n, pool));
+    }
+    state.set_evaluations(evaluations);
+    state.set_flops((INTEGRAND_FLOPS + 1.0) * evaluations);
+    state.set_bytes(0.0); // Узлы вычисляются, память не читается
+    state.set_elements(static_cast<double>(evaluations));
+}
+
+// Правило Рунге: размер задачи - 1/epsilon
+template <typename Rule>
+void bench_runge(BenchState& state, Rule&& rule, int p) {
+    const double epsilon = 1.0 / static_cast<double>(state.size());
+    int n_final = 0;
+    const long long evaluations = count_evaluations([&](auto&& f) {
+        return integrate_with_runge([&](double a, double b, int n) { return rule(f, a, b, n); },
+                                    0.0, 2.0, epsilon, p, n_final);
+    });
+    while (state.keep_running()) {
+        keep(integrate_with_runge([&](double a, double b, int n) { return rule(bench_integrand, a, b, n); },
+                                  0.0, 2.0, epsilon, p, n_final));
+    }
+    state.set_evaluations(evaluations);
+    state.set_flops((INTEGRAND_FLOPS + 1.0) * evaluations);
+    state.set_bytes(0.0);
+    state.set_elements(static_cast<double>(evaluations));
+}
+
+// --- ОДУ ---
+
+// Система размерности n: y_j' = -(1 + j/n) y_j + sin(x), примерно 4 операции на компоненту
+template <typename Stepper>
+void bench_ode(BenchState& state, const Stepper& stepper) {
+    const std::size_t n = state.size();
+    auto rhs = [n](double x, std::span<const double> y, std::span<double> dy) {
+        const double forcing = std::sin(x);
+        for (std::size_t j = 0; j < n; ++j) {
+            dy[j] = -(1.0 + static_cast<double>(j) / n) * y[j] + forcing;
+        }
+    };
+    const std::vector<double> y0(n, 1.0);
+    OdeWorkspace ws(n);
+    OdeStats stats;
+    while (state.keep_running()) {
+        stats = solve_ode_auto_step(stepper, rhs, 0.0, std::span<const double>(y0), 2.0, 0.1, 1e-6,
+                                    [](const OdeStep&) {}, ws);
+        keep(stats.f_evaluations);
+    }
+    state.set_evaluations(stats.f_evaluations);
+    state.set_flops(4.0 * n * stats.f_evaluations);
+    // Каждое вычисление f читает y и пишет стадию; шаги читают и пишут векторы стадий еще раз
+    state.set_bytes(4.0 * n * stats.f_evaluations * sizeof(double));
+    state.set_elements(static_cast<double>(n) * stats.f_evaluations);
+}
+
+std::vector<BenchCase> bench_cases() {
+    const std::vector<std::size_t> dense = {64, 128, 256, 512};
+    const std::vector<std::size_t> linear = {1024, 65536, 1048576};
+    const std::vector<std::size_t> quadrature = {1000, 100000, 10000000};
+    const std::vector<std::size_t> runge = {1000, 1000000, 1000000000};
+    const std::vector<std::size_t> ode = {2, 64, 1024};
+    return {
+        {"multiply", dense, bench_multiply},
+        {"gauss", dense, bench_gauss},
+        {"LU_dec", dense, bench_lu_decompose},
+        {"solve_lu", dense, bench_lu_solve},
+        {"BinaryFile/matrix", {256, 1024, 4096}, bench_binary_load},
+        {"solve_tridiagonal/thomas", linear,
+         [](BenchState& s) { bench_tridiagonal(s, TridiagonalEngine::Thomas); }, 2},
+        {"solve_tridiagonal/partitioned", linear,
+         [](BenchState& s) { bench_tridiagonal(s, TridiagonalEngine::Partitioned); }, 2},
+        {"build_natural_cubic_spline", linear, bench_spline_build, 3},
+        {"evaluate_spline", linear, bench_spline_evaluate},
+        {"evaluate_chebyshev", linear, bench_chebyshev_evaluate},
+        {"central_rectangles", quadrature, [](BenchState& s) {
+             bench_quadrature_rule(s, [](auto&& f, int n, ThreadPool* pool) {
+                 return central_rectangles(f, 0.0, 2.0, n, pool);
+             });
+         }},
+        {"trapezoidal_rule", quadrature, [](BenchState& s) {
+             bench_quadrature_rule(s, [](auto&& f, int n, ThreadPool* pool) {
+                 return trapezoidal_rule(f, 0.0, 2.0, n, pool);
+             });
+         }},
+        {"simpsons_rule", quadrature, [](BenchState& s) {
+             bench_quadrature_rule(s, [](auto&& f, int n, ThreadPool* pool) {
+                 return simpsons_rule(f, 0.0, 2.0, n, pool);
+             });
+         }},
+        {"simpsons_rule/batch", quadrature, [](BenchState& s) {
+             bench_quadrature_rule(s, [](auto&& f, int n, ThreadPool* pool) {
+                 // Пакетная функция: цикл по точкам блока векторизуется
+                 auto batch = batch_integrand([&f](const double* xs, double* fx, std::size_t count) {
+                     for (std::size_t k = 0; k < count; ++k) fx[k] = f(xs[k]);
+                 });
+                 return simpsons_rule(batch, 0.0, 2.0, n, pool);
+             });
+         }},
+        {"integrate_with_runge/trapezoidal", runge, [](BenchState& s) {
+             bench_runge(s, [](auto&& f, double a, double b, int n) { return trapezoidal_rule(f, a, b, n); }, 2);
+         }},
+        {"integrate_with_runge/simpson", runge, [](BenchState& s) {
+             bench_runge(s, [](auto&& f, double a, double b, int n) { return simpsons_rule(f, a, b, n); }, 4);
+         }},
+        {"solve_ode_auto_step/euler_cauchy", ode,
+         [](BenchState& s) { bench_ode(s, EulerCauchyStepper{}); }},
+        {"solve_ode_auto_step/rk4", ode,
+         [](BenchState& s) { bench_ode(s, RungeKutta4Stepper{}); }},
+    };
+}
+
+// Список чисел через запятую: "64,128,256"
+std::vector<std::size_t> parse_list(const std::string& text) {
+    std::vector<std::size_t> values;
+    std::size_t begin = 0;
+    while (begin < text.size()) {
+        std::size_t end = text.find(',', begin);
+        if (end == std::string::npos) end = text.size();
+        if (end > begin) values.push_back(static_cast<std::size_t>(std::stoull(text.substr(begin, end - begin))));
+        begin = end + 1;
+    }
+    return values;
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::vector<std::size_t> sizes;
+    std::vector<std::size_t> threads = {1, default_thread_count()};
+    double min_time = 0.2;
+    bool csv = false;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&arg](const char* key) -> const char* {
+            const std::size_t length = std::char_traits<char>::length(key);
+            return arg.compare(0, length, key) == 0 ? arg.c_str() + length : nullptr;
+        };
+        try {
+            if (const char* filter_arg = value("--filter=")) filter = filter_arg;
+            else if (const char* sizes_arg = value("--sizes=")) sizes = parse_list(sizes_arg);
+            else if (const char* threads_arg = value("--threads=")) threads = parse_list(threads_arg);
+            else if (const char* time_arg = value("--min-time=")) min_time = std::stod(time_arg);
+            else if (arg == "--csv") csv = true;
+            else if (arg == "--list") list = true;
+            else throw std::invalid_argument(arg);
+        } catch (const std::exception&) {
+            std::cerr << "Неизвестный или некорректный аргумент: " << arg << std::endl;
+            return 1;
+        }
+    }
+    threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+    const std::vector<BenchCase> cases = bench_cases();
+    if (list) {
+        for (const BenchCase& c : cases) std::cout << c.name << std::endl;
+        return 0;
+    }
+
+    if (csv) {
+        std::cout << "name,size,threads,iterations,seconds_per_iteration,gflops,bytes_per_element,evaluations" << std::endl;
+    } else {
+        std::cout << std::left << std::setw(34) << "benchmark" << std::right << std::setw(12) << "size"
+                  << std::setw(8) << "threads" << std::setw(10) << "iters" << std::setw(14) << "time/iter"
+                  << std::setw(10) << "GFLOP/s" << std::setw(10) << "B/elem" << std::setw(12) << "evals" << std::endl;
+    }
+
+    for (const std::size_t thread_count : threads) {
+        if (thread_count == 0) continue;
+        set_default_thread_pool_size(thread_count);
+        for (const BenchCase& c : cases) {
+            if (!filter.empty() && std::string(c.name).find(filter) == std::string::npos) continue;
+            for (const std::size_t size : sizes.empty() ? c.default_sizes : sizes) {
+                if (size < c.min_size) {
+                    std::cerr << c.name << " [" << size << "]: пропущен, минимальный размер " << c.min_size
+                              << std::endl;
+                    continue;
+                }
+                BenchState state(size, thread_count, min_time);
+                try {
+                    c.run(state);
+                } catch (const std::exception& e) {
+                    std::cerr << c.name << " [" << size << "]: ошибка: " << e.what() << std::endl;
+                    continue;
+                }
+
+                if (csv) {
+                    std::cout << c.name << "," << size << "," << thread_count << "," << state.iterations() << ","
+                              << std::scientific << std::setprecision(6) << state.seconds_per_iteration() << ","
+                              << state.gflops() << "," << state.bytes_per_element() << "," << state.evaluations()
+                              << std::endl;
+                    continue;
+                }
+
+                // Время итерации в удобных единицах
+                const double seconds = state.seconds_per_iteration();
+                std::ostringstream time;
+                time << std::fixed << std::setprecision(2);
+                if (seconds >= 1e-1) time << seconds << " s";
+                else if (seconds >= 1e-4) time << seconds * 1e3 << " ms";
+                else time << seconds * 1e6 << " us";
+
+                std::cout << std::left << std::setw(34) << c.name << std::right << std::setw(12) << size
+                          << std::setw(8) << thread_count << std::setw(10) << state.iterations()
+                          << std::setw(14) << time.str() << std::fixed << std::setprecision(2)
+                          << std::setw(10) << state.gflops() << std::setw(10) << state.bytes_per_element()
+                          << std::setw(12);
+                if (state.evaluations() >= 0) std::cout << state.evaluations();
+                else std::cout << "-";
+                std::cout << std::endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,433 @@
+#ifndef COMP_MATH_BINARY_IO_H
+#define COMP_MATH_BINARY_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>      // Для std::memcpy, std::memcmp
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>    // Для std::runtime_error, std::invalid_argument
+#include <type_traits>  // Для std::is_same
+#include <utility>      // Для std::move, std::exchange
+
+#if defined(__unix__) || defined(__APPLE__)
+#define COMP_MATH_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define COMP_MATH_MMAP 0
+#endif
+
+#include "matrix.h"
+#include "sparse.h"
+
+// Двоичный формат матриц и векторов для больших систем.
+// Файл - заголовок BinaryHeader (128 байт) и секции данных, каждая с выровненного на 64 байта смещения:
+//   Dense  - матрица rows x cols построчно с длиной строки stride (как в DenseMatrix);
+//   Vector - вектор длины rows (cols = 1);
+//   Csr    - разреженная матрица: row_ptr (uint64, rows + 1), col_idx (uint32, nonzeros), values (nonzeros).
+// Числа хранятся в порядке байтов машины, записавшей файл (поле endian проверяется при чтении).
+// BinaryFile отображает файл в память (mmap): плотная матрица и вектор читаются без копирования
+// (matrix<T>() и vector<T>() - представления над отображением), страницы подгружаются по мере обращения.
+// Разреженная матрица собирается в CsrMatrix одним копированием каждого массива.
+// BinaryRowWriter дописывает строки в файл формата Dense по мере вычисления (траектории ОДУ и т.п.).
+
+enum class BinaryDtype : std::uint32_t { Float32 = 1, Float64 = 2 };
+enum class BinaryLayout : std::uint32_t { Dense = 1, Vector = 2, Csr = 3 };
+
+constexpr char BINARY_MAGIC[8] = {'C', 'M', 'A', 'T', 'H', 'B', 'I', 'N'};
+constexpr std::uint32_t BINARY_VERSION = 1;
+constexpr std::uint32_t BINARY_ENDIAN_TAG = 0x01020304;
+constexpr std::size_t BINARY_SECTION_ALIGNMENT = 64;
+
+struct BinaryHeader {
+    char magic[8];
+    std::uint32_t version;
+    BinaryDtype dtype;
+    BinaryLayout layout;
+    std::uint32_t endian;
+    std::uint64_t rows;
+    std::uint64_t cols;
+    std::uint64_t stride;          // Dense: расстояние между строками в элементах
+    std::uint64_t nonzeros;        // Csr: число ненулевых элементов
+    std::uint64_t data_offset;     // Dense/Vector: элементы; Csr: values
+    std::uint64_t row_ptr_offset;  // Csr
+    std::uint64_t col_idx_offset;  // Csr
+    std::uint64_t reserved[6];
+};
+static_assert(sizeof(BinaryHeader) == 128, "Размер заголовка двоичного формата фиксирован");
+
+template <typename T>
+constexpr BinaryDtype binary_dtype() {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, float>::value,
+                  "Двоичный формат поддерживает только float и double");
+    return std::is_same<T, double>::value ? BinaryDtype::Float64 : BinaryDtype::Float32;
+}
+
+inline std::size_t binary_dtype_size(BinaryDtype dtype) {
+    return dtype == BinaryDtype::Float64 ? sizeof(double) : sizeof(float);
+}
+
+inline std::uint64_t binary_align(std::uint64_t offset) {
+    return (offset + BINARY_SECTION_ALIGNMENT - 1) / BINARY_SECTION_ALIGNMENT * BINARY_SECTION_ALIGNMENT;
+}
+
+inline BinaryHeader make_binary_header(BinaryDtype dtype, BinaryLayout layout) {
+    BinaryHeader header{};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.dtype = dtype;
+    header.layout = layout;
+    header.endian = BINARY_ENDIAN_TAG;
+    return header;
+}
+
+// Файл, отображенный в память только для чтения. Без mmap (не POSIX) файл читается целиком
+// в выровненный буфер - интерфейс тот же, но загрузка уже не мгновенная.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path) {
+#if COMP_MATH_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Не удалось открыть файл: " + path);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Не удалось определить размер файла: " + path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ > 0) {
+            void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Не удалось отобразить файл в память: " + path);
+            }
+            data_ = static_cast<const unsigned char*>(mapped);
+        }
+        ::close(fd); // Отображение остается действительным после закрытия дескриптора
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            throw std::runtime_error("Не удалось открыть файл: " + path);
+        }
+        size_ = static_cast<std::size_t>(in.tellg());
+        buffer_.resize(size_);
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(size_));
+        if (!in) {
+            throw std::runtime_error("Ошибка чтения файла: " + path);
+        }
+        data_ = buffer_.data();
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+#if !COMP_MATH_MMAP
+            buffer_ = std::move(other.buffer_);
+#endif
+        }
+        return *this;
+    }
+
+    ~MappedFile() { release(); }
+
+    const unsigned char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void release() {
+#if COMP_MATH_MMAP
+        if (data_ != nullptr) ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+#if !COMP_MATH_MMAP
+    std::vector<unsigned char, AlignedAllocator<unsigned char, BINARY_SECTION_ALIGNMENT>> buffer_;
+#endif
+};
+
+// Файл двоичного формата, открытый для чтения. Представления matrix()/vector() действительны,
+// пока жив объект BinaryFile.
+class BinaryFile {
+public:
+    explicit BinaryFile(const std::string& path) : file_(path), path_(path) {
+        if (file_.size() < sizeof(BinaryHeader)) {
+            throw std::runtime_error("Файл слишком мал для двоичного формата: " + path_);
+        }
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, BINARY_MAGIC, sizeof(header_.magic)) != 0) {
+            throw std::runtime_error("Файл не в двоичном формате comp_math: " + path_);
+        }
+        if (header_.version != BINARY_VERSION) {
+            throw std::runtime_error("Неподдерживаемая версия двоичного формата: " + path_);
+        }
+        if (header_.endian != BINARY_ENDIAN_TAG) {
+            throw std::runtime_error("Файл записан с другим порядком байтов: " + path_);
+        }
+        if (header_.dtype != BinaryDtype::Float32 && header_.dtype != BinaryDtype::Float64) {
+            throw std::runtime_error("Неизвестный тип элементов в файле: " + path_);
+        }
+        const std::uint64_t element = binary_dtype_size(header_.dtype);
+        switch (header_.layout) {
+            case BinaryLayout::Dense:
+                if (header_.cols > header_.stride && header_.rows > 0) {
+                    throw std::runtime_error("Длина строки меньше числа столбцов: " + path_);
+                }
+                check_section(header_.data_offset, section_bytes(section_bytes(header_.rows, header_.stride), element));
+                break;
+            case BinaryLayout::Vector:
+                check_section(header_.data_offset, section_bytes(header_.rows, element));
+                break;
+            case BinaryLayout::Csr:
+                if (header_.rows == UINT64_MAX) {
+                    throw std::runtime_error("Размер секции данных в заголовке переполняет 64 бита: " + path_);
+                }
+                check_section(header_.row_ptr_offset, section_bytes(header_.rows + 1, sizeof(std::uint64_t)));
+                check_section(header_.col_idx_offset, section_bytes(header_.nonzeros, sizeof(SparseIndex)));
+                check_section(header_.data_offset, section_bytes(header_.nonzeros, element));
+                break;
+            default:
+                throw std::runtime_error("Неизвестное размещение данных в файле: " + path_);
+        }
+    }
+
+    const BinaryHeader& header() const { return header_; }
+    BinaryLayout layout() const { return header_.layout; }
+    BinaryDtype dtype() const { return header_.dtype; }
+
+    // Плотная матрица без копирования
+    template <typename T>
+    MatrixView<const T> matrix() const {
+        check_access<T>(BinaryLayout::Dense);
+        return {section<T>(header_.data_offset), static_cast<std::size_t>(header_.rows),
+                static_cast<std::size_t>(header_.cols), static_cast<std::size_t>(header_.stride)};
+    }
+
+    // Вектор без копирования
+    template <typename T>
+    RowView<const T> vector() const {
+        check_access<T>(BinaryLayout::Vector);
+        return {section<T>(header_.data_offset), static_cast<std::size_t>(header_.rows)};
+    }
+
+    // Разреженная матрица (массивы копируются в CsrMatrix, портрет проверяется)
+    CsrMatrix csr() const {
+        check_access<double>(BinaryLayout::Csr);
+        const std::size_t rows = static_cast<std::size_t>(header_.rows);
+        const std::size_t nnz = static_cast<std::size_t>(header_.nonzeros);
+        std::vector<std::size_t> row_ptr(rows + 1);
+        std::vector<SparseIndex> col_idx(nnz);
+        std::vector<double> values(nnz);
+        const unsigned char* base = file_.data();
+        for (std::size_t i = 0; i <= rows; ++i) { // uint64 в файле -> size_t
+            std::uint64_t value;
+            std::memcpy(&value, base + header_.row_ptr_offset + i * sizeof(value), sizeof(value));
+            row_ptr[i] = static_cast<std::size_t>(value);
+        }
+        std::memcpy(col_idx.data(), base + header_.col_idx_offset, nnz * sizeof(SparseIndex));
+        std::memcpy(values.data(), base + header_.data_offset, nnz * sizeof(double));
+        return CsrMatrix::from_arrays(rows, static_cast<std::size_t>(header_.cols), std::move(row_ptr),
+                                      std::move(col_idx), std::move(values));
+    }
+
+private:
+    // Размер секции count * size байт. Размеры берутся из заголовка, поэтому произведение проверяется
+    // на переполнение: иначе подделанный заголовок прошел бы проверку check_section
+    std::uint64_t section_bytes(std::uint64_t count, std::uint64_t size) const {
+        std::uint64_t bytes;
+        if (__builtin_mul_overflow(count, size, &bytes)) {
+            throw std::runtime_error("Размер секции данных в заголовке переполняет 64 бита: " + path_);
+        }
+        return bytes;
+    }
+
+    void check_section(std::uint64_t offset, std::uint64_t bytes) const {
+        if (offset % BINARY_SECTION_ALIGNMENT != 0 || offset < sizeof(BinaryHeader) ||
+            offset > file_.size() || bytes > file_.size() - offset) {
+            throw std::runtime_error("Секция данных выходит за пределы файла: " + path_);
+        }
+    }
+
+    template <typename T>
+    void check_access(BinaryLayout layout) const {
+        if (header_.layout != layout) {
+            throw std::runtime_error("Размещение данных в файле не совпадает с запрошенным: " + path_);
+        }
+        if (header_.dtype != binary_dtype<T>()) {
+            throw std::runtime_error("Тип элементов в файле не совпадает с запрошенным: " + path_);
+        }
+    }
+
+    template <typename T>
+    const T* section(std::uint64_t offset) const {
+        return reinterpret_cast<const T*>(file_.data() + offset); // Смещение выровнено на 64 байта
+    }
+
+    MappedFile file_;
+    std::string path_;
+    BinaryHeader header_{};
+};
+
+// --- Запись ---
+
+namespace binary_detail {
+
+inline std::ofstream open_output(const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Не удалось создать файл: " + path);
+    }
+    return out;
+}
+
+inline void write_bytes(std::ofstream& out, const void* data, std::size_t bytes) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+}
+
+// Дополнение нулями до смещения offset
+inline void pad_to(std::ofstream& out, std::uint64_t offset) {
+    static const char zeros[BINARY_SECTION_ALIGNMENT] = {};
+    const std::uint64_t position = static_cast<std::uint64_t>(out.tellp());
+    write_bytes(out, zeros, static_cast<std::size_t>(offset - position));
+}
+
+inline void finish(std::ofstream& out, const std::string& path) {
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Ошибка записи файла: " + path);
+    }
+}
+
+} // namespace binary_detail
+
+// Плотная матрица с ее длиной строки: при чтении получается то же выровненное размещение
+template <typename T>
+void write_binary_matrix(const std::string& path, const DenseMatrix<T>& A) {
+    BinaryHeader header = make_binary_header(binary_dtype<T>(), BinaryLayout::Dense);
+    header.rows = A.rows();
+    header.cols = A.cols();
+    header.stride = A.stride();
+    header.data_offset = binary_align(sizeof(BinaryHeader));
+    std::ofstream out = binary_detail::open_output(path);
+    binary_detail::write_bytes(out, &header, sizeof(header));
+    binary_detail::pad_to(out, header.data_offset);
+    binary_detail::write_bytes(out, A.data(), A.rows() * A.stride() * sizeof(T));
+    binary_detail::finish(out, path);
+}
+
+template <typename T>
+void write_binary_vector(const std::string& path, const std::vector<T>& v) {
+    BinaryHeader header = make_binary_header(binary_dtype<T>(), BinaryLayout::Vector);
+    header.rows = v.size();
+    header.cols = 1;
+    header.stride = 1;
+    header.data_offset = binary_align(sizeof(BinaryHeader));
+    std::ofstream out = binary_detail::open_output(path);
+    binary_detail::write_bytes(out, &header, sizeof(header));
+    binary_detail::pad_to(out, header.data_offset);
+    binary_detail::write_bytes(out, v.data(), v.size() * sizeof(T));
+    binary_detail::finish(out, path);
+}
+
+inline void write_binary_csr(const std::string& path, const CsrMatrix& A) {
+    BinaryHeader header = make_binary_header(BinaryDtype::Float64, BinaryLayout::Csr);
+    header.rows = A.rows();
+    header.cols = A.cols();
+    header.nonzeros = A.nonzeros();
+    header.row_ptr_offset = binary_align(sizeof(BinaryHeader));
+    header.col_idx_offset = binary_align(header.row_ptr_offset + (A.rows() + 1) * sizeof(std::uint64_t));
+    header.data_offset = binary_align(header.col_idx_offset + A.nonzeros() * sizeof(SparseIndex));
+    std::ofstream out = binary_detail::open_output(path);
+    binary_detail::write_bytes(out, &header, sizeof(header));
+    binary_detail::pad_to(out, header.row_ptr_offset);
+    for (const std::size_t p : A.row_ptr()) {
+        const std::uint64_t value = p;
+        binary_detail::write_bytes(out, &value, sizeof(value));
+    }
+    binary_detail::pad_to(out, header.col_idx_offset);
+    binary_detail::write_bytes(out, A.col_idx().data(), A.nonzeros() * sizeof(SparseIndex));
+    binary_detail::pad_to(out, header.data_offset);
+    binary_detail::write_bytes(out, A.values().data(), A.nonzeros() * sizeof(double));
+    binary_detail::finish(out, path);
+}
+
+// Потоковая запись матрицы формата Dense по строкам, когда число строк заранее неизвестно.
+// Строки пишутся подряд (stride = cols); число строк заносится в заголовок при close()
+// (или в деструкторе). Память под всю матрицу не нужна.
+template <typename T>
+class BinaryRowWriter {
+public:
+    BinaryRowWriter() = default;
+    BinaryRowWriter(const std::string& path, std::size_t cols) { open(path, cols); }
+
+    BinaryRowWriter(const BinaryRowWriter&) = delete;
+    BinaryRowWriter& operator=(const BinaryRowWriter&) = delete;
+
+    ~BinaryRowWriter() {
+        try {
+            close();
+        } catch (...) {
+            // В деструкторе ошибку записи сообщить некому; для проверки вызывайте close() явно
+        }
+    }
+
+    void open(const std::string& path, std::size_t cols) {
+        close();
+        if (cols == 0) {
+            throw std::invalid_argument("Строка двоичного файла должна содержать хотя бы один элемент.");
+        }
+        path_ = path;
+        out_ = binary_detail::open_output(path);
+        header_ = make_binary_header(binary_dtype<T>(), BinaryLayout::Dense);
+        header_.cols = cols;
+        header_.stride = cols;
+        header_.data_offset = binary_align(sizeof(BinaryHeader));
+        binary_detail::write_bytes(out_, &header_, sizeof(header_));
+        binary_detail::pad_to(out_, header_.data_offset);
+    }
+
+    bool is_open() const { return out_.is_open(); }
+    std::size_t cols() const { return static_cast<std::size_t>(header_.cols); }
+    std::size_t rows() const { return static_cast<std::size_t>(header_.rows); }
+
+    // Строка из cols() элементов
+    void append(const T* row) {
+        binary_detail::write_bytes(out_, row, cols() * sizeof(T));
+        ++header_.rows;
+    }
+
+    // Число строк в заголовок и закрытие файла
+    void close() {
+        if (!out_.is_open()) return;
+        out_.seekp(0);
+        binary_detail::write_bytes(out_, &header_, sizeof(header_));
+        binary_detail::finish(out_, path_);
+        out_.close();
+    }
+
+private:
+    std::ofstream out_;
+    std::string path_;
+    BinaryHeader header_{};
+};
+
+#endif //COMP_MATH_BINARY_IO_H
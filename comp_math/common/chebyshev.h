@@ -0,0 +1,315 @@
+#ifndef COMP_MATH_CHEBYSHEV_H
+#define COMP_MATH_CHEBYSHEV_H
+
+#include <cstddef>
+#include <cmath>        // Для std::cos, std::abs, std::isfinite
+#include <vector>
+#include <algorithm>    // Для std::max, std::copy
+#include <stdexcept>    // Для std::runtime_error, std::invalid_argument
+#include <utility>      // Для std::move
+
+#include "dispatch.h"   // Варианты цикла под набор команд процессора
+#include "trace.h"      // Предупреждение о недостигнутой точности
+
+// Кусочная аппроксимация функции рядами Чебышева: строится один раз по дорогой функции f(x)
+// на [a, b] с заданной точностью и затем вычисляется схемой Кленшоу за несколько умножений.
+// Отрезок делится на равные куски (их число - степень двойки), поэтому номер куска вычисляется
+// по x без поиска; степень многочлена на всех кусках одна и та же.
+// Аппроксимация - вызываемый объект double(double): ее можно передать вместо функции квадратурам,
+// методам поиска корней и в правую часть ОДУ. Производная и первообразная считаются по
+// коэффициентам точно и снова являются аппроксимациями того же вида.
+
+// Степень многочлена на куске при построении по умолчанию: время вычисления пропорционально степени,
+// поэтому выгоднее больше кусков невысокой степени (коэффициенты остаются в кэше L1)
+constexpr int CHEBYSHEV_DEFAULT_DEGREE = 8;
+// Наибольшая допустимая степень многочлена на куске при построении
+constexpr int CHEBYSHEV_MAX_DEGREE = 32;
+// Наибольшее число кусков при построении
+constexpr std::size_t CHEBYSHEV_MAX_PIECES = 1 << 14;
+// Число точек, для которых рекурсии Кленшоу идут одновременно при пакетном вычислении
+constexpr std::size_t CHEBYSHEV_BATCH_LANES = 16;
+
+class ChebyshevApproximation;
+
+template <typename F>
+ChebyshevApproximation build_chebyshev(F&& f, double a, double b, double epsilon,
+                                       int max_degree = CHEBYSHEV_DEFAULT_DEGREE,
+                                       std::size_t max_pieces = CHEBYSHEV_MAX_PIECES);
+
+class ChebyshevApproximation {
+public:
+    ChebyshevApproximation() = default;
+
+    // Коэффициенты: pieces подряд идущих блоков по degree + 1, f(x) = sum c_k T_k(t) на куске,
+    // t in [-1, 1] - локальная координата куска
+    ChebyshevApproximation(double a, double b, std::size_t pieces, int degree, std::vector<double> coeffs)
+        : a_(a), b_(b), pieces_(pieces), degree_(degree), coeffs_(std::move(coeffs)) {
+        if (!(b > a) || pieces == 0 || degree < 0 ||
+            coeffs_.size() != pieces * static_cast<std::size_t>(degree + 1)) {
+            throw std::invalid_argument("Некорректные параметры аппроксимации Чебышева.");
+        }
+        width_ = (b - a) / static_cast<double>(pieces);
+        inv_width_ = 1.0 / width_;
+        last_piece_ = static_cast<double>(pieces - 1);
+    }
+
+    double a() const { return a_; }
+    double b() const { return b_; }
+    std::size_t pieces() const { return pieces_; }
+    int degree() const { return degree_; }
+    const std::vector<double>& coeffs() const { return coeffs_; }
+
+    // Точность достигнута на всех кусках (иначе число кусков уперлось в max_pieces)
+    bool converged() const { return converged_; }
+    // Число вычислений исходной функции при построении
+    long long evaluations() const { return evaluations_; }
+
+    // Значение в точке. Вне [a, b] продолжается многочленом крайнего куска.
+    double operator()(double x) const {
+        const std::size_t piece = piece_index(x);
+        return clenshaw(coeffs_.data() + piece * stride(), local_coordinate(x, piece));
+    }
+
+    // Номер куска, содержащего x (крайний - для точек вне [a, b])
+    // (без ветвлений: ограничение в double, NaN дает кусок 0)
+    std::size_t piece_index(double x) const {
+        const double u = std::min(last_piece_, std::max(0.0, (x - a_) * inv_width_));
+        return static_cast<std::size_t>(u);
+    }
+
+    // Координата x на куске piece, отображенном на [-1, 1]
+    double local_coordinate(double x, std::size_t piece) const {
+        return 2.0 * ((x - a_) * inv_width_ - static_cast<double>(piece)) - 1.0;
+    }
+
+    // Интеграл по всему [a, b]: int_{-1}^{1} T_k = 2 / (1 - k^2) для четных k, 0 для нечетных
+    double integral() const {
+        double sum = 0.0;
+        for (std::size_t p = 0; p < pieces_; ++p) {
+            const double* c = coeffs_.data() + p * stride();
+            for (int k = 0; k <= degree_; k += 2) {
+                sum += c[k] * 2.0 / (1.0 - static_cast<double>(k) * k);
+            }
+        }
+        return 0.5 * width_ * sum;
+    }
+
+    // Интеграл по [x1, x2] через первообразную. Первообразная строится заново при каждом вызове
+    // (O(pieces * degree) операций и выделение памяти); для многих отрезков выгоднее один раз
+    // построить antiderivative() и брать разности ее значений
+    double integral(double x1, double x2) const {
+        const ChebyshevApproximation F = antiderivative();
+        return F(x2) - F(x1);
+    }
+
+    // Производная: d_{k-1} = d_{k+1} + 2k c_k, d_0 делится пополам; множитель 2 / (ширина куска)
+    ChebyshevApproximation derivative() const {
+        const int degree = std::max(degree_ - 1, 0);
+        std::vector<double> result(pieces_ * static_cast<std::size_t>(degree + 1), 0.0);
+        const double scale = 2.0 * inv_width_;
+        for (std::size_t p = 0; p < pieces_; ++p) {
+            const double* c = coeffs_.data() + p * stride();
+            double* d = result.data() + p * static_cast<std::size_t>(degree + 1);
+            double d_next = 0.0, d_next2 = 0.0; // d_{k}, d_{k+1}
+            for (int k = degree_; k >= 1; --k) {
+                const double d_k1 = d_next2 + 2.0 * k * c[k]; // d_{k-1}
+                d[k - 1] = d_k1 * scale;
+                d_next2 = d_next;
+                d_next = d_k1;
+            }
+            d[0] *= 0.5;
+        }
+        return from_coeffs(degree, std::move(result));
+    }
+
+    // Первообразная F с F(a) = 0: C_k = (c_{k-1} - c_{k+1}) / (2k), C_1 = c_0 - c_2 / 2;
+    // C_0 на каждом куске подбирается так, чтобы F была непрерывна на границах кусков
+    ChebyshevApproximation antiderivative() const {
+        const int degree = degree_ + 1;
+        const std::size_t out_stride = static_cast<std::size_t>(degree + 1);
+        std::vector<double> result(pieces_ * out_stride, 0.0);
+        const double scale = 0.5 * width_;
+        double offset = 0.0; // F в левом конце куска
+        for (std::size_t p = 0; p < pieces_; ++p) {
+            const double* c = coeffs_.data() + p * stride();
+            double* C = result.data() + p * out_stride;
+            auto coeff = [&](int k) { return k <= degree_ ? c[k] : 0.0; };
+            double at_left = 0.0, at_right = 0.0; // sum_{k>=1} C_k T_k(-1), sum_{k>=1} C_k T_k(1)
+            for (int k = 1; k <= degree; ++k) {
+                const double previous = (k == 1) ? 2.0 * c[0] : coeff(k - 1);
+                C[k] = scale * (previous - coeff(k + 1)) / (2.0 * k);
+                at_left += (k % 2 == 0) ? C[k] : -C[k];
+                at_right += C[k];
+            }
+            C[0] = offset - at_left;
+            offset = C[0] + at_right;
+        }
+        return from_coeffs(degree, std::move(result));
+    }
+
+private:
+    template <typename F>
+    friend ChebyshevApproximation build_chebyshev(F&& f, double a, double b, double epsilon,
+                                                  int max_degree, std::size_t max_pieces);
+
+    std::size_t stride() const { return static_cast<std::size_t>(degree_ + 1); }
+
+    // Схема Кленшоу: b_k = 2t b_{k+1} - b_{k+2} + c_k, f = t b_1 - b_2 + c_0
+    double clenshaw(const double* c, double t) const {
+        const double two_t = 2.0 * t;
+        double b1 = 0.0, b2 = 0.0;
+        for (int k = degree_; k >= 1; --k) {
+            const double b0 = two_t * b1 + (c[k] - b2); // c_k - b_{k+2} не зависит от b_{k+1}
+            b2 = b1;
+            b1 = b0;
+        }
+        return t * b1 - b2 + c[0];
+    }
+
+    ChebyshevApproximation from_coeffs(int degree, std::vector<double> coeffs) const {
+        ChebyshevApproximation result(a_, b_, pieces_, degree, std::move(coeffs));
+        result.converged_ = converged_;
+        return result;
+    }
+
+    double a_ = 0.0;
+    double b_ = 1.0;
+    std::size_t pieces_ = 0;
+    int degree_ = 0;
+    double width_ = 1.0;
+    double inv_width_ = 1.0;
+    double last_piece_ = 0.0;
+    std::vector<double> coeffs_;
+    bool converged_ = true;
+    long long evaluations_ = 0;
+};
+
+// Построение аппроксимации f на [a, b] с абсолютной точностью epsilon.
+// На каждом куске f вычисляется в max_degree + 1 точках Чебышева-Лобатто (концы куска входят),
+// коэффициенты получаются дискретным косинус-преобразованием. Кусок принят, если последние два
+// коэффициента пренебрежимо малы; пока принят не каждый кусок, число кусков удваивается.
+// Затем хвосты рядов отбрасываются, пока сумма модулей отброшенного не превысит epsilon / 2,
+// и у всех кусков остается наибольшая из полученных степеней.
+// Если точность не достигнута при max_pieces кусках, аппроксимация возвращается с converged() == false
+// (и записью NotConverged в трассу). Неконечное значение f - ошибка.
+template <typename F>
+ChebyshevApproximation build_chebyshev(F&& f, double a, double b, double epsilon,
+                                       int max_degree, std::size_t max_pieces) {
+    if (!(b > a) || !(epsilon > 0.0) || max_degree < 2 || max_degree > CHEBYSHEV_MAX_DEGREE ||
+        max_pieces == 0 || max_pieces > CHEBYSHEV_MAX_PIECES) {
+        throw std::invalid_argument("Некорректные параметры построения аппроксимации Чебышева.");
+    }
+    const int n = max_degree;
+    const std::size_t stride = static_cast<std::size_t>(n + 1);
+    const double pi = std::acos(-1.0);
+
+    // Таблица cos(pi j k / n) для преобразования и узлы t_j = cos(pi j / n)
+    std::vector<double> cosines(stride * stride);
+    for (int j = 0; j <= n; ++j) {
+        for (int k = 0; k <= n; ++k) {
+            cosines[static_cast<std::size_t>(j) * stride + k] = std::cos(pi * ((j * k) % (2 * n)) / n);
+        }
+    }
+
+    std::vector<double> samples(stride);
+    std::vector<double> coeffs;
+    long long evaluations = 0;
+    std::size_t pieces = 1;
+    bool converged = false;
+    while (true) {
+        coeffs.assign(pieces * stride, 0.0);
+        const double width = (b - a) / static_cast<double>(pieces);
+        converged = true;
+        for (std::size_t p = 0; p < pieces; ++p) {
+            const double mid = a + (static_cast<double>(p) + 0.5) * width;
+            for (int j = 0; j <= n; ++j) {
+                samples[j] = f(mid + 0.5 * width * cosines[static_cast<std::size_t>(j) * stride + 1]);
+                if (!std::isfinite(samples[j])) {
+                    throw std::runtime_error("Функция принимает неконечное значение на отрезке аппроксимации.");
+                }
+            }
+            evaluations += n + 1;
+            double* c = coeffs.data() + p * stride;
+            for (int k = 0; k <= n; ++k) {
+                double sum = 0.5 * (samples[0] + samples[n] * cosines[static_cast<std::size_t>(n) * stride + k]);
+                for (int j = 1; j < n; ++j) sum += samples[j] * cosines[static_cast<std::size_t>(j) * stride + k];
+                c[k] = sum * 2.0 / n;
+            }
+            c[0] *= 0.5;
+            c[n] *= 0.5;
+            if (std::abs(c[n]) + std::abs(c[n - 1]) > 0.25 * epsilon) converged = false;
+        }
+        if (converged || pieces * 2 > max_pieces) break;
+        pieces *= 2;
+    }
+    if (!converged) {
+        trace("build_chebyshev", TraceEvent::NotConverged, static_cast<long long>(pieces), a, 0.0,
+              (b - a) / static_cast<double>(pieces), evaluations);
+    }
+
+    // Общая степень: наименьшая, при которой отброшенный хвост каждого куска не больше epsilon / 2
+    int degree = 0;
+    for (std::size_t p = 0; p < pieces; ++p) {
+        const double* c = coeffs.data() + p * stride;
+        double tail = 0.0;
+        int m = n;
+        while (m > 0 && tail + std::abs(c[m]) <= 0.5 * epsilon) tail += std::abs(c[m--]);
+        degree = std::max(degree, m);
+    }
+    const std::size_t out_stride = static_cast<std::size_t>(degree + 1);
+    std::vector<double> trimmed(pieces * out_stride);
+    for (std::size_t p = 0; p < pieces; ++p) {
+        std::copy(coeffs.begin() + p * stride, coeffs.begin() + p * stride + out_stride,
+                  trimmed.begin() + p * out_stride);
+    }
+
+    ChebyshevApproximation result(a, b, pieces, degree, std::move(trimmed));
+    result.converged_ = converged;
+    result.evaluations_ = evaluations;
+    return result;
+}
+
+// Значения аппроксимации сразу во многих точках: out[k] = approx(xs[k]), k < count
+// (та же сигнатура, что у пакетной подынтегральной функции batch_integrand в quadrature.h).
+// Точки обрабатываются группами по CHEBYSHEV_BATCH_LANES: рекурсии Кленшоу группы идут одновременно
+// (цикл по точкам внутри цикла по степеням), поэтому они не ждут друг друга и векторизуются
+// (в вариантах под AVX-512/AVX2, см. dispatch.h). xs и out могут совпадать: точки группы читаются
+// до записи ее значений.
+COMP_MATH_TARGET_CLONES
+inline void evaluate_chebyshev(const ChebyshevApproximation& approx, const double* xs, double* out, std::size_t count) {
+    if (approx.pieces() == 0) {
+        throw std::runtime_error("Аппроксимация Чебышева не построена.");
+    }
+    constexpr std::size_t L = CHEBYSHEV_BATCH_LANES;
+    const int degree = approx.degree();
+    const std::size_t stride = static_cast<std::size_t>(degree) + 1;
+    const double* __restrict coeffs = approx.coeffs().data();
+    const double* points = xs;
+    double* values = out;
+
+    for (std::size_t first = 0; first < count; first += L) {
+        const std::size_t lanes = std::min(L, count - first);
+        std::size_t offset[L];
+        double t[L], two_t[L], b1[L], b2[L];
+        for (std::size_t l = 0; l < lanes; ++l) {
+            const std::size_t piece = approx.piece_index(points[first + l]);
+            offset[l] = piece * stride;
+            t[l] = approx.local_coordinate(points[first + l], piece);
+            two_t[l] = 2.0 * t[l];
+            b1[l] = 0.0;
+            b2[l] = 0.0;
+        }
+        for (int k = degree; k >= 1; --k) {
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const double b0 = two_t[l] * b1[l] + (coeffs[offset[l] + k] - b2[l]);
+                b2[l] = b1[l];
+                b1[l] = b0;
+            }
+        }
+        for (std::size_t l = 0; l < lanes; ++l) {
+            values[first + l] = t[l] * b1[l] - b2[l] + coeffs[offset[l]];
+        }
+    }
+}
+
+#endif //COMP_MATH_CHEBYSHEV_H
@@ -0,0 +1,27 @@
+#ifndef COMP_MATH_DISPATCH_H
+#define COMP_MATH_DISPATCH_H
+
+// Выбор набора команд во время выполнения для векторизуемых циклов.
+// Функция, помеченная COMP_MATH_TARGET_CLONES, компилируется в нескольких вариантах
+// (x86-64-v4: AVX-512, x86-64-v3: AVX2+FMA, базовый x86-64), а при загрузке программы
+// выбирается вариант под текущий процессор (GNU ifunc). Поэтому исполняемый файл, собранный
+// без -march, использует широкие векторы там, где они есть, и запускается на любом x86-64.
+// Микроядра GEMM выбираются отдельно (см. gemm_isa() в gemm.h).
+// При сборке под конкретный процессор (-march, COMP_MATH_ARCH в CMake) диспетчеризация не нужна:
+// COMP_MATH_DISPATCH=0 отключает ее.
+
+#ifndef COMP_MATH_DISPATCH
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__)
+#define COMP_MATH_DISPATCH 1
+#else
+#define COMP_MATH_DISPATCH 0
+#endif
+#endif
+
+#if COMP_MATH_DISPATCH
+#define COMP_MATH_TARGET_CLONES __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define COMP_MATH_TARGET_CLONES
+#endif
+
+#endif //COMP_MATH_DISPATCH_H
@@ -0,0 +1,187 @@
+#ifndef COMP_MATH_ELIMINATION_H
+#define COMP_MATH_ELIMINATION_H
+
+#include <cstddef>
+#include <cmath>        // Для std::abs
+#include <vector>
+#include <array>
+#include <stdexcept>    // Для std::runtime_error, std::invalid_argument
+#include <algorithm>    // Для std::swap, std::copy, std::max
+
+#include "matrix.h"
+#include "thread_pool.h"
+
+// Метод Гаусса и обращение матрицы методом Гаусса-Жордана с распараллеливанием по строкам.
+// На каждом шаге строки под (или вне) ведущей строкой обновляются независимо,
+// поэтому они делятся между потоками пула; поиск главного элемента - параллельная редукция.
+// Каждая строка обновляется теми же операциями в том же порядке, что и в последовательном
+// алгоритме, поэтому результат не зависит от числа потоков.
+
+// Порог, ниже которого ведущий элемент считается нулевым
+constexpr double ELIMINATION_EPSILON = 1e-9;
+
+// Минимальный объем работы (умножений) на один кусок параллельного цикла
+constexpr std::size_t ELIMINATION_GRAIN_FLOPS = 16384;
+
+// Минимальное число строк на кусок при поиске главного элемента
+constexpr std::size_t PIVOT_SEARCH_GRAIN = 4096;
+
+// Минимальное число строк в куске, чтобы кусок содержал не менее ELIMINATION_GRAIN_FLOPS операций
+inline std::size_t elimination_grain(std::size_t row_length) {
+    return std::max<std::size_t>(1, ELIMINATION_GRAIN_FLOPS / std::max<std::size_t>(row_length, 1));
+}
+
+// Номер строки с наибольшим |A[k][col]| среди k в [first, A.rows()).
+// При равных значениях выбирается первая строка, как в последовательном поиске.
+inline std::size_t find_pivot_row(const Matrix& A, std::size_t col, std::size_t first, ThreadPool& pool) {
+    const std::size_t n = A.rows();
+    std::array<std::size_t, THREAD_POOL_MAX_CHUNKS> best{};
+    const std::size_t chunks = ThreadPool::chunk_count(first, n, PIVOT_SEARCH_GRAIN);
+
+    pool.parallel_for_chunks(first, n, PIVOT_SEARCH_GRAIN, [&](std::size_t c, std::size_t begin, std::size_t end) {
+        std::size_t max_row = begin;
+        for (std::size_t k = begin + 1; k < end; ++k) {
+            if (std::abs(A(k, col)) > std::abs(A(max_row, col))) {
+                max_row = k;
+            }
+        }
+        best[c] = max_row;
+    });
+
+    std::size_t max_row = best[0];
+    for (std::size_t c = 1; c < chunks; ++c) {
+        if (std::abs(A(best[c], col)) > std::abs(A(max_row, col))) {
+            max_row = best[c];
+        }
+    }
+    return max_row;
+}
+
+// Решение СЛАУ методом Гаусса с выбором главного элемента по столбцу
+inline std::vector<double> gauss(Matrix A, std::vector<double> b, // Принимаем копии, т.к. будем их изменять
+                                 ThreadPool& pool = default_thread_pool(),
+                                 double epsilon = ELIMINATION_EPSILON) {
+    const std::size_t n = A.rows();
+    if (n == 0 || A.cols() != n || b.size() != n) {
+        throw std::invalid_argument("Некорректные размеры матрицы или вектора для метода Гаусса.");
+    }
+
+    // Прямой ход
+    for (std::size_t i = 0; i < n; ++i) {
+        // Выбор главного элемента в текущем столбце (начиная с i-й строки)
+        const std::size_t maxRow = find_pivot_row(A, i, i, pool);
+
+        // Проверка на вырожденность (с учетом погрешности)
+        if (std::abs(A(maxRow, i)) < epsilon) {
+             bool found_pivot = false;
+             for (std::size_t check_col = i + 1; check_col < n; ++check_col) {
+                 if (std::abs(A(maxRow, check_col)) >= epsilon) {
+                     found_pivot = true; // Нашли потенциальный опорный, но в другом столбце
+                     break;
+                 }
+             }
+             if (!found_pivot) {
+                 throw std::runtime_error("Матрица вырождена или близка к вырожденной (метод Гаусса).");
+             }
+             throw std::runtime_error("Матрица вырождена или требует перестановки столбцов (метод Гаусса).");
+        }
+
+        // Перестановка строк (матрицы A и вектора b)
+        A.swap_rows(i, maxRow);
+        std::swap(b[i], b[maxRow]);
+
+        // Обнуление элементов под главным элементом: строки независимы и делятся между потоками
+        const double* row_i = A.row_data(i);
+        const double pivot = row_i[i]; // Обновляем pivot после возможной перестановки
+        pool.parallel_for(i + 1, n, elimination_grain(n - i), [&](std::size_t first, std::size_t last) {
+            for (std::size_t k = first; k < last; ++k) {
+                double* row_k = A.row_data(k);
+                const double factor = row_k[i] / pivot;
+                if (std::abs(factor) < epsilon) continue; // Пропускаем, если множитель почти нулевой
+                for (std::size_t j = i; j < n; ++j) { // Начинаем с j=i, т.к. A[k][i] обнулится
+                    row_k[j] -= factor * row_i[j];
+                }
+                b[k] -= factor * b[i];
+                // Явно обнуляем для точности (хотя математически уже должно быть 0)
+                row_k[i] = 0.0;
+            }
+        });
+    }
+
+    // Обратный ход
+    std::vector<double> x(n);
+    for (std::size_t i = n; i-- > 0;) {
+        const double* row_i = A.row_data(i);
+        if (std::abs(row_i[i]) < epsilon) {
+             throw std::runtime_error("Нулевой элемент на диагонали после прямого хода (метод Гаусса).");
+        }
+        double sum = 0.0;
+        for (std::size_t j = i + 1; j < n; ++j) {
+            sum += row_i[j] * x[j];
+        }
+        x[i] = (b[i] - sum) / row_i[i];
+    }
+
+    return x;
+}
+
+// Нахождение обратной матрицы методом Гаусса-Жордана
+inline Matrix inverse_matrix(const Matrix& matrix,
+                             ThreadPool& pool = default_thread_pool(),
+                             double epsilon = ELIMINATION_EPSILON) {
+    const std::size_t n = matrix.rows();
+    if (n == 0 || matrix.cols() != n) {
+        throw std::invalid_argument("Матрица должна быть квадратной для нахождения обратной.");
+    }
+
+    // Создаем расширенную матрицу [A | E]
+    Matrix augmented(n, 2 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::copy(matrix.row_data(i), matrix.row_data(i) + n, augmented.row_data(i));
+        augmented(i, i + n) = 1.0; // Формируем единичную матрицу справа
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        // Выбор главного элемента
+        const std::size_t maxRow = find_pivot_row(augmented, i, i, pool);
+
+        if (std::abs(augmented(maxRow, i)) < epsilon) {
+            throw std::runtime_error("Матрица вырождена, обратной не существует.");
+        }
+
+        // Перестановка строк
+        augmented.swap_rows(i, maxRow);
+
+        // Нормализация i-й строки (делим на ведущий элемент)
+        double* row_i = augmented.row_data(i);
+        const double pivot = row_i[i];
+        for (std::size_t j = i; j < 2 * n; ++j) { // Делим всю строку
+            row_i[j] /= pivot;
+        }
+        row_i[i] = 1.0; // Убедимся, что диагональный элемент ровно 1
+
+        // Обнуление i-го столбца во всех остальных строках (параллельно по строкам)
+        pool.parallel_for(0, n, elimination_grain(2 * n - i), [&](std::size_t first, std::size_t last) {
+            for (std::size_t k = first; k < last; ++k) {
+                if (k == i) continue;
+                double* row_k = augmented.row_data(k);
+                const double factor = row_k[i];
+                if (std::abs(factor) < epsilon) continue; // Пропускаем, если множитель мал
+                for (std::size_t j = i; j < 2 * n; ++j) { // Начинаем с j=i
+                    row_k[j] -= factor * row_i[j];
+                }
+                row_k[i] = 0.0; // Явно обнуляем для точности
+            }
+        });
+    }
+
+    // Извлечение обратной матрицы (правая часть расширенной матрицы)
+    Matrix inv(n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::copy(augmented.row_data(i) + n, augmented.row_data(i) + 2 * n, inv.row_data(i));
+    }
+
+    return inv;
+}
+
+#endif //COMP_MATH_ELIMINATION_H
@@ -0,0 +1,430 @@
+#ifndef COMP_MATH_GEMM_H
+#define COMP_MATH_GEMM_H
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>    // Для std::min, std::fill
+
+#include "matrix.h"     // Для AlignedAllocator
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMP_MATH_GEMM_X86 1
+#include <immintrin.h>
+#else
+#define COMP_MATH_GEMM_X86 0
+#endif
+
+// Умножение матриц C = alpha * A * B + beta * C по схеме GotoBLAS/BLIS:
+//  - B разбивается на панели KC x NC, A - на блоки MC x KC, оба упаковываются
+//    в непрерывные буферы в порядке, в котором их читает микроядро;
+//  - микроядро считает блок MR x NR регистров за один проход по KC;
+//  - реализация микроядра (скалярная, AVX2+FMA, AVX-512) выбирается
+//    во время выполнения по возможностям процессора.
+// Все матрицы хранятся построчно, lda/ldb/ldc - длины строк в памяти (stride).
+
+constexpr std::size_t GEMM_MR = 4;      // Строк в микроблоке
+constexpr std::size_t GEMM_MC = 128;    // Строк A в упакованном блоке (кратно GEMM_MR)
+constexpr std::size_t GEMM_KC = 256;    // Длина общего измерения в упакованных блоках
+constexpr std::size_t GEMM_NC = 4096;   // Столбцов B в упакованной панели
+constexpr std::size_t GEMM_MAX_NR = 32; // Наибольшая ширина микроблока среди всех ядер
+
+// Ниже этого числа умножений упаковка не окупается, используется простой цикл i-k-j
+constexpr std::size_t GEMM_SMALL_THRESHOLD = 32 * 32 * 32;
+
+enum class GemmIsa { Scalar, Avx2, Avx512 };
+
+// Определение лучшего доступного набора команд
+inline GemmIsa detect_gemm_isa() {
+#if COMP_MATH_GEMM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return GemmIsa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return GemmIsa::Avx2;
+    }
+#endif
+    return GemmIsa::Scalar;
+}
+
+inline GemmIsa& gemm_isa_storage() {
+    static GemmIsa isa = detect_gemm_isa();
+    return isa;
+}
+
+// Текущее микроядро GEMM
+inline GemmIsa gemm_isa() {
+    return gemm_isa_storage();
+}
+
+// Принудительный выбор микроядра (например, для сравнения производительности).
+// Набор команд, который процессор не поддерживает, понижается до доступного.
+inline void set_gemm_isa(GemmIsa isa) {
+    gemm_isa_storage() = std::min(isa, detect_gemm_isa());
+}
+
+// Сигнатура микроядра: C[MR x NR] += alpha * Ap * Bp,
+// Ap - упакованный блок MR x kc (по столбцам), Bp - упакованный блок kc x NR (по строкам)
+template <typename T>
+using GemmMicroKernel = void (*)(std::size_t kc, T alpha, const T* Ap, const T* Bp, T* C, std::size_t ldc);
+
+template <typename T>
+struct GemmKernel {
+    std::size_t nr;               // Ширина микроблока
+    GemmMicroKernel<T> run;
+};
+
+// --- Скалярное микроядро (переносимый вариант) ---
+template <typename T, std::size_t NR>
+void gemm_micro_kernel_scalar(std::size_t kc, T alpha, const T* Ap, const T* Bp, T* C, std::size_t ldc) {
+    T acc[GEMM_MR][NR] = {};
+    for (std::size_t p = 0; p < kc; ++p) {
+        const T* a = Ap + p * GEMM_MR;
+        const T* b = Bp + p * NR;
+        for (std::size_t i = 0; i < GEMM_MR; ++i) {
+            for (std::size_t j = 0; j < NR; ++j) {
+                acc[i][j] += a[i] * b[j];
+            }
+        }
+    }
+    for (std::size_t i = 0; i < GEMM_MR; ++i) {
+        for (std::size_t j = 0; j < NR; ++j) {
+            C[i * ldc + j] += alpha * acc[i][j];
+        }
+    }
+}
+
+#if COMP_MATH_GEMM_X86
+
+// --- AVX2 + FMA, double: блок 4 x 8 (8 аккумуляторов ymm) ---
+__attribute__((target("avx2,fma")))
+inline void gemm_micro_kernel_avx2(std::size_t kc, double alpha, const double* Ap, const double* Bp,
+                                   double* C, std::size_t ldc) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+
+    for (std::size_t p = 0; p < kc; ++p) {
+        const __m256d b0 = _mm256_load_pd(Bp + p * 8);
+        const __m256d b1 = _mm256_load_pd(Bp + p * 8 + 4);
+        const double* a = Ap + p * GEMM_MR;
+
+        __m256d ai = _mm256_broadcast_sd(a + 0);
+        c00 = _mm256_fmadd_pd(ai, b0, c00);
+        c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(ai, b0, c10);
+        c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(ai, b0, c20);
+        c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(ai, b0, c30);
+        c31 = _mm256_fmadd_pd(ai, b1, c31);
+    }
+
+    const __m256d va = _mm256_set1_pd(alpha);
+    double* c0 = C;
+    double* c1 = C + ldc;
+    double* c2 = C + 2 * ldc;
+    double* c3 = C + 3 * ldc;
+    _mm256_storeu_pd(c0,     _mm256_fmadd_pd(va, c00, _mm256_loadu_pd(c0)));
+    _mm256_storeu_pd(c0 + 4, _mm256_fmadd_pd(va, c01, _mm256_loadu_pd(c0 + 4)));
+    _mm256_storeu_pd(c1,     _mm256_fmadd_pd(va, c10, _mm256_loadu_pd(c1)));
+    _mm256_storeu_pd(c1 + 4, _mm256_fmadd_pd(va, c11, _mm256_loadu_pd(c1 + 4)));
+    _mm256_storeu_pd(c2,     _mm256_fmadd_pd(va, c20, _mm256_loadu_pd(c2)));
+    _mm256_storeu_pd(c2 + 4, _mm256_fmadd_pd(va, c21, _mm256_loadu_pd(c2 + 4)));
+    _mm256_storeu_pd(c3,     _mm256_fmadd_pd(va, c30, _mm256_loadu_pd(c3)));
+    _mm256_storeu_pd(c3 + 4, _mm256_fmadd_pd(va, c31, _mm256_loadu_pd(c3 + 4)));
+}
+
+// --- AVX2 + FMA, float: блок 4 x 16 ---
+__attribute__((target("avx2,fma")))
+inline void gemm_micro_kernel_avx2(std::size_t kc, float alpha, const float* Ap, const float* Bp,
+                                   float* C, std::size_t ldc) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+
+    for (std::size_t p = 0; p < kc; ++p) {
+        const __m256 b0 = _mm256_load_ps(Bp + p * 16);
+        const __m256 b1 = _mm256_load_ps(Bp + p * 16 + 8);
+        const float* a = Ap + p * GEMM_MR;
+
+        __m256 ai = _mm256_broadcast_ss(a + 0);
+        c00 = _mm256_fmadd_ps(ai, b0, c00);
+        c01 = _mm256_fmadd_ps(ai, b1, c01);
+        ai = _mm256_broadcast_ss(a + 1);
+        c10 = _mm256_fmadd_ps(ai, b0, c10);
+        c11 = _mm256_fmadd_ps(ai, b1, c11);
+        ai = _mm256_broadcast_ss(a + 2);
+        c20 = _mm256_fmadd_ps(ai, b0, c20);
+        c21 = _mm256_fmadd_ps(ai, b1, c21);
+        ai = _mm256_broadcast_ss(a + 3);
+        c30 = _mm256_fmadd_ps(ai, b0, c30);
+        c31 = _mm256_fmadd_ps(ai, b1, c31);
+    }
+
+    const __m256 va = _mm256_set1_ps(alpha);
+    float* c0 = C;
+    float* c1 = C + ldc;
+    float* c2 = C + 2 * ldc;
+    float* c3 = C + 3 * ldc;
+    _mm256_storeu_ps(c0,     _mm256_fmadd_ps(va, c00, _mm256_loadu_ps(c0)));
+    _mm256_storeu_ps(c0 + 8, _mm256_fmadd_ps(va, c01, _mm256_loadu_ps(c0 + 8)));
+    _mm256_storeu_ps(c1,     _mm256_fmadd_ps(va, c10, _mm256_loadu_ps(c1)));
+    _mm256_storeu_ps(c1 + 8, _mm256_fmadd_ps(va, c11, _mm256_loadu_ps(c1 + 8)));
+    _mm256_storeu_ps(c2,     _mm256_fmadd_ps(va, c20, _mm256_loadu_ps(c2)));
+    _mm256_storeu_ps(c2 + 8, _mm256_fmadd_ps(va, c21, _mm256_loadu_ps(c2 + 8)));
+    _mm256_storeu_ps(c3,     _mm256_fmadd_ps(va, c30, _mm256_loadu_ps(c3)));
+    _mm256_storeu_ps(c3 + 8, _mm256_fmadd_ps(va, c31, _mm256_loadu_ps(c3 + 8)));
+}
+
+// --- AVX-512, double: блок 4 x 16 (8 аккумуляторов zmm) ---
+__attribute__((target("avx512f")))
+inline void gemm_micro_kernel_avx512(std::size_t kc, double alpha, const double* Ap, const double* Bp,
+                                     double* C, std::size_t ldc) {
+    __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+    __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+    __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+    __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+
+    for (std::size_t p = 0; p < kc; ++p) {
+        const __m512d b0 = _mm512_load_pd(Bp + p * 16);
+        const __m512d b1 = _mm512_load_pd(Bp + p * 16 + 8);
+        const double* a = Ap + p * GEMM_MR;
+
+        __m512d ai = _mm512_set1_pd(a[0]);
+        c00 = _mm512_fmadd_pd(ai, b0, c00);
+        c01 = _mm512_fmadd_pd(ai, b1, c01);
+        ai = _mm512_set1_pd(a[1]);
+        c10 = _mm512_fmadd_pd(ai, b0, c10);
+        c11 = _mm512_fmadd_pd(ai, b1, c11);
+        ai = _mm512_set1_pd(a[2]);
+        c20 = _mm512_fmadd_pd(ai, b0, c20);
+        c21 = _mm512_fmadd_pd(ai, b1, c21);
+        ai = _mm512_set1_pd(a[3]);
+        c30 = _mm512_fmadd_pd(ai, b0, c30);
+        c31 = _mm512_fmadd_pd(ai, b1, c31);
+    }
+
+    const __m512d va = _mm512_set1_pd(alpha);
+    double* c0 = C;
+    double* c1 = C + ldc;
+    double* c2 = C + 2 * ldc;
+    double* c3 = C + 3 * ldc;
+    _mm512_storeu_pd(c0,     _mm512_fmadd_pd(va, c00, _mm512_loadu_pd(c0)));
+    _mm512_storeu_pd(c0 + 8, _mm512_fmadd_pd(va, c01, _mm512_loadu_pd(c0 + 8)));
+    _mm512_storeu_pd(c1,     _mm512_fmadd_pd(va, c10, _mm512_loadu_pd(c1)));
+    _mm512_storeu_pd(c1 + 8, _mm512_fmadd_pd(va, c11, _mm512_loadu_pd(c1 + 8)));
+    _mm512_storeu_pd(c2,     _mm512_fmadd_pd(va, c20, _mm512_loadu_pd(c2)));
+    _mm512_storeu_pd(c2 + 8, _mm512_fmadd_pd(va, c21, _mm512_loadu_pd(c2 + 8)));
+    _mm512_storeu_pd(c3,     _mm512_fmadd_pd(va, c30, _mm512_loadu_pd(c3)));
+    _mm512_storeu_pd(c3 + 8, _mm512_fmadd_pd(va, c31, _mm512_loadu_pd(c3 + 8)));
+}
+
+// --- AVX-512, float: блок 4 x 32 ---
+__attribute__((target("avx512f")))
+inline void gemm_micro_kernel_avx512(std::size_t kc, float alpha, const float* Ap, const float* Bp,
+                                     float* C, std::size_t ldc) {
+    __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+    __m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+    __m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+    __m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+
+    for (std::size_t p = 0; p < kc; ++p) {
+        const __m512 b0 = _mm512_load_ps(Bp + p * 32);
+        const __m512 b1 = _mm512_load_ps(Bp + p * 32 + 16);
+        const float* a = Ap + p * GEMM_MR;
+
+        __m512 ai = _mm512_set1_ps(a[0]);
+        c00 = _mm512_fmadd_ps(ai, b0, c00);
+        c01 = _mm512_fmadd_ps(ai, b1, c01);
+        ai = _mm512_set1_ps(a[1]);
+        c10 = _mm512_fmadd_ps(ai, b0, c10);
+        c11 = _mm512_fmadd_ps(ai, b1, c11);
+        ai = _mm512_set1_ps(a[2]);
+        c20 = _mm512_fmadd_ps(ai, b0, c20);
+        c21 = _mm512_fmadd_ps(ai, b1, c21);
+        ai = _mm512_set1_ps(a[3]);
+        c30 = _mm512_fmadd_ps(ai, b0, c30);
+        c31 = _mm512_fmadd_ps(ai, b1, c31);
+    }
+
+    const __m512 va = _mm512_set1_ps(alpha);
+    float* c0 = C;
+    float* c1 = C + ldc;
+    float* c2 = C + 2 * ldc;
+    float* c3 = C + 3 * ldc;
+    _mm512_storeu_ps(c0,      _mm512_fmadd_ps(va, c00, _mm512_loadu_ps(c0)));
+    _mm512_storeu_ps(c0 + 16, _mm512_fmadd_ps(va, c01, _mm512_loadu_ps(c0 + 16)));
+    _mm512_storeu_ps(c1,      _mm512_fmadd_ps(va, c10, _mm512_loadu_ps(c1)));
+    _mm512_storeu_ps(c1 + 16, _mm512_fmadd_ps(va, c11, _mm512_loadu_ps(c1 + 16)));
+    _mm512_storeu_ps(c2,      _mm512_fmadd_ps(va, c20, _mm512_loadu_ps(c2)));
+    _mm512_storeu_ps(c2 + 16, _mm512_fmadd_ps(va, c21, _mm512_loadu_ps(c2 + 16)));
+    _mm512_storeu_ps(c3,      _mm512_fmadd_ps(va, c30, _mm512_loadu_ps(c3)));
+    _mm512_storeu_ps(c3 + 16, _mm512_fmadd_ps(va, c31, _mm512_loadu_ps(c3 + 16)));
+}
+
+#endif // COMP_MATH_GEMM_X86
+
+// Выбор микроядра под тип элементов и набор команд
+template <typename T>
+GemmKernel<T> select_gemm_kernel(GemmIsa) {
+    return {8, &gemm_micro_kernel_scalar<T, 8>};
+}
+
+template <>
+inline GemmKernel<double> select_gemm_kernel<double>(GemmIsa isa) {
+#if COMP_MATH_GEMM_X86
+    if (isa == GemmIsa::Avx512) {
+        return {16, [](std::size_t kc, double alpha, const double* Ap, const double* Bp, double* C, std::size_t ldc) {
+            gemm_micro_kernel_avx512(kc, alpha, Ap, Bp, C, ldc);
+        }};
+    }
+    if (isa == GemmIsa::Avx2) {
+        return {8, [](std::size_t kc, double alpha, const double* Ap, const double* Bp, double* C, std::size_t ldc) {
+            gemm_micro_kernel_avx2(kc, alpha, Ap, Bp, C, ldc);
+        }};
+    }
+#endif
+    (void)isa;
+    return {8, &gemm_micro_kernel_scalar<double, 8>};
+}
+
+template <>
+inline GemmKernel<float> select_gemm_kernel<float>(GemmIsa isa) {
+#if COMP_MATH_GEMM_X86
+    if (isa == GemmIsa::Avx512) {
+        return {32, [](std::size_t kc, float alpha, const float* Ap, const float* Bp, float* C, std::size_t ldc) {
+            gemm_micro_kernel_avx512(kc, alpha, Ap, Bp, C, ldc);
+        }};
+    }
+    if (isa == GemmIsa::Avx2) {
+        return {16, [](std::size_t kc, float alpha, const float* Ap, const float* Bp, float* C, std::size_t ldc) {
+            gemm_micro_kernel_avx2(kc, alpha, Ap, Bp, C, ldc);
+        }};
+    }
+#endif
+    (void)isa;
+    return {16, &gemm_micro_kernel_scalar<float, 16>};
+}
+
+// Упаковка блока A (mc x kc) в микропанели по GEMM_MR строк, недостающие строки дополняются нулями
+template <typename T>
+void gemm_pack_A(std::size_t mc, std::size_t kc, const T* A, std::size_t lda, T* Ap) {
+    for (std::size_t ir = 0; ir < mc; ir += GEMM_MR) {
+        const std::size_t mr = std::min(GEMM_MR, mc - ir);
+        T* dst = Ap + ir * kc;
+        for (std::size_t p = 0; p < kc; ++p) {
+            for (std::size_t i = 0; i < GEMM_MR; ++i) {
+                dst[p * GEMM_MR + i] = (i < mr) ? A[(ir + i) * lda + p] : T(0);
+            }
+        }
+    }
+}
+
+// Упаковка панели B (kc x nc) в микропанели по nr столбцов, недостающие столбцы дополняются нулями
+template <typename T>
+void gemm_pack_B(std::size_t kc, std::size_t nc, const T* B, std::size_t ldb, std::size_t nr, T* Bp) {
+    for (std::size_t jr = 0; jr < nc; jr += nr) {
+        const std::size_t nr_eff = std::min(nr, nc - jr);
+        T* dst = Bp + jr * kc;
+        for (std::size_t p = 0; p < kc; ++p) {
+            const T* src = B + p * ldb + jr;
+            std::size_t j = 0;
+            for (; j < nr_eff; ++j) {
+                dst[p * nr + j] = src[j];
+            }
+            for (; j < nr; ++j) {
+                dst[p * nr + j] = T(0);
+            }
+        }
+    }
+}
+
+// C = alpha * A * B + beta * C; A - m x k, B - k x n, C - m x n
+template <typename T>
+void gemm(std::size_t m, std::size_t n, std::size_t k,
+          T alpha, const T* A, std::size_t lda,
+          const T* B, std::size_t ldb,
+          T beta, T* C, std::size_t ldc) {
+    if (m == 0 || n == 0) return;
+
+    // Масштабирование C (при beta = 0 старое содержимое C не читается)
+    if (beta == T(0)) {
+        for (std::size_t i = 0; i < m; ++i) {
+            std::fill(C + i * ldc, C + i * ldc + n, T(0));
+        }
+    } else if (beta != T(1)) {
+        for (std::size_t i = 0; i < m; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                C[i * ldc + j] *= beta;
+            }
+        }
+    }
+    if (k == 0 || alpha == T(0)) return;
+
+    // Малые матрицы: порядок i-k-j, внутренний цикл идет по строкам B и C
+    if (m * n * k <= GEMM_SMALL_THRESHOLD) {
+        for (std::size_t i = 0; i < m; ++i) {
+            T* c_row = C + i * ldc;
+            for (std::size_t p = 0; p < k; ++p) {
+                const T a_ip = alpha * A[i * lda + p];
+                const T* b_row = B + p * ldb;
+                for (std::size_t j = 0; j < n; ++j) {
+                    c_row[j] += a_ip * b_row[j];
+                }
+            }
+        }
+        return;
+    }
+
+    const GemmKernel<T> kernel = select_gemm_kernel<T>(gemm_isa());
+    const std::size_t nr = kernel.nr;
+    const std::size_t nc_max = (std::min(GEMM_NC, n) + nr - 1) / nr * nr;
+
+    std::vector<T, AlignedAllocator<T>> A_packed(GEMM_MC * GEMM_KC);
+    std::vector<T, AlignedAllocator<T>> B_packed(GEMM_KC * nc_max);
+    alignas(MATRIX_ALIGNMENT) T tile[GEMM_MR * GEMM_MAX_NR];
+
+    for (std::size_t jc = 0; jc < n; jc += GEMM_NC) {
+        const std::size_t nc = std::min(GEMM_NC, n - jc);
+        for (std::size_t pc = 0; pc < k; pc += GEMM_KC) {
+            const std::size_t kc = std::min(GEMM_KC, k - pc);
+            gemm_pack_B(kc, nc, B + pc * ldb + jc, ldb, nr, B_packed.data());
+
+            for (std::size_t ic = 0; ic < m; ic += GEMM_MC) {
+                const std::size_t mc = std::min(GEMM_MC, m - ic);
+                gemm_pack_A(mc, kc, A + ic * lda + pc, lda, A_packed.data());
+
+                for (std::size_t jr = 0; jr < nc; jr += nr) {
+                    const std::size_t nr_eff = std::min(nr, nc - jr);
+                    const T* Bp = B_packed.data() + jr * kc;
+                    for (std::size_t ir = 0; ir < mc; ir += GEMM_MR) {
+                        const std::size_t mr_eff = std::min(GEMM_MR, mc - ir);
+                        const T* Ap = A_packed.data() + ir * kc;
+                        T* C_block = C + (ic + ir) * ldc + jc + jr;
+
+                        if (mr_eff == GEMM_MR && nr_eff == nr) {
+                            kernel.run(kc, alpha, Ap, Bp, C_block, ldc);
+                        } else {
+                            // Краевой блок: считаем во временный буфер и добавляем только нужную часть
+                            std::fill(tile, tile + GEMM_MR * nr, T(0));
+                            kernel.run(kc, alpha, Ap, Bp, tile, nr);
+                            for (std::size_t i = 0; i < mr_eff; ++i) {
+                                for (std::size_t j = 0; j < nr_eff; ++j) {
+                                    C_block[i * ldc + j] += tile[i * nr + j];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif //COMP_MATH_GEMM_H
@@ -0,0 +1,417 @@
+#ifndef COMP_MATH_LU_H
+#define COMP_MATH_LU_H
+
+#include <cstddef>
+#include <cmath>        // Для std::abs
+#include <vector>
+#include <utility>      // Для std::move
+#include <stdexcept>    // Для std::runtime_error, std::invalid_argument
+#include <algorithm>    // Для std::min, std::max
+#include <limits>       // Для std::numeric_limits
+
+#include "matrix.h"
+#include "gemm.h"
+
+// Порог для ведущего элемента: меньший по модулю считается нулевым (матрица вырождена)
+constexpr double LU_PIVOT_TOLERANCE = 1e-9;
+
+// Ширина блока столбцов в блочном LU-разложении
+constexpr std::size_t LU_BLOCK_SIZE = 64;
+
+// LU-разложение PA = LU с частичным выбором главного элемента по столбцу (аналог LAPACK getrf).
+// Разложение выполняется на месте: под диагональю A остается L (диагональ L равна 1 и не хранится),
+// на диагонали и выше - U. pivots[i] - номер строки, переставленной с i-й на i-м шаге.
+//
+// Алгоритм правосторонний блочный: для каждой панели из LU_BLOCK_SIZE столбцов
+//  1) панель раскладывается обычным алгоритмом с выбором главного элемента;
+//  2) строки U12 справа от панели получаются треугольным решением с L11;
+//  3) оставшаяся подматрица обновляется A22 -= L21 * U12 через gemm (уровень 3 BLAS).
+template <typename T>
+void lu_factor_inplace(DenseMatrix<T>& A, std::vector<std::size_t>& pivots,
+                       double tolerance = LU_PIVOT_TOLERANCE) {
+    const std::size_t n = A.rows();
+    if (n == 0 || A.cols() != n) {
+        throw std::invalid_argument("Матрица должна быть квадратной для LU-разложения.");
+    }
+    pivots.resize(n);
+    const std::size_t lda = A.stride();
+
+    for (std::size_t j = 0; j < n; j += LU_BLOCK_SIZE) {
+        const std::size_t jb = std::min(LU_BLOCK_SIZE, n - j);
+
+        // 1. Разложение панели A[j:n, j:j+jb]
+        for (std::size_t jj = j; jj < j + jb; ++jj) {
+            std::size_t pivot_row = jj;
+            T pivot_abs = std::abs(A(jj, jj));
+            for (std::size_t i = jj + 1; i < n; ++i) {
+                const T value = std::abs(A(i, jj));
+                if (value > pivot_abs) {
+                    pivot_abs = value;
+                    pivot_row = i;
+                }
+            }
+            if (pivot_abs < tolerance) {
+                throw std::runtime_error("Матрица вырождена или близка к вырожденной (LU-разложение).");
+            }
+            pivots[jj] = pivot_row;
+            A.swap_rows(jj, pivot_row); // Переставляем строку целиком: и L слева, и еще не обработанную часть справа
+
+            const T* row_jj = A.row_data(jj);
+            const T inv_pivot = T(1) / row_jj[jj];
+            for (std::size_t i = jj + 1; i < n; ++i) {
+                T* row_i = A.row_data(i);
+                const T l_ij = row_i[jj] * inv_pivot;
+                row_i[jj] = l_ij;
+                for (std::size_t c = jj + 1; c < j + jb; ++c) {
+                    row_i[c] -= l_ij * row_jj[c];
+                }
+            }
+        }
+
+        const std::size_t rest = n - j - jb;
+        if (rest == 0) break;
+
+        // 2. U12 = L11^{-1} * A12 (прямая подстановка с единичной диагональю, построчно)
+        for (std::size_t r = j + 1; r < j + jb; ++r) {
+            T* row_r = A.row_data(r);
+            for (std::size_t q = j; q < r; ++q) {
+                const T l_rq = row_r[q];
+                const T* row_q = A.row_data(q);
+                for (std::size_t c = j + jb; c < n; ++c) {
+                    row_r[c] -= l_rq * row_q[c];
+                }
+            }
+        }
+
+        // 3. A22 -= L21 * U12
+        gemm<T>(rest, rest, jb,
+                T(-1), A.row_data(j + jb) + j, lda,
+                A.row_data(j) + j + jb, lda,
+                T(1), A.row_data(j + jb) + j + jb, lda);
+    }
+}
+
+// Готовое LU-разложение матрицы: строится один раз за O(n^3),
+// после чего каждая правая часть решается за O(n^2).
+template <typename T>
+class LUFactorization {
+public:
+    LUFactorization() = default;
+
+    explicit LUFactorization(DenseMatrix<T> A, double tolerance = LU_PIVOT_TOLERANCE) {
+        factor(std::move(A), tolerance);
+    }
+
+    void factor(DenseMatrix<T>&& A, double tolerance = LU_PIVOT_TOLERANCE) {
+        lu_factor_inplace(A, pivots_, tolerance);
+        lu_ = std::move(A);
+    }
+
+    // Разложение копии A в собственной памяти: при повторных разложениях матриц того же размера
+    // (например, W = I - gamma h J при смене шага) память не выделяется
+    void factor(const DenseMatrix<T>& A, double tolerance = LU_PIVOT_TOLERANCE) {
+        lu_ = A;
+        lu_factor_inplace(lu_, pivots_, tolerance);
+    }
+
+    std::size_t size() const { return lu_.rows(); }
+    const DenseMatrix<T>& packed() const { return lu_; }        // L и U в одной матрице
+    const std::vector<std::size_t>& pivots() const { return pivots_; }
+
+    // Решение Ax = b на месте: x перезаписывает b. Тип правой части может отличаться от T
+    // (например, множители во float, а вектор в double).
+    template <typename U>
+    void solve_inplace(U* x) const {
+        const std::size_t n = size();
+        // Перестановка строк правой части
+        for (std::size_t i = 0; i < n; ++i) {
+            if (pivots_[i] != i) std::swap(x[i], x[pivots_[i]]);
+        }
+        // Прямая подстановка Ly = Pb (диагональ L единичная)
+        for (std::size_t i = 1; i < n; ++i) {
+            const T* row = lu_.row_data(i);
+            U sum = 0;
+            for (std::size_t j = 0; j < i; ++j) {
+                sum += static_cast<U>(row[j]) * x[j];
+            }
+            x[i] -= sum;
+        }
+        // Обратная подстановка Ux = y
+        for (std::size_t i = n; i-- > 0;) {
+            const T* row = lu_.row_data(i);
+            U sum = 0;
+            for (std::size_t j = i + 1; j < n; ++j) {
+                sum += static_cast<U>(row[j]) * x[j];
+            }
+            x[i] = (x[i] - sum) / static_cast<U>(row[i]);
+        }
+    }
+
+    // Решение A^T y = c на месте: A^T = U^T L^T P, поэтому U^T w = c (прямой ход), L^T v = w (обратный ход),
+    // затем перестановки в обратном порядке. Нужно для оценки числа обусловленности.
+    template <typename U>
+    void solve_transpose_inplace(U* x) const {
+        const std::size_t n = size();
+        // U^T w = c: столбец i матрицы U^T - строка i матрицы U
+        for (std::size_t i = 0; i < n; ++i) {
+            const T* row = lu_.row_data(i);
+            x[i] /= static_cast<U>(row[i]);
+            const U w_i = x[i];
+            for (std::size_t j = i + 1; j < n; ++j) {
+                x[j] -= static_cast<U>(row[j]) * w_i;
+            }
+        }
+        // L^T v = w (диагональ единичная): столбец i матрицы L^T - строка i матрицы L
+        for (std::size_t i = n; i-- > 1;) {
+            const T* row = lu_.row_data(i);
+            const U v_i = x[i];
+            for (std::size_t j = 0; j < i; ++j) {
+                x[j] -= static_cast<U>(row[j]) * v_i;
+            }
+        }
+        for (std::size_t i = n; i-- > 0;) {
+            if (pivots_[i] != i) std::swap(x[i], x[pivots_[i]]);
+        }
+    }
+
+    template <typename U>
+    std::vector<U> solve(std::vector<U> b) const {
+        if (b.size() != size()) {
+            throw std::invalid_argument("Размер правой части не совпадает с размером LU-разложения.");
+        }
+        solve_inplace(b.data());
+        return b;
+    }
+
+    // Решение AX = B для нескольких правых частей (столбцы B) на месте
+    void solve_inplace(DenseMatrix<T>& B) const {
+        const std::size_t n = size();
+        if (B.rows() != n) {
+            throw std::invalid_argument("Число строк правых частей не совпадает с размером LU-разложения.");
+        }
+        const std::size_t nrhs = B.cols();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (pivots_[i] != i) B.swap_rows(i, pivots_[i]);
+        }
+        for (std::size_t i = 1; i < n; ++i) {
+            const T* row = lu_.row_data(i);
+            T* b_i = B.row_data(i);
+            for (std::size_t j = 0; j < i; ++j) {
+                const T l_ij = row[j];
+                const T* b_j = B.row_data(j);
+                for (std::size_t c = 0; c < nrhs; ++c) {
+                    b_i[c] -= l_ij * b_j[c];
+                }
+            }
+        }
+        for (std::size_t i = n; i-- > 0;) {
+            const T* row = lu_.row_data(i);
+            T* b_i = B.row_data(i);
+            for (std::size_t j = i + 1; j < n; ++j) {
+                const T u_ij = row[j];
+                const T* b_j = B.row_data(j);
+                for (std::size_t c = 0; c < nrhs; ++c) {
+                    b_i[c] -= u_ij * b_j[c];
+                }
+            }
+            const T inv_diag = T(1) / row[i];
+            for (std::size_t c = 0; c < nrhs; ++c) {
+                b_i[c] *= inv_diag;
+            }
+        }
+    }
+
+private:
+    DenseMatrix<T> lu_;
+    std::vector<std::size_t> pivots_;
+};
+
+// --- Решение в смешанной точности: разложение во float, уточнение невязки в double ---
+
+// Параметры итерационного уточнения
+struct MixedPrecisionControl {
+    int max_refinements = 30;       // Наибольшее число шагов уточнения до перехода к разложению в double
+    double stagnation_ratio = 0.5;  // Шаг, уменьшивший ||r||_inf меньше чем в 1/ratio раз, - признак плохой обусловленности
+    double tolerance = LU_PIVOT_TOLERANCE; // Порог ведущего элемента разложения в double
+};
+
+struct MixedPrecisionResult {
+    std::vector<double> x;
+    int refinements = 0;            // Число шагов уточнения (решений с разложением во float)
+    double residual_norm = 0.0;     // ||Ax - b||_inf итогового решения
+    bool double_fallback = false;   // Решение получено разложением в double
+};
+
+/**
+ * @brief Решение Ax = b в смешанной точности (аналог LAPACK dsgesv).
+ *
+ * @details
+ * A приводится к float и раскладывается блочным LU (вдвое меньше памяти и вдвое шире векторные
+ * регистры), затем решение уточняется: r = Ax - b считается в double, поправка d - решением
+ * с множителями во float, x -= d. Каждый шаг стоит O(n^2), и при cond(A) * eps_float << 1
+ * за несколько шагов достигается точность разложения в double.
+ * Остановка: ||r||_inf <= eps_double * sqrt(n) * ||A||_inf * ||x||_inf.
+ * Если во float матрица вырождена или не представима, если уточнение не уменьшает невязку
+ * хотя бы в 1/stagnation_ratio раз или не сходится за max_refinements шагов, система
+ * решается обычным LU-разложением в double (double_fallback = true).
+ *
+ * @param residual Невязка: residual(x) возвращает вектор r = Ax - b в double.
+ */
+template <typename Residual>
+MixedPrecisionResult lu_solve_mixed(const Matrix& A, const std::vector<double>& b, Residual&& residual,
+                                    const MixedPrecisionControl& control = MixedPrecisionControl()) {
+    const std::size_t n = A.rows();
+    if (n == 0 || A.cols() != n || b.size() != n) {
+        throw std::invalid_argument("Некорректные размеры для решения в смешанной точности.");
+    }
+    MixedPrecisionResult result;
+    auto solve_in_double = [&]() {
+        result.double_fallback = true;
+        result.x = LUFactorization<double>(A, control.tolerance).solve(b);
+        result.residual_norm = vector_norm_inf(residual(result.x));
+        return result;
+    };
+
+    // Приведение к float; значения вне диапазона float - сразу double
+    double norm_A = 0.0;
+    DenseMatrix<float> A_single(n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double* row = A.row_data(i);
+        float* row_single = A_single.row_data(i);
+        double row_sum = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            if (std::abs(row[j]) > static_cast<double>(std::numeric_limits<float>::max())) return solve_in_double();
+            row_single[j] = static_cast<float>(row[j]);
+            row_sum += std::abs(row[j]);
+        }
+        norm_A = std::max(norm_A, row_sum);
+    }
+
+    LUFactorization<float> lu_single;
+    try {
+        // Порог ведущего элемента масштабируется точностью float
+        lu_single.factor(std::move(A_single), std::numeric_limits<float>::epsilon() * norm_A);
+    } catch (const std::runtime_error&) {
+        return solve_in_double();
+    }
+
+    const double stop_factor = std::numeric_limits<double>::epsilon() * std::sqrt(static_cast<double>(n)) * norm_A;
+    result.x = lu_single.solve(b);
+    double previous_norm = std::numeric_limits<double>::infinity();
+    for (;;) {
+        std::vector<double> r = residual(result.x);
+        result.residual_norm = vector_norm_inf(r);
+        if (!std::isfinite(result.residual_norm)) return solve_in_double();
+        if (result.residual_norm <= stop_factor * vector_norm_inf(result.x)) return result;
+        if (result.refinements >= control.max_refinements
+            || result.residual_norm > control.stagnation_ratio * previous_norm) {
+            return solve_in_double();
+        }
+        previous_norm = result.residual_norm;
+
+        lu_single.solve_inplace(r.data()); // Поправка по множителям во float, в арифметике double
+        for (std::size_t i = 0; i < n; ++i) result.x[i] -= r[i];
+        ++result.refinements;
+    }
+}
+
+// То же с невязкой, вычисляемой построчно в double
+inline MixedPrecisionResult lu_solve_mixed(const Matrix& A, const std::vector<double>& b,
+                                           const MixedPrecisionControl& control = MixedPrecisionControl()) {
+    auto residual = [&A, &b](const std::vector<double>& x) {
+        std::vector<double> r(b.size());
+        for (std::size_t i = 0; i < r.size(); ++i) {
+            const double* row = A.row_data(i);
+            double sum = 0.0;
+            for (std::size_t j = 0; j < x.size(); ++j) sum += row[j] * x[j];
+            r[i] = sum - b[i];
+        }
+        return r;
+    };
+    return lu_solve_mixed(A, b, residual, control);
+}
+
+// --- Оценка числа обусловленности по готовому LU-разложению ---
+
+/**
+ * @brief Оценка ||A^{-1}||_1 методом Хейгера с улучшениями Хайэма (аналог LAPACK dlacon).
+ *
+ * @details
+ * ||A^{-1}||_1 = max ||A^{-1} x||_1 по ||x||_1 = 1 - максимум выпуклой функции, который достигается
+ * в векторе e_j. Начиная с x = (1/n, ..., 1/n), вычисляются y = A^{-1} x, xi = sign(y), z = A^{-T} xi;
+ * если max|z_j| <= z^T x, x - локальный максимум, иначе x = e_j для j = argmax|z_j|.
+ * Обычно хватает 2-3 итераций, каждая - два треугольных решения за O(n^2) по имеющемуся
+ * разложению, вместо O(n^3) на явное обращение. Оценка снизу и, как правило, точна или отличается
+ * в несколько раз; дополнительная проверка вектором x_i = (-1)^i (1 + i/(n-1)) (Хайэм)
+ * исправляет матрицы, на которых основной метод ошибается.
+ * При transposed = true оценивается ||A^{-T}||_1 = ||A^{-1}||_inf (роли решений меняются местами).
+ */
+template <typename T>
+double lu_inverse_norm1_estimate(const LUFactorization<T>& lu, bool transposed = false, int max_iterations = 5) {
+    const std::size_t n = lu.size();
+    if (n == 0) return 0.0;
+    auto norm_1 = [](const std::vector<double>& v) {
+        double norm = 0.0;
+        for (double value : v) norm += std::abs(value);
+        return norm;
+    };
+    auto solve = [&lu, transposed](std::vector<double>& v) {
+        if (transposed) lu.solve_transpose_inplace(v.data());
+        else lu.solve_inplace(v.data());
+    };
+    auto solve_transpose = [&lu, transposed](std::vector<double>& v) {
+        if (transposed) lu.solve_inplace(v.data());
+        else lu.solve_transpose_inplace(v.data());
+    };
+
+    std::vector<double> x(n, 1.0 / static_cast<double>(n));
+    std::vector<double> z(n);
+    double estimate = 0.0;
+    std::size_t last_j = n;
+    for (int iteration = 0; iteration < max_iterations; ++iteration) {
+        solve(x); // x = A^{-1} x
+        const double norm_y = norm_1(x);
+        if (iteration > 0 && norm_y <= estimate) break; // Оценка больше не растет
+        estimate = norm_y;
+        for (std::size_t i = 0; i < n; ++i) z[i] = x[i] >= 0.0 ? 1.0 : -1.0;
+        solve_transpose(z); // z = A^{-T} sign(y)
+
+        std::size_t j = 0;
+        for (std::size_t i = 1; i < n; ++i) {
+            if (std::abs(z[i]) > std::abs(z[j])) j = i;
+        }
+        // z^T x для x = e_{last_j} (на первой итерации x = (1/n, ..., 1/n))
+        double zx = 0.0;
+        if (iteration == 0) {
+            for (std::size_t i = 0; i < n; ++i) zx += z[i] / static_cast<double>(n);
+        } else {
+            zx = z[last_j];
+        }
+        if (std::abs(z[j]) <= zx || j == last_j) break; // Локальный максимум
+        std::fill(x.begin(), x.end(), 0.0);
+        x[j] = 1.0;
+        last_j = j;
+    }
+
+    // Проверочный вектор Хайэма: 2 ||A^{-1} x||_1 / (3n)
+    for (std::size_t i = 0; i < n; ++i) {
+        const double sign = (i % 2 == 0) ? 1.0 : -1.0;
+        x[i] = sign * (1.0 + (n > 1 ? static_cast<double>(i) / static_cast<double>(n - 1) : 0.0));
+    }
+    solve(x);
+    return std::max(estimate, 2.0 * norm_1(x) / (3.0 * static_cast<double>(n)));
+}
+
+// Оценка cond_1(A) = ||A||_1 * ||A^{-1}||_1 по LU-разложению A и норме ||A||_1
+template <typename T>
+double lu_condition_estimate_1(const LUFactorization<T>& lu, double norm1_A) {
+    return norm1_A * lu_inverse_norm1_estimate(lu);
+}
+
+// Оценка cond_inf(A) = ||A||_inf * ||A^{-1}||_inf по LU-разложению A и норме ||A||_inf
+template <typename T>
+double lu_condition_estimate_inf(const LUFactorization<T>& lu, double norm_inf_A) {
+    return norm_inf_A * lu_inverse_norm1_estimate(lu, true);
+}
+
+#endif //COMP_MATH_LU_H
@@ -0,0 +1,194 @@
+#ifndef COMP_MATH_MATRIX_H
+#define COMP_MATH_MATRIX_H
+
+#include <cstddef>
+#include <cmath>            // Для std::abs
+#include <span>
+#include <new>              // Для std::align_val_t
+#include <vector>
+#include <initializer_list>
+#include <stdexcept>        // Для std::invalid_argument
+#include <algorithm>        // Для std::swap_ranges, std::fill, std::max
+
+// Выравнивание начала каждой строки (в байтах): одна кэш-линия и ширина регистра AVX-512
+constexpr std::size_t MATRIX_ALIGNMENT = 64;
+
+// Аллокатор для std::vector, выдающий память с заданным выравниванием
+template <typename T, std::size_t Alignment = MATRIX_ALIGNMENT>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+// Невладеющее представление одной строки матрицы (указатель на начало строки + длина)
+template <typename T>
+class RowView {
+public:
+    RowView(T* data, std::size_t size) : data_(data), size_(size) {}
+
+    T& operator[](std::size_t j) const { return data_[j]; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T* data() const { return data_; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+private:
+    T* data_;
+    std::size_t size_;
+};
+
+// Невладеющее представление матрицы с тем же построчным хранением, что у DenseMatrix:
+// элемент (i, j) лежит по адресу data + i * stride + j. Используется для данных, которые
+// лежат в чужой памяти (например, отображенный в память файл, см. binary_io.h).
+template <typename T>
+class MatrixView {
+public:
+    using value_type = T;
+
+    MatrixView() = default;
+    MatrixView(T* data, std::size_t rows, std::size_t cols, std::size_t stride)
+        : data_(data), rows_(rows), cols_(cols), stride_(stride) {}
+
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t stride() const { return stride_; }
+    bool empty() const { return rows_ == 0 || cols_ == 0; }
+
+    T& operator()(std::size_t i, std::size_t j) const { return data_[i * stride_ + j]; }
+    RowView<T> operator[](std::size_t i) const { return {row_data(i), cols_}; }
+    T* row_data(std::size_t i) const { return data_ + i * stride_; }
+    T* data() const { return data_; }
+
+private:
+    T* data_ = nullptr;
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::size_t stride_ = 0;
+};
+
+// Плотная матрица с построчным (row-major) хранением в одном непрерывном буфере.
+// Длина строки в памяти (stride) округляется вверх до целого числа кэш-линий,
+// поэтому каждая строка начинается с выровненного адреса, а доступ A[i][j]
+// не требует разыменования отдельного указателя на строку.
+template <typename T>
+class DenseMatrix {
+public:
+    using value_type = T;
+
+    DenseMatrix() = default;
+
+    DenseMatrix(std::size_t rows, std::size_t cols, T value = T(0))
+        : rows_(rows), cols_(cols), stride_(padded_stride(cols)),
+          data_(rows * padded_stride(cols), T(0)) {
+        if (value != T(0)) {
+            fill(value);
+        }
+    }
+
+    // Построение из вложенного списка: Matrix A = {{1, 2}, {3, 4}};
+    DenseMatrix(std::initializer_list<std::initializer_list<T>> init)
+        : DenseMatrix(init.size(), init.size() == 0 ? 0 : init.begin()->size()) {
+        std::size_t i = 0;
+        for (const auto& row : init) {
+            if (row.size() != cols_) {
+                throw std::invalid_argument("Все строки матрицы должны иметь одинаковую длину.");
+            }
+            std::copy(row.begin(), row.end(), row_data(i));
+            ++i;
+        }
+    }
+
+    // Копия матрицы из представления (для методов, которые изменяют матрицу, например LU)
+    explicit DenseMatrix(MatrixView<const T> view) : DenseMatrix(view.rows(), view.cols()) {
+        for (std::size_t i = 0; i < rows_; ++i) {
+            std::copy(view.row_data(i), view.row_data(i) + cols_, row_data(i));
+        }
+    }
+
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t stride() const { return stride_; } // Расстояние между началами соседних строк (в элементах)
+    bool empty() const { return rows_ == 0 || cols_ == 0; }
+
+    T& operator()(std::size_t i, std::size_t j) { return data_[i * stride_ + j]; }
+    const T& operator()(std::size_t i, std::size_t j) const { return data_[i * stride_ + j]; }
+
+    RowView<T> operator[](std::size_t i) { return {row_data(i), cols_}; }
+    RowView<const T> operator[](std::size_t i) const { return {row_data(i), cols_}; }
+
+    T* row_data(std::size_t i) { return data_.data() + i * stride_; }
+    const T* row_data(std::size_t i) const { return data_.data() + i * stride_; }
+
+    T* data() { return data_.data(); }
+    const T* data() const { return data_.data(); }
+
+    MatrixView<T> view() { return {data(), rows_, cols_, stride_}; }
+    MatrixView<const T> view() const { return {data(), rows_, cols_, stride_}; }
+
+    void fill(T value) {
+        for (std::size_t i = 0; i < rows_; ++i) {
+            std::fill(row_data(i), row_data(i) + cols_, value);
+        }
+    }
+
+    // Перестановка строк i и j (поэлементно, т.к. строки лежат в общем буфере)
+    void swap_rows(std::size_t i, std::size_t j) {
+        if (i == j) return;
+        std::swap_ranges(row_data(i), row_data(i) + cols_, row_data(j));
+    }
+
+private:
+    // Число элементов T в одной кэш-линии (для double - 8)
+    static constexpr std::size_t row_granularity() {
+        return MATRIX_ALIGNMENT / sizeof(T) > 0 ? MATRIX_ALIGNMENT / sizeof(T) : 1;
+    }
+
+    static std::size_t padded_stride(std::size_t cols) {
+        const std::size_t g = row_granularity();
+        return (cols + g - 1) / g * g;
+    }
+
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::size_t stride_ = 0;
+    std::vector<T, AlignedAllocator<T>> data_;
+};
+
+typedef DenseMatrix<double> Matrix;
+
+// Бесконечная норма вектора: max |v_i| (общая для плотных, разреженных и смешанных решателей)
+template <typename T>
+T vector_norm_inf(std::span<const T> v) {
+    T norm = T(0);
+    for (const T value : v) norm = std::max(norm, std::abs(value));
+    return norm;
+}
+
+template <typename T, typename Allocator>
+T vector_norm_inf(const std::vector<T, Allocator>& v) {
+    return vector_norm_inf(std::span<const T>(v.data(), v.size()));
+}
+
+#endif //COMP_MATH_MATRIX_H
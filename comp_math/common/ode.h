@@ -0,0 +1,826 @@
+#ifndef COMP_MATH_ODE_H
+#define COMP_MATH_ODE_H
+
+#include <cstddef>
+#include <cmath>        // Для std::abs, std::pow
+#include <vector>
+#include <span>
+#include <limits>       // Для std::numeric_limits
+#include <algorithm>    // Для std::min, std::max, std::copy
+#include <stdexcept>    // Для std::invalid_argument
+#include <type_traits>  // Для std::remove_cvref_t, std::void_t
+#include <utility>      // Для std::move
+
+#include "matrix.h"
+#include "lu.h"
+#include "thread_pool.h"
+#include "trace.h"      // Трассировка шагов и предупреждений
+
+// Решение систем ОДУ y' = f(x, y), y - вектор размерности n, с автоматическим выбором шага.
+// Правая часть - любой вызываемый объект f(x, y, dy) с y: std::span<const double>, dy: std::span<double>
+// (параметр шаблона, вызов встраивается). Все промежуточные векторы стадий лежат в OdeWorkspace,
+// который выделяется один раз, поэтому на шаге память не выделяется.
+// Принятые шаги передаются наблюдателю observer(const OdeStep&) по мере интегрирования:
+// OdeSolution сохраняет всю траекторию, OdeGridSampler - только значения в заданных точках
+// (по эрмитову интерполянту шага), так что длинное интегрирование не требует памяти под траекторию.
+// Ансамбли начальных условий интегрируются параллельно в пуле потоков (solve_ode_ensemble*).
+// Принятые и отвергнутые шаги, а также остановки по малому шагу и по числу итераций записываются
+// в трассу (trace.h), если она подключена; в поток решатели ничего не выводят.
+
+// Наибольшее число стадий явного метода Рунге-Кутты
+constexpr int ODE_MAX_STAGES = 7;
+
+// Рабочая память шагов: векторы стадий и промежуточных решений размерности n
+struct OdeWorkspace {
+    std::vector<double> k[ODE_MAX_STAGES]; // Стадии k_s = f(x_s, y_s)
+    std::vector<double> stage;             // Аргумент y_s очередной стадии
+    std::vector<double> y_full;            // Результат шага h (правило Рунге)
+    std::vector<double> y_half;            // Результат первого шага h/2 (правило Рунге)
+    std::vector<double> y_next;            // Результат принимаемого шага
+    std::vector<double> f_begin;           // f в начале и в конце принятого шага (для плотного вывода)
+    std::vector<double> f_end;
+
+    OdeWorkspace() = default;
+    explicit OdeWorkspace(std::size_t n) { resize(n); }
+
+    // Изменение размерности; при той же размерности память не выделяется
+    void resize(std::size_t n) {
+        for (auto& stage_k : k) stage_k.resize(n);
+        stage.resize(n);
+        y_full.resize(n);
+        y_half.resize(n);
+        y_next.resize(n);
+        f_begin.resize(n);
+        f_end.resize(n);
+    }
+
+    std::size_t size() const { return stage.size(); }
+};
+
+// Счетчики работы решателя
+struct OdeStats {
+    long long f_evaluations = 0;        // Общее число вычислений правой части f(x, y)
+    long long jacobian_evaluations = 0; // Число вычислений матрицы Якоби (неявные методы)
+    long long factorizations = 0;       // Число LU-разложений матрицы W (неявные методы)
+    long long accepted_steps = 0;
+    long long rejected_steps = 0;
+};
+
+// Принятый шаг [x_begin, x_end], передаваемый наблюдателю. Первый вызов (index == 0) - начальная
+// точка: x_begin == x_end. Производные f_begin, f_end заполняются, только если наблюдатель объявляет
+// static constexpr bool needs_derivatives = true (иначе пусты и не стоят вычислений f).
+// Векторы действительны только во время вызова.
+struct OdeStep {
+    std::size_t index;
+    double x_begin;
+    double x_end;
+    std::span<const double> y_begin;
+    std::span<const double> y_end;
+    std::span<const double> f_begin;
+    std::span<const double> f_end;
+};
+
+template <typename Observer, typename = void>
+struct observer_needs_derivatives : std::false_type {};
+
+template <typename Observer>
+struct observer_needs_derivatives<Observer, std::void_t<decltype(Observer::needs_derivatives)>>
+    : std::bool_constant<Observer::needs_derivatives> {};
+
+// Значение кубического эрмитова интерполянта шага в точке x из [x_begin, x_end]:
+// u(t) = (1-t)*y0 + t*y1 + t(t-1)*((1-2t)(y1-y0) + (t-1)*h*f0 + t*h*f1),  t = (x - x_begin)/h.
+// Погрешность O(h^4) на шаге, поэтому для методов порядка до 3 плотный вывод не хуже узлов.
+inline void hermite_interpolate(const OdeStep& step, double x, std::span<double> y) {
+    const std::size_t n = step.y_end.size();
+    const double h = step.x_end - step.x_begin;
+    if (h == 0.0) {
+        for (std::size_t j = 0; j < n; ++j) y[j] = step.y_end[j];
+        return;
+    }
+    const double t = (x - step.x_begin) / h;
+    for (std::size_t j = 0; j < n; ++j) {
+        const double y0 = step.y_begin[j];
+        const double difference = step.y_end[j] - y0;
+        y[j] = y0 + t * difference
+               + t * (t - 1.0) * ((1.0 - 2.0 * t) * difference + (t - 1.0) * h * step.f_begin[j] + t * h * step.f_end[j]);
+    }
+}
+
+// Наблюдатель, сохраняющий решение во всех узлах x_0 < x_1 < ... ; y хранится по строкам: y[i * dimension + j]
+struct OdeSolution {
+    std::size_t dimension = 0;
+    std::vector<double> x;
+    std::vector<double> y;
+
+    std::size_t points() const { return x.size(); }
+    std::size_t steps() const { return x.empty() ? 0 : x.size() - 1; } // Число принятых шагов
+    std::span<const double> state(std::size_t i) const { return {y.data() + i * dimension, dimension}; }
+
+    void clear(std::size_t n) {
+        dimension = n;
+        x.clear();
+        y.clear();
+    }
+
+    void push(double xi, std::span<const double> yi) {
+        x.push_back(xi);
+        y.insert(y.end(), yi.begin(), yi.end());
+    }
+
+    void operator()(const OdeStep& step) {
+        if (step.index == 0) clear(step.y_end.size());
+        push(step.x_end, step.y_end);
+    }
+};
+
+// Наблюдатель плотного вывода: значения решения в точках x_out (по возрастанию) без хранения траектории.
+// y_out[i * n + j] - компонента j в точке x_out[i]; точки заполняются по мере прохождения шагов,
+// шаг метода при этом не привязывается к сетке x_out.
+class OdeGridSampler {
+public:
+    static constexpr bool needs_derivatives = true;
+
+    OdeGridSampler(std::span<const double> x_out, std::span<double> y_out)
+        : x_out_(x_out), y_out_(y_out) {}
+
+    void operator()(const OdeStep& step) {
+        const std::size_t n = step.y_end.size();
+        if (step.index == 0) {
+            if (y_out_.size() < x_out_.size() * n) {
+                throw std::invalid_argument("Недостаточный размер буфера плотного вывода.");
+            }
+            next_ = 0;
+        }
+        while (next_ < x_out_.size() && x_out_[next_] <= step.x_end) {
+            hermite_interpolate(step, x_out_[next_], y_out_.subspan(next_ * n, n));
+            ++next_;
+        }
+    }
+
+    std::size_t filled() const { return next_; } // Число заполненных точек
+
+private:
+    std::span<const double> x_out_;
+    std::span<double> y_out_;
+    std::size_t next_ = 0;
+};
+
+// Параметры выбора шага
+struct OdeStepControl {
+    double h_min = 1e-7;                                      // Минимально допустимый шаг
+    double h_max = std::numeric_limits<double>::infinity();   // Максимально допустимый шаг
+    int max_iterations = 200000;                              // Защита от бесконечного цикла
+
+    // Правило Рунге (шаг h и два шага h/2)
+    double safety_factor = 0.2;        // Фактор безопасности для нового шага
+    double grow_limit = 1.2;           // Максимальное относительное увеличение шага
+    double shrink_limit = 0.2;         // Минимальное относительное уменьшение шага
+
+    // PI-регулятор вложенных методов
+    double pi_safety = 0.9;            // Фактор безопасности
+    double pi_alpha = 0.7;             // Показатель при текущей ошибке (делится на порядок оценки + 1)
+    double pi_beta = 0.4;              // Показатель при ошибке предыдущего принятого шага
+    double pi_factor_min = 0.2;        // Минимальное относительное изменение шага
+    double pi_factor_max = 5.0;        // Максимальное относительное изменение шага
+    double pi_error_floor = 1e-4;      // Нижняя граница сохраненной ошибки (избегаем деления на 0)
+
+    // Жесткий решатель (W-метод Розенброка)
+    int jacobian_max_age = 20;         // Число принятых шагов с одной матрицей Якоби
+    double step_hold_ratio = 1.2;      // При 1 <= h_new/h < step_hold_ratio шаг не меняется (LU переиспользуется)
+};
+
+// Пошаговые методы: step(f, x, y, h, y_next, ws) делает шаг длины h и возвращает число вычислений f;
+// после вызова ws.k[0] = f(x, y).
+
+// --- Метод Эйлера-Коши (модифицированный Эйлер/Хойна), порядок p = 2 ---
+struct EulerCauchyStepper {
+    static constexpr int order = 2;
+    static constexpr const char* name = "Euler-Cauchy";
+
+    // Шаг из (x, y) длины h в y_next; возвращает число вычислений f
+    template <typename Rhs>
+    int operator()(Rhs& f, double x, std::span<const double> y, double h, std::span<double> y_next,
+                   OdeWorkspace& ws) const {
+        const std::size_t n = y.size();
+        std::span<double> f_xy(ws.k[0]);
+        std::span<double> f_pred(ws.k[1]);
+        f(x, y, f_xy);
+        for (std::size_t j = 0; j < n; ++j) ws.stage[j] = y[j] + h * f_xy[j]; // Предиктор
+        f(x + h, std::span<const double>(ws.stage), f_pred);
+        for (std::size_t j = 0; j < n; ++j) y_next[j] = y[j] + (h / 2.0) * (f_xy[j] + f_pred[j]);
+        return 2; // 2 вызова функции f(x,y)
+    }
+};
+
+// --- Классический метод Рунге-Кутты, порядок p = 4 ---
+struct RungeKutta4Stepper {
+    static constexpr int order = 4;
+    static constexpr const char* name = "Runge-Kutta 4";
+
+    template <typename Rhs>
+    int operator()(Rhs& f, double x, std::span<const double> y, double h, std::span<double> y_next,
+                   OdeWorkspace& ws) const {
+        const std::size_t n = y.size();
+        std::span<double> k1(ws.k[0]), k2(ws.k[1]), k3(ws.k[2]), k4(ws.k[3]);
+        std::span<const double> stage(ws.stage);
+        f(x, y, k1);
+        for (std::size_t j = 0; j < n; ++j) ws.stage[j] = y[j] + h * k1[j] / 2.0;
+        f(x + h / 2.0, stage, k2);
+        for (std::size_t j = 0; j < n; ++j) ws.stage[j] = y[j] + h * k2[j] / 2.0;
+        f(x + h / 2.0, stage, k3);
+        for (std::size_t j = 0; j < n; ++j) ws.stage[j] = y[j] + h * k3[j];
+        f(x + h, stage, k4);
+        for (std::size_t j = 0; j < n; ++j) {
+            y_next[j] = y[j] + (h / 6.0) * (k1[j] + 2.0 * k2[j] + 2.0 * k3[j] + k4[j]);
+        }
+        return 4; // 4 вызова функции f(x,y)
+    }
+};
+
+// --- Вложенные (embedded) методы Рунге-Кутты ---
+// Один шаг дает решение порядка order и, по тем же стадиям, решение порядка order-1;
+// их разность - оценка локальной погрешности без дополнительных вычислений f.
+// Для FSAL-методов (First Same As Last) последняя стадия вычисляется в (x + h, y_next)
+// и служит первой стадией следующего шага.
+struct EmbeddedTableau {
+    const char* name;
+    int stages;                                  // Число стадий
+    int order;                                   // Порядок решения, которым продолжается интегрирование
+    int error_order;                             // Порядок вложенного решения (для оценки погрешности)
+    bool fsal;                                   // Последняя стадия совпадает с первой стадией следующего шага
+    double c[ODE_MAX_STAGES];                    // Узлы стадий
+    double a[ODE_MAX_STAGES][ODE_MAX_STAGES];    // Коэффициенты стадий
+    double b[ODE_MAX_STAGES];                    // Веса решения порядка order
+    double e[ODE_MAX_STAGES];                    // b - b_hat: веса оценки погрешности
+};
+
+// Метод Дормана-Принса 5(4): 7 стадий, FSAL - 6 новых вычислений f на шаг
+constexpr EmbeddedTableau DORMAND_PRINCE_54 = {
+    "Dormand-Prince 5(4)", 7, 5, 4, true,
+    {0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0},
+    {{0.0},
+     {1.0 / 5.0},
+     {3.0 / 40.0, 9.0 / 40.0},
+     {44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0},
+     {19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0},
+     {9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0},
+     {35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0}},
+    {35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0, 0.0},
+    {71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0, -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0}};
+
+// Метод Богацкого-Шампина 3(2): 4 стадии, FSAL - 3 новых вычисления f на шаг (дешевый вариант)
+constexpr EmbeddedTableau BOGACKI_SHAMPINE_32 = {
+    "Bogacki-Shampine 3(2)", 4, 3, 2, true,
+    {0.0, 1.0 / 2.0, 3.0 / 4.0, 1.0},
+    {{0.0},
+     {1.0 / 2.0},
+     {0.0, 3.0 / 4.0},
+     {2.0 / 9.0, 1.0 / 3.0, 4.0 / 9.0}},
+    {2.0 / 9.0, 1.0 / 3.0, 4.0 / 9.0, 0.0},
+    {2.0 / 9.0 - 7.0 / 24.0, 1.0 / 3.0 - 1.0 / 4.0, 4.0 / 9.0 - 1.0 / 3.0, -1.0 / 8.0}};
+
+// Один шаг вложенного метода. ws.k[0] = f(x, y) должно быть уже вычислено;
+// после шага ws.k[stages-1] = f(x + h, y_next) для FSAL-методов.
+// Возвращает число новых вычислений f, в error_estimate - норма оценки локальной погрешности.
+template <typename Rhs>
+int embedded_rk_step(const EmbeddedTableau& tableau, Rhs& f, double x, std::span<const double> y, double h,
+                     std::span<double> y_next, OdeWorkspace& ws, double& error_estimate) {
+    const std::size_t n = y.size();
+    for (int s = 1; s < tableau.stages; ++s) {
+        for (std::size_t j = 0; j < n; ++j) {
+            double y_stage = y[j];
+            for (int q = 0; q < s; ++q) {
+                y_stage += h * tableau.a[s][q] * ws.k[q][j];
+            }
+            ws.stage[j] = y_stage;
+        }
+        f(x + tableau.c[s] * h, std::span<const double>(ws.stage), std::span<double>(ws.k[s]));
+    }
+    error_estimate = 0.0;
+    for (std::size_t j = 0; j < n; ++j) {
+        double value = y[j];
+        double error = 0.0;
+        for (int s = 0; s < tableau.stages; ++s) {
+            value += h * tableau.b[s] * ws.k[s][j];
+            error += h * tableau.e[s] * ws.k[s][j];
+        }
+        y_next[j] = value;
+        error_estimate = std::max(error_estimate, std::abs(error));
+    }
+    return tableau.stages - 1; // k[0] уже известно
+}
+
+// --- Решение системы ОДУ одношаговым методом с автоматическим выбором шага по правилу Рунге ---
+// Stepper: EulerCauchyStepper, RungeKutta4Stepper или аналогичный объект с полями order, name.
+// Погрешность шага оценивается сравнением одного шага h и двух шагов h/2:
+// R = ||y1 - y2|| / (2^p - 1).
+template <typename Stepper, typename Rhs, typename Observer>
+OdeStats solve_ode_auto_step(const Stepper& step, Rhs&& f,
+                             double x_start, std::span<const double> y_start, double x_end,
+                             double initial_h, double target_epsilon,
+                             Observer&& observer, OdeWorkspace& ws,
+                             const OdeStepControl& control = OdeStepControl()) {
+    constexpr bool dense = observer_needs_derivatives<std::remove_cvref_t<Observer>>::value;
+    const std::size_t n = y_start.size();
+    if (n == 0) {
+        throw std::invalid_argument("Пустой вектор начальных условий.");
+    }
+    ws.resize(n);
+    OdeStats stats;
+
+    double x_current = x_start;
+    std::vector<double> y_current(y_start.begin(), y_start.end());
+    double h_current = initial_h;
+    observer(OdeStep{0, x_current, x_current, y_current, y_current, {}, {}});
+
+    const int method_order_p = Stepper::order;
+    int iterations_count = 0;
+
+    while (x_current < x_end && iterations_count < control.max_iterations) {
+        iterations_count++;
+
+        if (x_current + h_current > x_end) {
+            h_current = x_end - x_current; // Корректируем последний шаг, чтобы точно попасть в x_end
+        }
+        // Предотвращаем слишком маленький шаг, который может вызвать проблемы
+        if (h_current < control.h_min / 10.0 && x_current < x_end) {
+             trace(Stepper::name, TraceEvent::StepTooSmall, iterations_count, x_current, 0.0, h_current, stats.f_evaluations);
+             break;
+        }
+
+        // 1. Один "большой" шаг h_current: y1
+        int f_evals = step(f, x_current, std::span<const double>(y_current), h_current, std::span<double>(ws.y_full), ws);
+        if constexpr (dense) {
+            std::copy(ws.k[0].begin(), ws.k[0].end(), ws.f_begin.begin());
+        }
+        // 2. Два "маленьких" шага h_current / 2.0: y2
+        f_evals += step(f, x_current, std::span<const double>(y_current), h_current / 2.0, std::span<double>(ws.y_half), ws);
+        f_evals += step(f, x_current + h_current / 2.0, std::span<const double>(ws.y_half), h_current / 2.0,
+                        std::span<double>(ws.y_next), ws);
+        stats.f_evaluations += f_evals;
+
+        // Оценка локальной погрешности по правилу Рунге
+        double difference = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            difference = std::max(difference, std::abs(ws.y_full[j] - ws.y_next[j]));
+        }
+        const double error_estimate_R = difference / (std::pow(2.0, method_order_p) - 1.0);
+
+        // Принимаем шаг, если оценка погрешности в норме ИЛИ если шаг уже предельно мал
+        if (error_estimate_R <= target_epsilon || h_current < control.h_min) {
+            const double x_previous = x_current;
+            x_current += h_current;
+            y_current.swap(ws.y_next); // y2 обычно точнее; ws.y_next - значение в начале шага
+            stats.accepted_steps += 1;
+            trace(Stepper::name, TraceEvent::StepAccepted, stats.accepted_steps, x_current, error_estimate_R, h_current, stats.f_evaluations);
+            if constexpr (dense) {
+                f(x_current, std::span<const double>(y_current), std::span<double>(ws.f_end));
+                stats.f_evaluations += 1;
+                observer(OdeStep{static_cast<std::size_t>(stats.accepted_steps), x_previous, x_current,
+                                 ws.y_next, y_current, ws.f_begin, ws.f_end});
+            } else {
+                observer(OdeStep{static_cast<std::size_t>(stats.accepted_steps), x_previous, x_current,
+                                 ws.y_next, y_current, {}, {}});
+            }
+
+            // Адаптация шага для следующей итерации: пытаемся увеличить шаг
+            if (error_estimate_R == 0.0) {
+                h_current = std::min(h_current * control.grow_limit, control.h_max);
+            } else if (error_estimate_R < target_epsilon) {
+                // p - порядок метода, p+1 - порядок локальной погрешности O(h^(p+1))
+                double optimal_factor = control.safety_factor * std::pow(target_epsilon / error_estimate_R, 1.0 / (method_order_p + 1.0));
+                h_current *= std::min(optimal_factor, control.grow_limit); // Ограничиваем рост
+            }
+        } else { // Отвергаем шаг: оценка погрешности слишком велика
+            stats.rejected_steps += 1;
+            trace(Stepper::name, TraceEvent::StepRejected, stats.rejected_steps, x_current, error_estimate_R, h_current, stats.f_evaluations);
+            double shrink_factor = control.safety_factor * std::pow(target_epsilon / error_estimate_R, 1.0 / (method_order_p + 1.0));
+            h_current *= std::max(shrink_factor, control.shrink_limit); // Ограничиваем уменьшение
+        }
+
+        // Применяем глобальные ограничения на шаг
+        h_current = std::min(h_current, control.h_max);
+        h_current = std::max(h_current, control.h_min);
+
+        if (x_current >= x_end) break;
+    }
+
+    if (iterations_count >= control.max_iterations && x_current < x_end) {
+        trace(Stepper::name, TraceEvent::MaxIterations, iterations_count, x_current, 0.0, h_current, stats.f_evaluations);
+    }
+    return stats;
+}
+
+// --- Решение системы ОДУ вложенным методом с PI-регулятором шага ---
+// Оценка погрешности берется из одного шага (вместо шага h и двух шагов h/2),
+// новый шаг: h *= safety * (eps/err)^(alpha/q) * (err_prev/eps)^(beta/q), q = error_order + 1.
+template <typename Rhs, typename Observer>
+OdeStats solve_ode_auto_step(const EmbeddedTableau& tableau, Rhs&& f,
+                             double x_start, std::span<const double> y_start, double x_end,
+                             double initial_h, double target_epsilon,
+                             Observer&& observer, OdeWorkspace& ws,
+                             const OdeStepControl& control = OdeStepControl()) {
+    constexpr bool dense = observer_needs_derivatives<std::remove_cvref_t<Observer>>::value;
+    const std::size_t n = y_start.size();
+    if (n == 0) {
+        throw std::invalid_argument("Пустой вектор начальных условий.");
+    }
+    ws.resize(n);
+    OdeStats stats;
+
+    double x_current = x_start;
+    std::vector<double> y_current(y_start.begin(), y_start.end());
+    double h_current = initial_h;
+    observer(OdeStep{0, x_current, x_current, y_current, y_current, {}, {}});
+
+    const double q = tableau.error_order + 1.0;
+    double previous_error_ratio = control.pi_error_floor; // err/eps предыдущего принятого шага
+    bool last_rejected = false;
+
+    f(x_current, std::span<const double>(y_current), std::span<double>(ws.k[0]));
+    stats.f_evaluations += 1;
+
+    int iterations_count = 0;
+    while (x_current < x_end && iterations_count < control.max_iterations) {
+        iterations_count++;
+
+        if (x_current + h_current > x_end) {
+            h_current = x_end - x_current; // Корректируем последний шаг, чтобы точно попасть в x_end
+        }
+        if (h_current < control.h_min / 10.0 && x_current < x_end) {
+             trace(tableau.name, TraceEvent::StepTooSmall, iterations_count, x_current, 0.0, h_current, stats.f_evaluations);
+             break;
+        }
+
+        double error_estimate = 0.0;
+        stats.f_evaluations += embedded_rk_step(tableau, f, x_current, std::span<const double>(y_current), h_current,
+                                                std::span<double>(ws.y_next), ws, error_estimate);
+
+        const double error_ratio = error_estimate / target_epsilon;
+        if (error_ratio <= 1.0 || h_current < control.h_min) {
+            const double x_previous = x_current;
+            x_current += h_current;
+            y_current.swap(ws.y_next); // ws.y_next - значение в начале шага
+            stats.accepted_steps += 1;
+            trace(tableau.name, TraceEvent::StepAccepted, stats.accepted_steps, x_current, error_estimate, h_current, stats.f_evaluations);
+
+            // Первая стадия следующего шага; f в начале шага остается в k[stages-1]
+            std::vector<double>& f_previous = ws.k[tableau.stages - 1];
+            ws.k[0].swap(f_previous);
+            if (!tableau.fsal) {
+                f(x_current, std::span<const double>(y_current), std::span<double>(ws.k[0]));
+                stats.f_evaluations += 1;
+            }
+            if constexpr (dense) {
+                observer(OdeStep{static_cast<std::size_t>(stats.accepted_steps), x_previous, x_current,
+                                 ws.y_next, y_current, f_previous, ws.k[0]});
+            } else {
+                observer(OdeStep{static_cast<std::size_t>(stats.accepted_steps), x_previous, x_current,
+                                 ws.y_next, y_current, {}, {}});
+            }
+
+            // PI-регулятор: учитываем и текущую, и предыдущую ошибку
+            const double ratio = std::max(error_ratio, control.pi_error_floor);
+            double factor = control.pi_safety * std::pow(ratio, -control.pi_alpha / q)
+                            * std::pow(previous_error_ratio, control.pi_beta / q);
+            factor = std::min(std::max(factor, control.pi_factor_min), control.pi_factor_max);
+            if (last_rejected) factor = std::min(factor, 1.0); // Сразу после отказа шаг не увеличиваем
+            h_current *= factor;
+            previous_error_ratio = ratio;
+            last_rejected = false;
+        } else { // Отвергаем шаг; k[0] остается верным для той же точки
+            stats.rejected_steps += 1;
+            trace(tableau.name, TraceEvent::StepRejected, stats.rejected_steps, x_current, error_estimate, h_current, stats.f_evaluations);
+            const double factor = control.pi_safety * std::pow(error_ratio, -1.0 / q);
+            h_current *= std::max(factor, control.pi_factor_min);
+            last_rejected = true;
+        }
+
+        // Применяем глобальные ограничения на шаг
+        h_current = std::min(h_current, control.h_max);
+        h_current = std::max(h_current, control.h_min);
+    }
+
+    if (iterations_count >= control.max_iterations && x_current < x_end) {
+        trace(tableau.name, TraceEvent::MaxIterations, iterations_count, x_current, 0.0, h_current, stats.f_evaluations);
+    }
+    return stats;
+}
+
+// --- Жесткие системы: W-метод Розенброка ROS2 ---
+// Двухстадийный L-устойчивый метод второго порядка (Verwer и др., 1999), gamma = 1 + 1/sqrt(2):
+//   W = I - gamma*h*J,  W k1 = f(x, y) + gamma*h*f_x,  W k2 = f(x + h, y + h*k1) - 2*k1 - gamma*h*f_x,
+//   y_next = y + h*(3/2*k1 + 1/2*k2),  оценка погрешности h*(k1 + k2)/2 (по решению первого порядка y + h*k1).
+// f_x = df/dx (столбец матрицы Якоби системы, дополненной переменной x) вычисляется разностью
+// на каждом шаге: это одно вычисление f, а без него неавтономная жесткая правая часть разрушает точность.
+// Метод является W-методом: второй порядок сохраняется при любой матрице J, поэтому матрица Якоби
+// переиспользуется в течение jacobian_max_age шагов, а LU-разложение W - пока шаг h не меняется.
+// Каждая стадия стоит одного решения с готовым разложением (O(n^2)) вместо O(n^3).
+constexpr double ROS2_GAMMA = 1.0 + 0.70710678118654752440;
+
+// Матрицы неявного метода вдобавок к векторам OdeWorkspace
+struct OdeStiffWorkspace {
+    OdeWorkspace vectors;
+    DenseMatrix<double> jacobian;       // J = df/dy
+    std::vector<double> f_x;            // df/dx в начале шага
+    DenseMatrix<double> w;              // W = I - gamma*h*J перед разложением
+    LUFactorization<double> lu;         // Разложение W
+
+    void resize(std::size_t n) {
+        vectors.resize(n);
+        f_x.resize(n);
+        if (jacobian.rows() != n) {
+            jacobian = DenseMatrix<double>(n, n);
+        }
+    }
+};
+
+// Матрица Якоби df/dy конечными разностями: J[:, j] = (f(x, y + delta*e_j) - f(x, y)) / delta.
+// f_xy = f(x, y) уже вычислено; perturbed и f_perturbed - рабочие векторы размерности n.
+// Возвращает число вычислений f (n).
+template <typename Rhs>
+int numerical_jacobian(Rhs& f, double x, std::span<const double> y, std::span<const double> f_xy,
+                       DenseMatrix<double>& J, std::span<double> perturbed, std::span<double> f_perturbed) {
+    const std::size_t n = y.size();
+    const double sqrt_epsilon = std::sqrt(std::numeric_limits<double>::epsilon());
+    std::copy(y.begin(), y.end(), perturbed.begin());
+    for (std::size_t j = 0; j < n; ++j) {
+        const double delta = sqrt_epsilon * std::max(std::abs(y[j]), 1.0);
+        perturbed[j] = y[j] + delta;
+        f(x, std::span<const double>(perturbed), f_perturbed);
+        const double inv_delta = 1.0 / (perturbed[j] - y[j]); // Точно представимое приращение
+        for (std::size_t i = 0; i < n; ++i) {
+            J(i, j) = (f_perturbed[i] - f_xy[i]) * inv_delta;
+        }
+        perturbed[j] = y[j];
+    }
+    return static_cast<int>(n);
+}
+
+// Решение жесткой системы ОДУ методом ROS2 с автоматическим выбором шага.
+// jacobian(x, y, J) записывает df/dy в DenseMatrix<double> J размера n x n.
+template <typename Rhs, typename Jacobian, typename Observer>
+OdeStats solve_ode_stiff(Rhs&& f, Jacobian&& jacobian,
+                         double x_start, std::span<const double> y_start, double x_end,
+                         double initial_h, double target_epsilon,
+                         Observer&& observer, OdeStiffWorkspace& ws,
+                         const OdeStepControl& control = OdeStepControl()) {
+    constexpr bool dense = observer_needs_derivatives<std::remove_cvref_t<Observer>>::value;
+    const std::size_t n = y_start.size();
+    if (n == 0) {
+        throw std::invalid_argument("Пустой вектор начальных условий.");
+    }
+    ws.resize(n);
+    OdeStats stats;
+
+    double x_current = x_start;
+    std::vector<double> y_current(y_start.begin(), y_start.end());
+    double h_current = initial_h;
+    observer(OdeStep{0, x_current, x_current, y_current, y_current, {}, {}});
+
+    std::vector<double>& f_xy = ws.vectors.k[0];
+    std::vector<double>& f_previous = ws.vectors.k[3];
+    std::vector<double>& k1 = ws.vectors.k[1];
+    std::vector<double>& k2 = ws.vectors.k[2];
+    std::vector<double>& stage = ws.vectors.stage;
+    std::vector<double>& y_next = ws.vectors.y_next;
+
+    bool f_valid = false;          // f_xy = f(x_current, y_current)
+    bool f_x_valid = false;        // ws.f_x = df/dx(x_current, y_current)
+    bool jacobian_valid = false;
+    int jacobian_age = 0;          // Число принятых шагов с текущей матрицей Якоби
+    double h_factored = 0.0;       // Шаг, для которого разложена W (0 - разложения нет)
+    const double q = 2.0;          // Порядок оценки погрешности + 1
+    bool last_rejected = false;
+
+    int iterations_count = 0;
+    while (x_current < x_end && iterations_count < control.max_iterations) {
+        iterations_count++;
+
+        if (x_current + h_current > x_end) {
+            h_current = x_end - x_current; // Корректируем последний шаг, чтобы точно попасть в x_end
+        }
+        if (h_current < control.h_min / 10.0 && x_current < x_end) {
+             trace("ROS2", TraceEvent::StepTooSmall, iterations_count, x_current, 0.0, h_current, stats.f_evaluations);
+             break;
+        }
+
+        if (!f_valid) {
+            f(x_current, std::span<const double>(y_current), std::span<double>(f_xy));
+            stats.f_evaluations += 1;
+            f_valid = true;
+        }
+        if (!f_x_valid) {
+            // df/dx разностью вперед (y_full - рабочий вектор)
+            const double dx = std::sqrt(std::numeric_limits<double>::epsilon()) * std::max(std::abs(x_current), 1.0);
+            const double x_shifted = x_current + dx;
+            f(x_shifted, std::span<const double>(y_current), std::span<double>(ws.vectors.y_full));
+            const double inv_dx = 1.0 / (x_shifted - x_current);
+            for (std::size_t j = 0; j < n; ++j) ws.f_x[j] = (ws.vectors.y_full[j] - f_xy[j]) * inv_dx;
+            stats.f_evaluations += 1;
+            f_x_valid = true;
+        }
+        if (!jacobian_valid) {
+            jacobian(x_current, std::span<const double>(y_current), ws.jacobian);
+            stats.jacobian_evaluations += 1;
+            jacobian_valid = true;
+            jacobian_age = 0;
+            h_factored = 0.0;
+        }
+        if (h_current != h_factored) {
+            ws.w = ws.jacobian;
+            const double scale = -ROS2_GAMMA * h_current;
+            for (std::size_t i = 0; i < n; ++i) {
+                double* row = ws.w.row_data(i);
+                for (std::size_t j = 0; j < n; ++j) row[j] *= scale;
+                row[i] += 1.0;
+            }
+            ws.lu.factor(ws.w); // Копия в память разложения: ws.w и ws.lu сохраняют свои буферы
+            stats.factorizations += 1;
+            h_factored = h_current;
+        }
+
+        // Стадии: два решения с готовым разложением W
+        const double gamma_h = ROS2_GAMMA * h_current;
+        for (std::size_t j = 0; j < n; ++j) k1[j] = f_xy[j] + gamma_h * ws.f_x[j];
+        ws.lu.solve_inplace(k1.data());
+        for (std::size_t j = 0; j < n; ++j) stage[j] = y_current[j] + h_current * k1[j];
+        f(x_current + h_current, std::span<const double>(stage), std::span<double>(k2));
+        stats.f_evaluations += 1;
+        for (std::size_t j = 0; j < n; ++j) k2[j] -= 2.0 * k1[j] + gamma_h * ws.f_x[j];
+        ws.lu.solve_inplace(k2.data());
+
+        double error_estimate = 0.0;
+        bool finite = true; // std::max не передает NaN дальше, поэтому конечность проверяется отдельно
+        for (std::size_t j = 0; j < n; ++j) {
+            y_next[j] = y_current[j] + h_current * (1.5 * k1[j] + 0.5 * k2[j]);
+            const double component_error = std::abs(0.5 * h_current * (k1[j] + k2[j]));
+            error_estimate = std::max(error_estimate, component_error);
+            finite = finite && std::isfinite(y_next[j]) && std::isfinite(component_error);
+        }
+
+        const double error_ratio = error_estimate / target_epsilon;
+        if (!finite || !std::isfinite(error_ratio)) { // NaN/inf в стадиях: уменьшение шага не поможет, расчет прекращаем
+            trace("ROS2", TraceEvent::NotConverged, iterations_count, x_current, error_estimate, h_current, stats.f_evaluations);
+            break;
+        }
+        if (error_ratio <= 1.0 || h_current < control.h_min) {
+            const double x_previous = x_current;
+            x_current += h_current;
+            y_current.swap(y_next); // y_next - значение в начале шага
+            stats.accepted_steps += 1;
+            trace("ROS2", TraceEvent::StepAccepted, stats.accepted_steps, x_current, error_estimate, h_current, stats.f_evaluations);
+            f_x_valid = false;
+            // f в новой точке нужна следующему шагу, а для плотного вывода - и в конце интервала
+            f_xy.swap(f_previous);
+            f_valid = false;
+            if (dense || x_current < x_end) {
+                f(x_current, std::span<const double>(y_current), std::span<double>(f_xy));
+                stats.f_evaluations += 1;
+                f_valid = true;
+            }
+            if constexpr (dense) {
+                observer(OdeStep{static_cast<std::size_t>(stats.accepted_steps), x_previous, x_current,
+                                 y_next, y_current, f_previous, f_xy});
+            } else {
+                observer(OdeStep{static_cast<std::size_t>(stats.accepted_steps), x_previous, x_current,
+                                 y_next, y_current, {}, {}});
+            }
+            if (++jacobian_age >= control.jacobian_max_age) jacobian_valid = false;
+
+            const double ratio = std::max(error_ratio, control.pi_error_floor);
+            double factor = control.pi_safety * std::pow(ratio, -1.0 / q);
+            factor = std::min(std::max(factor, control.pi_factor_min), control.pi_factor_max);
+            if (last_rejected) factor = std::min(factor, 1.0); // Сразу после отказа шаг не увеличиваем
+            if (factor >= 1.0 && factor < control.step_hold_ratio) factor = 1.0; // Сохраняем разложение W
+            h_current *= factor;
+            last_rejected = false;
+        } else { // Отвергаем шаг; устаревшую матрицу Якоби пересчитываем в той же точке
+            stats.rejected_steps += 1;
+            trace("ROS2", TraceEvent::StepRejected, stats.rejected_steps, x_current, error_estimate, h_current, stats.f_evaluations);
+            const double factor = control.pi_safety * std::pow(error_ratio, -1.0 / q);
+            h_current *= std::max(factor, control.pi_factor_min);
+            if (jacobian_age > 0) jacobian_valid = false;
+            last_rejected = true;
+        }
+
+        // Применяем глобальные ограничения на шаг
+        h_current = std::min(h_current, control.h_max);
+        h_current = std::max(h_current, control.h_min);
+    }
+
+    if (iterations_count >= control.max_iterations && x_current < x_end) {
+        trace("ROS2", TraceEvent::MaxIterations, iterations_count, x_current, 0.0, h_current, stats.f_evaluations);
+    }
+    return stats;
+}
+
+// То же с матрицей Якоби, вычисляемой конечными разностями (n вычислений f на матрицу)
+template <typename Rhs, typename Observer>
+OdeStats solve_ode_stiff(Rhs&& f,
+                         double x_start, std::span<const double> y_start, double x_end,
+                         double initial_h, double target_epsilon,
+                         Observer&& observer, OdeStiffWorkspace& ws,
+                         const OdeStepControl& control = OdeStepControl()) {
+    long long jacobian_f_evaluations = 0;
+    // Значение f(x, y) в точке вычисления матрицы Якоби уже лежит в ws.vectors.k[0]
+    auto jacobian = [&](double x, std::span<const double> y, DenseMatrix<double>& J) {
+        jacobian_f_evaluations += numerical_jacobian(f, x, y, std::span<const double>(ws.vectors.k[0]), J,
+                                                     std::span<double>(ws.vectors.y_full),
+                                                     std::span<double>(ws.vectors.y_half));
+    };
+    OdeStats stats = solve_ode_stiff(f, jacobian, x_start, y_start, x_end, initial_h, target_epsilon,
+                                     observer, ws, control);
+    stats.f_evaluations += jacobian_f_evaluations;
+    return stats;
+}
+
+// --- Ансамбли: много начальных условий (или параметров) за один вызов ---
+// Траектории независимы и распределяются по потокам пула кусками; результат не зависит от числа потоков.
+// Буферы в формате SoA: компонента j траектории e хранится в y[j * count + e].
+
+// Число траекторий, интегрируемых синхронно в одном блоке метода с постоянным шагом
+constexpr std::size_t ODE_ENSEMBLE_LANES = 64;
+
+// Ансамбль с автоматическим выбором шага для каждой траектории отдельно.
+// method - пошаговый метод (EulerCauchyStepper, RungeKutta4Stepper) или таблица вложенного метода;
+// f(e, x, y, dy) - правая часть траектории e (через e задаются параметры перебора).
+// y_start и y_final - SoA-буферы dimension * count; stats (пустой или размера count) - счетчики траекторий.
+template <typename Method, typename EnsembleRhs>
+void solve_ode_ensemble(const Method& method, EnsembleRhs&& f,
+                        double x_start, double x_end, double initial_h, double target_epsilon,
+                        std::size_t dimension, std::size_t count,
+                        std::span<const double> y_start, std::span<double> y_final,
+                        std::span<OdeStats> stats = {},
+                        ThreadPool& pool = default_thread_pool(),
+                        const OdeStepControl& control = OdeStepControl()) {
+    if (dimension == 0 || y_start.size() != dimension * count || y_final.size() != dimension * count
+        || (!stats.empty() && stats.size() != count)) {
+        throw std::invalid_argument("Размеры буферов ансамбля не соответствуют числу траекторий.");
+    }
+
+    pool.parallel_for(0, count, 1, [&](std::size_t first, std::size_t last) {
+        OdeWorkspace ws(dimension); // Одна рабочая память на кусок траекторий
+        std::vector<double> y0(dimension);
+        for (std::size_t e = first; e < last; ++e) {
+            for (std::size_t j = 0; j < dimension; ++j) y0[j] = y_start[j * count + e];
+            auto rhs = [&f, e](double x, std::span<const double> y, std::span<double> dy) { f(e, x, y, dy); };
+            // Запоминаем состояние в конце каждого шага: последний вызов - конец траектории
+            auto store = [&y_final, count, e](const OdeStep& step) {
+                for (std::size_t j = 0; j < step.y_end.size(); ++j) y_final[j * count + e] = step.y_end[j];
+            };
+            const OdeStats trajectory_stats = solve_ode_auto_step(method, rhs, x_start, std::span<const double>(y0), x_end,
+                                                                  initial_h, target_epsilon, store, ws, control);
+            if (!stats.empty()) stats[e] = trajectory_stats;
+        }
+    });
+}
+
+// Ансамбль с постоянным шагом h = (x_end - x_start) / steps: траектории идут синхронно блоками
+// по ODE_ENSEMBLE_LANES, и блок интегрируется как одна система размерности dimension * lanes,
+// поэтому циклы стадий метода векторизуются по траекториям.
+// f(x, first, lanes, y, dy) - правая часть блока траекторий first ... first + lanes - 1
+// в формате SoA блока: компонента j траектории first + l хранится в y[j * lanes + l].
+template <typename Stepper, typename BatchRhs>
+void solve_ode_ensemble_fixed(const Stepper& step, BatchRhs&& f,
+                              double x_start, double x_end, std::size_t steps,
+                              std::size_t dimension, std::size_t count,
+                              std::span<const double> y_start, std::span<double> y_final,
+                              ThreadPool& pool = default_thread_pool()) {
+    if (dimension == 0 || steps == 0 || y_start.size() != dimension * count || y_final.size() != dimension * count) {
+        throw std::invalid_argument("Размеры буферов ансамбля не соответствуют числу траекторий.");
+    }
+    const double h = (x_end - x_start) / static_cast<double>(steps);
+    const std::size_t blocks = (count + ODE_ENSEMBLE_LANES - 1) / ODE_ENSEMBLE_LANES;
+
+    pool.parallel_for(0, blocks, 1, [&](std::size_t first_block, std::size_t last_block) {
+        OdeWorkspace ws(dimension * ODE_ENSEMBLE_LANES);
+        std::vector<double> y(dimension * ODE_ENSEMBLE_LANES);
+        std::vector<double> y_next(dimension * ODE_ENSEMBLE_LANES);
+        for (std::size_t block = first_block; block < last_block; ++block) {
+            const std::size_t first = block * ODE_ENSEMBLE_LANES;
+            const std::size_t lanes = std::min(ODE_ENSEMBLE_LANES, count - first);
+            const std::size_t size = dimension * lanes;
+            ws.resize(size); // Меньше только у последнего блока
+            y.resize(size);
+            y_next.resize(size);
+            for (std::size_t j = 0; j < dimension; ++j) {
+                std::copy(y_start.begin() + j * count + first, y_start.begin() + j * count + first + lanes,
+                          y.begin() + j * lanes);
+            }
+            auto rhs = [&f, first, lanes](double x, std::span<const double> y_block, std::span<double> dy_block) {
+                f(x, first, lanes, y_block, dy_block);
+            };
+            for (std::size_t s = 0; s < steps; ++s) {
+                const double x = x_start + static_cast<double>(s) * h;
+                step(rhs, x, std::span<const double>(y), h, std::span<double>(y_next), ws);
+                y.swap(y_next);
+            }
+            for (std::size_t j = 0; j < dimension; ++j) {
+                std::copy(y.begin() + j * lanes, y.begin() + (j + 1) * lanes, y_final.begin() + j * count + first);
+            }
+        }
+    });
+}
+
+#endif //COMP_MATH_ODE_H
@@ -0,0 +1,658 @@
+#ifndef COMP_MATH_QUADRATURE_H
+#define COMP_MATH_QUADRATURE_H
+
+#include <cmath>        // Для std::pow, std::abs
+#include <cstddef>
+#include <functional>   // Для std::function (вариант со стиранием типа)
+#include <type_traits>  // Для std::decay, std::remove_cv
+#include <utility>      // Для std::forward
+#include <algorithm>    // Для std::min, std::max
+#include <array>
+#include <vector>
+#include <queue>        // Для std::priority_queue
+
+#include "thread_pool.h"
+#include "summation.h"  // Компенсированное суммирование по кускам
+#include "trace.h"      // Трассировка итераций и предупреждений
+
+// Квадратурные формулы с подынтегральной функцией в виде параметра шаблона.
+// Суммы по узлам компенсированные (Ноймайер) и считаются по кускам; при передаче пула потоков
+// куски обрабатываются параллельно, а результат совпадает с последовательным.
+// Функция может быть любым вызываемым объектом f(x) (вызов встраивается в цикл по узлам)
+// или пакетной функцией, обернутой в batch_integrand: f(xs, fx, count) заполняет fx[k] = f(xs[k])
+// сразу для массива точек, и вычисление функции векторизуется по точкам.
+// Итерации правила Рунге, Ромберга и Гаусса-Кронрода и несошедшиеся расчеты записываются в трассу
+// (trace.h): x - текущее значение интеграла (у Гаусса-Кронрода - точка деления), step - число разбиений n.
+
+// Число точек, передаваемых пакетной функции за один вызов
+constexpr int QUADRATURE_BATCH_SIZE = 256;
+
+// Пакетная подынтегральная функция: fn(const double* xs, double* fx, std::size_t count)
+template <typename Fn>
+struct BatchIntegrand {
+    Fn fn;
+};
+
+template <typename Fn>
+BatchIntegrand<typename std::decay<Fn>::type> batch_integrand(Fn&& fn) {
+    return {std::forward<Fn>(fn)};
+}
+
+template <typename F>
+struct is_batch_integrand : std::false_type {};
+
+template <typename Fn>
+struct is_batch_integrand<BatchIntegrand<Fn>> : std::true_type {};
+
+// Значение функции в одной точке
+template <typename F>
+double quadrature_value(F& f, double x) {
+    if constexpr (is_batch_integrand<typename std::remove_cv<F>::type>::value) {
+        double fx;
+        f.fn(&x, &fx, 1);
+        return fx;
+    } else {
+        return f(x);
+    }
+}
+
+// fx[k] = f(xs[k]) для произвольного набора точек
+template <typename F>
+void quadrature_values(F& f, const double* xs, double* fx, std::size_t count) {
+    if constexpr (is_batch_integrand<typename std::remove_cv<F>::type>::value) {
+        f.fn(xs, fx, count);
+    } else {
+        for (std::size_t k = 0; k < count; ++k) {
+            fx[k] = f(xs[k]);
+        }
+    }
+}
+
+// visit(i, f(x_i)) для узлов x_i = a + (i + offset) * h, i = first..last-1, по порядку.
+// Для пакетной функции узлы собираются в блоки по QUADRATURE_BATCH_SIZE точек.
+template <typename F, typename Visit>
+void quadrature_for_each_sample(F& f, double a, double h, double offset, int first, int last, Visit&& visit) {
+    if constexpr (is_batch_integrand<typename std::remove_cv<F>::type>::value) {
+        double xs[QUADRATURE_BATCH_SIZE];
+        double fx[QUADRATURE_BATCH_SIZE];
+        for (int start = first; start < last; start += QUADRATURE_BATCH_SIZE) {
+            const int count = std::min(QUADRATURE_BATCH_SIZE, last - start);
+            for (int k = 0; k < count; ++k) {
+                xs[k] = a + (start + k + offset) * h;
+            }
+            f.fn(xs, fx, static_cast<std::size_t>(count));
+            for (int k = 0; k < count; ++k) {
+                visit(start + k, fx[k]);
+            }
+        }
+    } else {
+        for (int i = first; i < last; ++i) {
+            visit(i, f(a + (i + offset) * h));
+        }
+    }
+}
+
+// Компенсированная сумма f(a + (i + offset) * h) по i = first..last-1.
+// С пулом куски считаются параллельно (f должна допускать одновременные вызовы из разных потоков);
+// без пула (nullptr) - в вызывающем потоке. Результат в обоих случаях одинаков (см. chunked_sum).
+template <typename F>
+CompensatedSum quadrature_sum(F& f, double a, double h, double offset, int first, int last,
+                              ThreadPool* pool = nullptr) {
+    if (first >= last) return {};
+    return chunked_sum(static_cast<std::size_t>(first), static_cast<std::size_t>(last), SUMMATION_GRAIN, pool,
+                       [&](std::size_t begin, std::size_t end, CompensatedSum& partial) {
+                           quadrature_for_each_sample(f, a, h, offset, static_cast<int>(begin), static_cast<int>(end),
+                                                      [&partial](int, double fx) { partial.add(fx); });
+                       });
+}
+
+/**
+ * @brief Метод центральных прямоугольников для численного интегрирования.
+ *
+ * @details
+ * Теория:
+ * Отрезок интегрирования [a,b] делится на n равных подынтервалов шириной h = (b-a)/n.
+ * На каждом подынтервале [x_i, x_{i+1}] функция f(x) аппроксимируется константой,
+ * равной значению функции в середине этого подынтервала: f(x_i + h/2).
+ * Площадь под кривой на подынтервале заменяется площадью прямоугольника.
+ * Формула: I ≈ h * Σ_{i=0}^{n-1} f(a + (i + 0.5)h)
+ *
+ * Геометрическая интерпретация:
+ * Сумма площадей прямоугольников, верхняя сторона которых касается графика функции в средней точке основания.
+ *
+ * Порядок точности:
+ * Второй (O(h^2)). При уменьшении шага h в два раза, ошибка уменьшается примерно в четыре раза.
+ *
+ * Плюсы:
+ * - Простота реализации.
+ * - Часто точнее методов левых/правых прямоугольников (которые имеют первый порядок точности).
+ *
+ * Минусы:
+ * - Менее точен, чем методы более высокого порядка (трапеций, Симпсона) при том же n.
+ *
+ * @param f Подынтегральная функция: f(x) или batch_integrand(...).
+ * @param a Нижний предел интегрирования.
+ * @param b Верхний предел интегрирования.
+ * @param n Количество разбиений (подынтервалов).
+ * @param pool Пул потоков для параллельного суммирования (nullptr - последовательно).
+ * @return Приближенное значение интеграла.
+ */
+template <typename F>
+double central_rectangles(F&& f, double a, double b, int n, ThreadPool* pool = nullptr) {
+    if (n <= 0) return 0.0; // Проверка корректности числа разбиений
+    double h = (b - a) / n;   // Ширина одного подынтервала (шаг)
+    // Сумма значений функции в серединах подынтервалов x = a + (i + 0.5) * h
+    const double sum = quadrature_sum(f, a, h, 0.5, 0, n, pool).value();
+    return h * sum; // Результат по формуле центральных прямоугольников
+}
+
+/**
+ * @brief Метод трапеций для численного интегрирования.
+ *
+ * @details
+ * Теория:
+ * Отрезок [a,b] делится на n подынтервалов шириной h = (b-a)/n.
+ * На каждом подынтервале [x_i, x_{i+1}] функция f(x) аппроксимируется прямой линией (линейной функцией),
+ * проходящей через точки (x_i, f(x_i)) и (x_{i+1}, f(x_{i+1})).
+ * Площадь под кривой на подынтервале заменяется площадью трапеции.
+ * Формула: I ≈ h * [ (f(a) + f(b))/2 + Σ_{i=1}^{n-1} f(a + ih) ]
+ *
+ * Геометрическая интерпретация:
+ * Сумма площадей трапеций, верхние стороны которых являются хордами,
+ * соединяющими значения функции на концах каждого подынтервала.
+ *
+ * Порядок точности:
+ * Второй (O(h^2)). Такой же, как у метода центральных прямоугольников.
+ *
+ * Плюсы:
+ * - Относительно прост в реализации.
+ * - Интуитивно понятная аппроксимация.
+ *
+ * Минусы:
+ * - Та же точность, что и у центральных прямоугольников. Константа в оценке погрешности
+ *   может быть как больше, так и меньше в зависимости от функции.
+ *
+ * @param f Подынтегральная функция: f(x) или batch_integrand(...).
+ * @param a Нижний предел интегрирования.
+ * @param b Верхний предел интегрирования.
+ * @param n Количество подынтервалов (узлов n+1).
+ * @param pool Пул потоков для параллельного суммирования (nullptr - последовательно).
+ * @return Приближенное значение интеграла.
+ */
+template <typename F>
+double trapezoidal_rule(F&& f, const double a, const double b, const int n, ThreadPool* pool = nullptr) {
+    if (n <= 0) return 0.0; // Проверка корректности числа разбиений
+    const double h = (b - a) / n; // Ширина одного подынтервала (шаг)
+    // Начальное значение суммы: полусумма значений функции на концах отрезка [a,b],
+    // что соответствует первому и последнему слагаемому в формуле с коэффициентом 1/2.
+    CompensatedSum sum;
+    sum.add((quadrature_value(f, a) + quadrature_value(f, b)) / 2.0);
+    // Суммируем значения функции во внутренних узлах (с коэффициентом 1)
+    sum.add(quadrature_sum(f, a, h, 0.0, 1, n, pool));
+    return h * sum.value(); // Результат по формуле трапеций
+}
+
+/**
+ * @brief Метод Симпсона (формула парабол) для численного интегрирования.
+ *
+ * @details
+ * Теория:
+ * Отрезок [a,b] делится на ЧЕТНОЕ число n подынтервалов шириной h = (b-a)/n.
+ * На каждой паре смежных подынтервалов (т.е. на отрезке длиной 2h) функция f(x)
+ * аппроксимируется параболой (квадратичной функцией), проходящей через три точки.
+ * Площадь под кривой на этом двойном подынтервале заменяется площадью под параболой.
+ * Формула (составная): I ≈ (h/3) * [ f(x₀) + 4f(x₁) + 2f(x₂) + 4f(x₃) + ... + 2f(x_{n-2}) + 4f(x_{n-1}) + f(x_n) ]
+ *
+ * Геометрическая интерпретация:
+ * Сумма площадей под параболическими сегментами, которые аппроксимируют
+ * график функции на парах подынтервалов.
+ *
+ * Порядок точности:
+ * Четвертый (O(h^4)). Значительно выше, чем у методов прямоугольников и трапеций.
+ * При уменьшении шага h в два раза, ошибка уменьшается примерно в 16 раз.
+ * Метод точен для многочленов до третьей степени включительно.
+ *
+ * Плюсы:
+ * - Высокая точность при сравнительно небольшом n (для гладких функций).
+ * - Очень эффективен для большинства практических задач.
+ *
+ * Минусы:
+ * - Требует четного числа подынтервалов n.
+ * - Немного сложнее в реализации.
+ *
+ * @param f Подынтегральная функция: f(x) или batch_integrand(...).
+ * @param a Нижний предел интегрирования.
+ * @param b Верхний предел интегрирования.
+ * @param n Количество подынтервалов (должно быть четным). Если n нечетное, оно будет увеличено на 1.
+ * @param pool Пул потоков для параллельного суммирования (nullptr - последовательно).
+ * @return Приближенное значение интеграла.
+ */
+template <typename F>
+double simpsons_rule(F&& f, const double a, const double b, int n, ThreadPool* pool = nullptr) {
+    if (n <= 0) return 0.0; // Проверка корректности числа разбиений
+    // Метод Симпсона требует четного числа подынтервалов n.
+    // Если n нечетное, увеличиваем его до ближайшего четного.
+    // Это важно, так как правило Рунге может передать нечетное n на начальных итерациях.
+    if (n % 2 != 0) {
+        n++;
+    }
+
+    const double h = (b - a) / n; // Ширина одного подынтервала (шаг)
+    // Начальное значение суммы: значения функции на концах отрезка [a,b] (коэффициенты 1)
+    const double ends = quadrature_value(f, a) + quadrature_value(f, b);
+
+    // Внутренние узлы суммируются двумя отдельными проходами, без ветвления по четности индекса:
+    // нечетные x_{2j+1} = a + (j + 0.5) * 2h имеют коэффициент 4, четные x_{2j} = a + j * 2h - коэффициент 2
+    const int half_n = n / 2;
+    const double odd = quadrature_sum(f, a, 2.0 * h, 0.5, 0, half_n, pool).value();
+    const double even = quadrature_sum(f, a, 2.0 * h, 0.0, 1, half_n, pool).value();
+    const double sum = ends + 4.0 * odd + 2.0 * even;
+    return (h / 3.0) * sum; // Результат по формуле Симпсона
+}
+
+// Последовательность для произвольной формулы: на каждом шаге integrator(a, b, n) вычисляется заново
+template <typename Rule>
+class RuleRefinement {
+public:
+    RuleRefinement(Rule& integrator, double a, double b, int n)
+        : integrator_(integrator), a_(a), b_(b), n_(n), value_(integrator(a, b, n)) {}
+
+    int intervals() const { return n_; }
+    double value() const { return value_; }
+
+    void refine() {
+        n_ *= 2;
+        value_ = integrator_(a_, b_, n_);
+    }
+
+private:
+    Rule& integrator_;
+    double a_;
+    double b_;
+    int n_;
+    double value_;
+};
+
+// Цикл правила Рунге (см. integrate_with_runge) над последовательностью сеток, n удваивается на каждом шаге.
+// Sequence: intervals() - текущее n, value() - интеграл при этом n, refine() - переход к 2n.
+template <typename Sequence>
+double integrate_runge_sequence(Sequence& sequence, double epsilon, const int p, int& n_final) {
+    int n = sequence.intervals();
+    double I_h = sequence.value(); // Интеграл с текущим шагом h (соответствует n разбиениям)
+    double I_2h;                      // Интеграл с шагом 2h (соответствует n/2 разбиениям) - будет значением I_h с предыдущей итерации
+
+    // Максимальное количество итераций для предотвращения зацикливания
+    // если точность не достигается (например, из-за особенностей функции или слишком жесткой epsilon).
+    constexpr int max_iterations = 2000;
+    int current_iteration = 0;
+
+    // Минимальное количество разбиений n для надежной оценки погрешности по правилу Рунге,
+    // особенно для методов высокого порядка точности (как Симпсон, p=4).
+    // При малых n оценка Рунге может быть нестабильной или неточной.
+    int min_n_for_reliable_runge = 1; // По умолчанию
+    if (p == 4) {
+        // Для Симпсона (p=4) эмпирически выбирают n >= 4 или n >= 8.
+        // В отчете для Симпсона n начинается с 4, итоговое n=8 (после удвоения).
+        // Здесь n начинается с 2 (или 4 если было нечетное), потом 4, 8...
+        min_n_for_reliable_runge = 8;
+    }
+
+
+    do {
+        I_2h = I_h; // Сохраняем предыдущее значение интеграла (это I_h для предыдущего n, т.е. I_2h для текущего удвоенного n)
+        sequence.refine(); // Удваиваем количество разбиений (уменьшаем шаг h вдвое)
+        n = sequence.intervals();
+        I_h = sequence.value(); // Интеграл с новым, меньшим шагом
+
+        // Оценка погрешности по правилу Рунге: R_h ≈ (I_h - I_2h) / (2^p - 1)
+        double error_estimate_component = I_h - I_2h; // Числитель в оценке Рунге
+        double runge_denominator = std::pow(2, p) - 1.0;
+        double current_error_estimate = std::abs(error_estimate_component) / runge_denominator;
+        trace("Runge", TraceEvent::Iteration, current_iteration, I_h, current_error_estimate, static_cast<double>(n), 0);
+
+        // Условие остановки итерационного процесса:
+        bool stopping_condition_met = (current_error_estimate < epsilon);
+
+        // Дополнительная проверка для методов высокого порядка (как Симпсон):
+        // Продолжаем итерации, если n еще слишком мало для надежной оценки по Рунге,
+        // даже если формальная оценка погрешности мала. Это предотвращает преждевременную остановку
+        // на нестабильных оценках при малых n.
+        if (p >= 4 && n < min_n_for_reliable_runge && stopping_condition_met && current_iteration < max_iterations -1 ) {
+            stopping_condition_met = false; // Форсируем продолжение итераций
+        }
+
+
+        if (stopping_condition_met) {
+            n_final = n; // Сохраняем итоговое количество разбиений
+            // Возвращаем уточненное значение по Ричардсону: I_уточн = I_h + (I_h - I_2h) / (2^p - 1)
+            // (I_h - I_2h) / (2^p - 1)  это error_estimate_component / runge_denominator (со знаком)
+            return I_h + (error_estimate_component / runge_denominator);
+        }
+
+        current_iteration++;
+        // Предохранитель от слишком большого числа разбиений (и слишком долгого вычисления)
+        if (n > 4000000) { // Порог можно настроить
+             trace("Runge", TraceEvent::MaxIterations, current_iteration, I_h, current_error_estimate,
+                   static_cast<double>(n), 0);
+             break; // Выход из цикла, если n становится слишком большим
+        }
+
+    } while (current_iteration < max_iterations);
+
+    // Если цикл завершился по max_iterations или по n > 4000000, а не по достижению точности
+    trace("Runge", TraceEvent::NotConverged, current_iteration, I_h, std::abs(I_h - I_2h) / (std::pow(2, p) - 1.0),
+          static_cast<double>(n), 0);
+    n_final = n;
+    // Возвращаем лучшее из имеющихся значений. Можно вернуть I_h или уточненное,
+    // если оно считается более надежным даже при неполной сходимости.
+    // В данном случае, если не сошлось, возвращаем последнее вычисленное I_h или его уточнение.
+    return I_h + (I_h - I_2h) / (std::pow(2,p) - 1.0); // Возвращаем последнее уточненное значение
+}
+
+/**
+ * @brief Адаптивный метод численного интегрирования с использованием правила Рунге и уточнения по Ричардсону.
+ *
+ * @details
+ * Смысл и теория:
+ * Этот подход не требует знания производных функции. Он основан на сравнении результатов,
+ * полученных с разным шагом, для оценки погрешности и адаптивного выбора шага.
+ *
+ * 1. Правило Рунге для оценки погрешности:
+ *    - Вычисляется интеграл I_h с текущим шагом h (число разбиений n).
+ *    - Вычисляется интеграл I_{2h} с шагом 2h (число разбиений n/2). В реализации I_{2h} - это I_h с предыдущей итерации.
+ *    - Если основной метод численного интегрирования имеет порядок точности p, то погрешность I_h
+ *      можно оценить как: R_h ≈ (I_h - I_{2h}) / (2^p - 1).
+ *    - Итерационный процесс: начинаем с малого n. Если оценка |R_h| больше заданной точности epsilon,
+ *      удваиваем n (уменьшаем шаг h вдвое) и повторяем вычисления.
+ *
+ * 2. Уточнение по Ричардсону (экстраполяция Ричардсона):
+ *    - Используя оценку погрешности R_h, можно получить более точное значение интеграла:
+ *      I_уточн = I_h + R_h = I_h + (I_h - I_{2h}) / (2^p - 1).
+ *    - Это уточненное значение обычно имеет более высокий порядок точности, чем исходный метод.
+ *
+ * Как решает задачу:
+ * Адаптивно подбирает шаг h (число разбиений n) "на лету", пока не будет достигнута
+ * требуемая точность epsilon. При этом также позволяет улучшить итоговый результат.
+ *
+ * Плюсы:
+ * - Не требует вычисления производных подынтегральной функции.
+ * - Адаптируется к поведению функции (хотя в данной реализации шаг глобальный, но число n подбирается).
+ * - Уточнение по Ричардсону часто дает значительный прирост точности.
+ * - Более универсален, чем методы, требующие M2.
+ *
+ * Минусы:
+ * - Выполняет вычисления интеграла несколько раз (минимум дважды для каждой итерации подбора шага).
+ * - Оценка погрешности по Рунге является асимптотической (хорошо работает при достаточно малых h).
+ * - Для методов высокого порядка (как Симпсон), правило Рунге становится надежным при достаточно большом n,
+ *   чтобы главная часть погрешности действительно доминировала (поэтому используется min_n_for_reliable_runge).
+ *
+ * @param integrator Вызываемый объект integrator(a, b, n), реализующий один из методов численного интегрирования
+ *                   (например, лямбда над trapezoidal_rule или simpsons_rule). Тип - параметр шаблона,
+ *                   поэтому вызов встраивается; std::function принимается перегрузкой ниже.
+ * @param a Нижний предел интегрирования.
+ * @param b Верхний предел интегрирования.
+ * @param epsilon Требуемая точность.
+ * @param p Порядок точности метода, используемого в 'integrator' (2 для трапеций, 4 для Симпсона).
+ * @param n_final Ссылка для возврата итогового количества разбиений, при котором была достигнута точность.
+ * @return Уточненное значение интеграла.
+ */
+template <typename Rule>
+double integrate_with_runge(Rule&& integrator,
+                            const double a, const double b, double epsilon, const int p, int& n_final) {
+    // Начальное количество разбиений.
+    // Обычно начинают с малого числа, например, 2.
+    int n = 2;
+    // Для метода Симпсона (p=4) n должно быть четным.
+    // Если начальное n нечетное, делаем его четным.
+    // Также, если начальное n слишком мало (например, 0 или 1), устанавливаем минимальное четное n=2.
+    if (p == 4) {
+        n = (n % 2 == 0) ? n : n + 1;
+        if (n == 0) n = 2;
+    }
+
+
+    RuleRefinement<typename std::remove_reference<Rule>::type> sequence(integrator, a, b, n);
+    return integrate_runge_sequence(sequence, epsilon, p, n_final);
+}
+
+// Вариант со стиранием типа: правило передается через std::function (вызов не встраивается)
+inline double integrate_with_runge(const std::function<double(double, double, int)>& integrator,
+                                   const double a, const double b, double epsilon, const int p, int& n_final) {
+    return integrate_with_runge<const std::function<double(double, double, int)>&>(integrator, a, b, epsilon, p, n_final);
+}
+
+// Вложенные сетки метода трапеций: при переходе от n к 2n старые узлы сохраняются,
+// и функция вычисляется только в n новых серединах: T_{2n} = (T_n + M_n) / 2,
+// где M_n - формула центральных прямоугольников на текущей сетке.
+template <typename F>
+class TrapezoidRefinement {
+public:
+    TrapezoidRefinement(F& f, double a, double b, int n, ThreadPool* pool = nullptr)
+        : f_(f), a_(a), b_(b), n_(std::max(n, 1)), h_((b - a) / n_), pool_(pool) {
+        sum_.add((quadrature_value(f_, a_) + quadrature_value(f_, b_)) / 2.0);
+        sum_.add(quadrature_sum(f_, a_, h_, 0.0, 1, n_, pool_));
+        evaluations_ = n_ + 1;
+    }
+
+    int intervals() const { return n_; }
+    double value() const { return h_ * sum_.value(); }
+    long long evaluations() const { return evaluations_; } // Число вычислений функции на всех уровнях
+
+    void refine() {
+        // Новые узлы - середины подынтервалов текущей сетки
+        sum_.add(quadrature_sum(f_, a_, h_, 0.5, 0, n_, pool_));
+        evaluations_ += n_;
+        n_ *= 2;
+        h_ = (b_ - a_) / n_;
+    }
+
+private:
+    F& f_;
+    double a_;
+    double b_;
+    int n_;
+    double h_;
+    ThreadPool* pool_;
+    CompensatedSum sum_;        // (f(a) + f(b)) / 2 + сумма по внутренним узлам
+    long long evaluations_ = 0;
+};
+
+// Формула Симпсона по двум уровням трапеций: S_n = (4 T_n - T_{n/2}) / 3.
+// Совпадает с simpsons_rule(f, a, b, n), но использует узлы предыдущих уровней.
+template <typename F>
+class SimpsonRefinement {
+public:
+    SimpsonRefinement(F& f, double a, double b, int n, ThreadPool* pool = nullptr)
+        : trapezoid_(f, a, b, std::max(n + n % 2, 2) / 2, pool) {
+        coarse_ = trapezoid_.value();
+        trapezoid_.refine();
+        fine_ = trapezoid_.value();
+    }
+
+    int intervals() const { return trapezoid_.intervals(); }
+    double value() const { return (4.0 * fine_ - coarse_) / 3.0; }
+    long long evaluations() const { return trapezoid_.evaluations(); }
+
+    void refine() {
+        coarse_ = fine_;
+        trapezoid_.refine();
+        fine_ = trapezoid_.value();
+    }
+
+private:
+    TrapezoidRefinement<F> trapezoid_;
+    double coarse_; // T_{n/2}
+    double fine_;   // T_n
+};
+
+// Правило Рунге для метода трапеций (p = 2) на вложенных сетках: каждое удвоение n
+// стоит n новых вычислений функции вместо 2n + 1 у integrate_with_runge.
+template <typename F>
+double integrate_trapezoidal_runge(F&& f, double a, double b, double epsilon, int& n_final,
+                                   ThreadPool* pool = nullptr) {
+    TrapezoidRefinement<typename std::remove_reference<F>::type> sequence(f, a, b, 2, pool);
+    return integrate_runge_sequence(sequence, epsilon, 2, n_final);
+}
+
+// Правило Рунге для метода Симпсона (p = 4) на вложенных сетках трапеций
+template <typename F>
+double integrate_simpson_runge(F&& f, double a, double b, double epsilon, int& n_final,
+                               ThreadPool* pool = nullptr) {
+    SimpsonRefinement<typename std::remove_reference<F>::type> sequence(f, a, b, 2, pool);
+    return integrate_runge_sequence(sequence, epsilon, 4, n_final);
+}
+
+// Наибольшее число строк таблицы Ромберга (n до 2^(ROMBERG_MAX_LEVELS - 1))
+constexpr int ROMBERG_MAX_LEVELS = 24;
+
+// Метод Ромберга: экстраполяция Ричардсона по вложенным сеткам трапеций.
+// R[k][0] = T_{2^k}, R[k][j] = R[k][j-1] + (R[k][j-1] - R[k-1][j-1]) / (4^j - 1);
+// столбец j = 1 - формула Симпсона, j = 2 - формула Буля. Хранятся только две строки таблицы.
+// Остановка, когда диагональные элементы двух последних строк отличаются меньше чем на epsilon.
+template <typename F>
+double romberg_integrate(F&& f, double a, double b, double epsilon, int& n_final,
+                         int max_levels = ROMBERG_MAX_LEVELS, ThreadPool* pool = nullptr) {
+    max_levels = std::max(2, std::min(max_levels, ROMBERG_MAX_LEVELS));
+    TrapezoidRefinement<typename std::remove_reference<F>::type> trapezoid(f, a, b, 1, pool);
+
+    std::array<double, ROMBERG_MAX_LEVELS> previous{};
+    std::array<double, ROMBERG_MAX_LEVELS> current{};
+    previous[0] = trapezoid.value();
+    for (int k = 1; k < max_levels; ++k) {
+        trapezoid.refine();
+        current[0] = trapezoid.value();
+        double power_of_4 = 1.0;
+        for (int j = 1; j <= k; ++j) {
+            power_of_4 *= 4.0;
+            current[j] = current[j - 1] + (current[j - 1] - previous[j - 1]) / (power_of_4 - 1.0);
+        }
+        // Первые две строки еще не дают надежной оценки (как min_n_for_reliable_runge в правиле Рунге)
+        trace("Romberg", TraceEvent::Iteration, k, current[k], std::abs(current[k] - previous[k - 1]),
+              static_cast<double>(trapezoid.intervals()), trapezoid.intervals() + 1);
+        if (k >= 2 && std::abs(current[k] - previous[k - 1]) < epsilon) {
+            n_final = trapezoid.intervals();
+            return current[k];
+        }
+        previous = current;
+    }
+
+    trace("Romberg", TraceEvent::NotConverged, max_levels, previous[max_levels - 1], 0.0,
+          static_cast<double>(trapezoid.intervals()), trapezoid.intervals() + 1);
+    n_final = trapezoid.intervals();
+    return previous[max_levels - 1];
+}
+
+// Узлы и веса правила Гаусса-Кронрода G7-K15 на [-1, 1] (по симметрии хранятся x >= 0).
+// Узлы с нечетными номерами (1, 3, 5, 7) - узлы правила Гаусса G7.
+constexpr double GK15_NODES[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000};
+constexpr double GK15_KRONROD_WEIGHTS[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+constexpr double GK15_GAUSS_WEIGHTS[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+// Наибольшее число подынтервалов в адаптивном методе по умолчанию
+constexpr int GK_MAX_INTERVALS = 10000;
+
+// Подынтервал с оценкой интеграла K15 и погрешности |K15 - G7|
+struct QuadratureInterval {
+    double a;
+    double b;
+    double value;
+    double error;
+
+    bool operator<(const QuadratureInterval& other) const { return error < other.error; }
+};
+
+// Правило G7-K15 на [a, b]: 15 вычислений функции (одним пакетом для batch_integrand)
+template <typename F>
+QuadratureInterval gauss_kronrod_15(F& f, double a, double b) {
+    const double center = 0.5 * (a + b);
+    const double half = 0.5 * (b - a);
+    double xs[15];
+    double fx[15];
+    for (int k = 0; k < 7; ++k) {
+        xs[2 * k] = center - half * GK15_NODES[k];
+        xs[2 * k + 1] = center + half * GK15_NODES[k];
+    }
+    xs[14] = center;
+    quadrature_values(f, xs, fx, 15);
+
+    double kronrod = GK15_KRONROD_WEIGHTS[7] * fx[14];
+    double gauss = GK15_GAUSS_WEIGHTS[3] * fx[14];
+    for (int k = 0; k < 7; ++k) {
+        const double pair = fx[2 * k] + fx[2 * k + 1];
+        kronrod += GK15_KRONROD_WEIGHTS[k] * pair;
+        if (k % 2 == 1) gauss += GK15_GAUSS_WEIGHTS[k / 2] * pair;
+    }
+    return {a, b, kronrod * half, std::abs((kronrod - gauss) * half)};
+}
+
+// Результат адаптивного интегрирования
+struct AdaptiveQuadratureResult {
+    double value = 0.0;          // Приближенное значение интеграла
+    double error = 0.0;          // Оценка абсолютной погрешности (сумма |K15 - G7| по подынтервалам)
+    long long evaluations = 0;   // Число вычислений функции
+    int intervals = 0;           // Итоговое число подынтервалов
+    bool converged = false;      // Достигнута ли точность epsilon
+};
+
+// Адаптивный метод Гаусса-Кронрода: подынтервалы хранятся в куче по оценке погрешности,
+// и на каждом шаге делится пополам только худший. В отличие от правила Рунге, сетка
+// сгущается только там, где функция плохо приближается (пики, особенности).
+// Остановка, когда суммарная оценка погрешности меньше epsilon, либо при max_intervals подынтервалах.
+template <typename F>
+AdaptiveQuadratureResult gauss_kronrod_integrate(F&& f, double a, double b, double epsilon,
+                                                 int max_intervals = GK_MAX_INTERVALS) {
+    AdaptiveQuadratureResult result;
+    std::vector<QuadratureInterval> storage;
+    storage.reserve(static_cast<std::size_t>(std::max(max_intervals, 1)));
+    std::priority_queue<QuadratureInterval> heap(std::less<QuadratureInterval>(), std::move(storage));
+
+    const QuadratureInterval whole = gauss_kronrod_15(f, a, b);
+    heap.push(whole);
+    result.evaluations = 15;
+    double total_error = whole.error;
+
+    while (total_error >= epsilon && static_cast<int>(heap.size()) < max_intervals) {
+        const QuadratureInterval worst = heap.top();
+        const double middle = 0.5 * (worst.a + worst.b);
+        if (middle <= std::min(worst.a, worst.b) || middle >= std::max(worst.a, worst.b)) {
+            break; // Подынтервал больше не делится в арифметике с плавающей точкой
+        }
+        heap.pop();
+        const QuadratureInterval left = gauss_kronrod_15(f, worst.a, middle);
+        const QuadratureInterval right = gauss_kronrod_15(f, middle, worst.b);
+        result.evaluations += 30;
+        total_error += left.error + right.error - worst.error;
+        trace("Gauss-Kronrod", TraceEvent::Iteration, static_cast<long long>(heap.size()), middle, total_error,
+              worst.b - worst.a, result.evaluations);
+        heap.push(left);
+        heap.push(right);
+    }
+
+    // Итоговые суммы пересчитываются заново, чтобы не накапливать ошибку округления обновлений
+    result.intervals = static_cast<int>(heap.size());
+    total_error = 0.0;
+    while (!heap.empty()) {
+        result.value += heap.top().value;
+        total_error += heap.top().error;
+        heap.pop();
+    }
+    result.error = total_error;
+    result.converged = total_error < epsilon;
+    if (!result.converged) {
+        trace("Gauss-Kronrod", TraceEvent::NotConverged, result.intervals, result.value, total_error, 0.0,
+              result.evaluations);
+    }
+    return result;
+}
+
+#endif //COMP_MATH_QUADRATURE_H
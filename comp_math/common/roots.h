@@ -0,0 +1,652 @@
+#ifndef COMP_MATH_ROOTS_H
+#define COMP_MATH_ROOTS_H
+
+#include <cstddef>
+#include <cmath>        // Для std::abs, std::isfinite
+#include <span>
+#include <limits>       // Для std::numeric_limits
+#include <algorithm>    // Для std::min, std::max
+#include <utility>      // Для std::swap
+#include <stdexcept>    // Для std::invalid_argument
+
+#include "thread_pool.h"
+#include "trace.h"      // Трассировка итераций
+
+// Нахождение корней уравнений f(x) = 0.
+// Функция - любой вызываемый объект f(x) (параметр шаблона, вызов встраивается).
+// Итерации передаются наблюдателю observer(const RootIteration&); по умолчанию наблюдатель пустой,
+// и в цикле нет ничего, кроме вычислений - таблицы итераций печатает вызывающий код.
+// Те же итерации записываются в трассу (trace.h), если она подключена.
+// Пакетный режим (find_roots_*) решает много независимых уравнений сразу: уравнения идут блоками
+// по ROOT_BATCH_LANES, шаги всех уравнений блока считаются одним циклом без ветвлений
+// (векторизуется по уравнениям), а сошедшиеся уравнения отмечаются маской и больше не меняются.
+
+// Итог поиска корня
+enum class RootStatus {
+    Converged,      // Достигнута заданная точность
+    MaxIterations,  // Точность не достигнута за отведенное число итераций
+    NoSignChange,   // f(a) и f(b) одного знака - отрезок не содержит гарантированного корня
+    BadValue,       // Получено NaN или бесконечность
+    ZeroDerivative  // Производная близка к нулю (метод Ньютона без отрезка)
+};
+
+struct RootResult {
+    double root = std::numeric_limits<double>::quiet_NaN();
+    double f_root = std::numeric_limits<double>::quiet_NaN(); // f в найденном корне
+    double a = std::numeric_limits<double>::quiet_NaN();      // Последний отрезок, содержащий корень
+    double b = std::numeric_limits<double>::quiet_NaN();      // (для методов без отрезка - NaN)
+    int iterations = 0;
+    long long evaluations = 0; // Число вычислений f (и f' для метода Ньютона)
+    RootStatus status = RootStatus::MaxIterations;
+
+    bool converged() const { return status == RootStatus::Converged; }
+};
+
+// Состояние на одной итерации, передаваемое наблюдателю
+struct RootIteration {
+    int iteration;
+    double x;      // Текущее приближение
+    double fx;     // f(x) (для метода простой итерации - g(x))
+    double step;   // |x_{k+1} - x_k| или половина длины отрезка
+    double a;      // Текущий отрезок (для методов без отрезка - NaN)
+    double b;
+};
+
+// Наблюдатель по умолчанию: ничего не делает, вызов исчезает при встраивании
+struct NoRootObserver {
+    void operator()(const RootIteration&) const {}
+};
+
+constexpr int ROOT_MAX_ITERATIONS = 1000;
+
+namespace roots_detail {
+
+constexpr double nan() { return std::numeric_limits<double>::quiet_NaN(); }
+
+// Результат, когда на границе отрезка корень найден точно или f(a), f(b) одного знака
+inline bool bracket_endpoints(double a, double b, double fa, double fb, RootResult& result) {
+    result.a = a;
+    result.b = b;
+    if (!std::isfinite(fa) || !std::isfinite(fb)) {
+        result.status = RootStatus::BadValue;
+        return false;
+    }
+    if (fa == 0.0 || fb == 0.0) {
+        result.root = fa == 0.0 ? a : b;
+        result.f_root = 0.0;
+        result.status = RootStatus::Converged;
+        return false;
+    }
+    if ((fa < 0.0) == (fb < 0.0)) {
+        result.status = RootStatus::NoSignChange;
+        return false;
+    }
+    return true;
+}
+
+} // namespace roots_detail
+
+/**
+ * @brief Метод половинного деления.
+ *
+ * @details
+ * Отрезок [a, b] с f(a) * f(b) < 0 делится пополам, и остается та половина, на концах которой
+ * f имеет разные знаки. За итерацию длина отрезка уменьшается вдвое (линейная сходимость),
+ * зато метод сходится всегда, если f непрерывна.
+ * Итерации продолжаются, пока длина отрезка больше epsilon; корень - середина последнего отрезка.
+ *
+ * @return RootResult; status == NoSignChange, если f(a) и f(b) одного знака.
+ */
+template <typename F, typename Observer = NoRootObserver>
+RootResult bisection(F&& f, double a, double b, double epsilon,
+                     Observer&& observer = {}, int max_iterations = ROOT_MAX_ITERATIONS) {
+    RootResult result;
+    if (a > b) std::swap(a, b);
+    double fa = f(a);
+    const double fb = f(b);
+    result.evaluations = 2;
+    if (!roots_detail::bracket_endpoints(a, b, fa, fb, result)) return result;
+
+    while (b - a > epsilon) {
+        if (result.iterations == max_iterations) break;
+        ++result.iterations;
+        const double c = 0.5 * (a + b);
+        const double fc = f(c);
+        ++result.evaluations;
+        observer(RootIteration{result.iterations, c, fc, 0.5 * (b - a), a, b});
+        trace("bisection", TraceEvent::Iteration, result.iterations, c, std::abs(fc), 0.5 * (b - a), result.evaluations);
+        if (fc == 0.0) {
+            a = b = c;
+            fa = 0.0;
+            break;
+        }
+        if ((fc < 0.0) == (fa < 0.0)) {
+            a = c;
+            fa = fc;
+        } else {
+            b = c;
+        }
+    }
+
+    result.a = a;
+    result.b = b;
+    result.root = 0.5 * (a + b);
+    result.f_root = f(result.root);
+    ++result.evaluations;
+    result.status = b - a <= epsilon ? RootStatus::Converged : RootStatus::MaxIterations;
+    return result;
+}
+
+/**
+ * @brief Метод Брента (комбинация бисекции, секущих и обратной квадратичной интерполяции).
+ *
+ * @details
+ * На каждой итерации пробуется интерполяционный шаг (обратная квадратичная интерполяция по трем
+ * последним точкам или секущая по двум); если он выходит за отрезок или уменьшает отрезок слишком
+ * медленно, делается шаг бисекции. Поэтому сходимость гарантирована, как у бисекции,
+ * а для гладких функций - сверхлинейная. Остановка: |b - a| / 2 <= epsilon + 2 * eps * |b|.
+ *
+ * @return RootResult; status == NoSignChange, если f(a) и f(b) одного знака.
+ */
+template <typename F, typename Observer = NoRootObserver>
+RootResult brent(F&& f, double a, double b, double epsilon,
+                 Observer&& observer = {}, int max_iterations = ROOT_MAX_ITERATIONS) {
+    RootResult result;
+    if (a > b) std::swap(a, b);
+    double fa = f(a);
+    double fb = f(b);
+    result.evaluations = 2;
+    if (!roots_detail::bracket_endpoints(a, b, fa, fb, result)) return result;
+
+    // b - лучшее приближение, [b, c] содержит корень, a - предыдущее значение b
+    double c = a, fc = fa;
+    double d = b - a, e = d;
+    result.status = RootStatus::MaxIterations;
+    for (result.iterations = 1; result.iterations <= max_iterations; ++result.iterations) {
+        if ((fb < 0.0) == (fc < 0.0)) {
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (std::abs(fc) < std::abs(fb)) {
+            a = b; b = c; c = a;
+            fa = fb; fb = fc; fc = fa;
+        }
+
+        const double tol = 2.0 * std::numeric_limits<double>::epsilon() * std::abs(b) + epsilon;
+        const double m = 0.5 * (c - b);
+        observer(RootIteration{result.iterations, b, fb, std::abs(m), std::min(b, c), std::max(b, c)});
+        trace("brent", TraceEvent::Iteration, result.iterations, b, std::abs(fb), std::abs(m), result.evaluations);
+        if (std::abs(m) <= tol || fb == 0.0) {
+            result.status = RootStatus::Converged;
+            break;
+        }
+
+        if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb)) {
+            // Интерполяционный шаг p / q
+            double p, q;
+            const double s = fb / fa;
+            if (a == c) {
+                p = 2.0 * m * s; // Секущая
+                q = 1.0 - s;
+            } else {
+                const double qa = fa / fc, r = fb / fc; // Обратная квадратичная интерполяция
+                p = s * (2.0 * m * qa * (qa - r) - (b - a) * (r - 1.0));
+                q = (qa - 1.0) * (r - 1.0) * (s - 1.0);
+            }
+            if (p > 0.0) q = -q;
+            else p = -p;
+            if (2.0 * p < std::min(3.0 * m * q - std::abs(tol * q), std::abs(e * q))) {
+                e = d;
+                d = p / q;
+            } else {
+                d = m; // Интерполяция неудачна - бисекция
+                e = m;
+            }
+        } else {
+            d = m;
+            e = m;
+        }
+
+        a = b;
+        fa = fb;
+        b += std::abs(d) > tol ? d : (m > 0.0 ? tol : -tol);
+        fb = f(b);
+        ++result.evaluations;
+        if (!std::isfinite(fb)) {
+            result.status = RootStatus::BadValue;
+            break;
+        }
+    }
+    result.iterations = std::min(result.iterations, max_iterations);
+
+    result.root = b;
+    result.f_root = fb;
+    result.a = std::min(b, c);
+    result.b = std::max(b, c);
+    return result;
+}
+
+/**
+ * @brief Метод Ньютона с защитой бисекцией.
+ *
+ * @details
+ * Шаг Ньютона x - f(x) / f'(x) делается, только если он остается внутри текущего
+ * отрезка [a, b] с f(a) * f(b) < 0 и уменьшает шаг хотя бы вдвое по сравнению с позапрошлым;
+ * иначе делается шаг бисекции. После каждого вычисления отрезок сужается по знаку f,
+ * поэтому метод сходится всегда, а вблизи простого корня - квадратично.
+ * Остановка: |x_{k+1} - x_k| < epsilon.
+ *
+ * @param f Функция f(x).
+ * @param df Производная f'(x).
+ * @param x0 Начальное приближение (если вне [a, b] - середина отрезка).
+ */
+template <typename F, typename DF, typename Observer = NoRootObserver>
+RootResult newton_safeguarded(F&& f, DF&& df, double a, double b, double x0, double epsilon,
+                              Observer&& observer = {}, int max_iterations = ROOT_MAX_ITERATIONS) {
+    RootResult result;
+    if (a > b) std::swap(a, b);
+    double fa = f(a);
+    const double fb = f(b);
+    result.evaluations = 2;
+    if (!roots_detail::bracket_endpoints(a, b, fa, fb, result)) return result;
+
+    double x = (x0 > a && x0 < b) ? x0 : 0.5 * (a + b);
+    double dx_old = b - a, dx = dx_old;
+    double fx = f(x), dfx = df(x);
+    result.evaluations += 2;
+    for (result.iterations = 1; result.iterations <= max_iterations; ++result.iterations) {
+        if (!std::isfinite(fx) || !std::isfinite(dfx)) {
+            result.status = RootStatus::BadValue;
+            break;
+        }
+        if (fx == 0.0) {
+            result.status = RootStatus::Converged; // Начальное приближение - точный корень
+            --result.iterations;
+            break;
+        }
+        // Сужение отрезка по знаку f(x)
+        if ((fx < 0.0) == (fa < 0.0)) {
+            a = x;
+            fa = fx;
+        } else {
+            b = x;
+        }
+
+        const double x_newton = x - fx / dfx;
+        const bool newton_ok = dfx != 0.0 && x_newton > a && x_newton < b
+                               && std::abs(2.0 * fx) <= std::abs(dx_old * dfx);
+        dx_old = dx;
+        const double x_next = newton_ok ? x_newton : 0.5 * (a + b);
+        dx = x_next - x;
+        observer(RootIteration{result.iterations, x, fx, std::abs(dx), a, b});
+        trace("newton-safeguarded", TraceEvent::Iteration, result.iterations, x, std::abs(fx), std::abs(dx),
+              result.evaluations);
+
+        x = x_next;
+        fx = f(x);
+        dfx = df(x);
+        result.evaluations += 2;
+        if (std::abs(dx) < epsilon || fx == 0.0) {
+            result.status = RootStatus::Converged;
+            break;
+        }
+    }
+    result.iterations = std::min(result.iterations, max_iterations);
+
+    result.root = x;
+    result.f_root = fx;
+    result.a = a;
+    result.b = b;
+    return result;
+}
+
+/**
+ * @brief Метод Ньютона (касательных) без отрезка.
+ *
+ * @details
+ * x_{k+1} = x_k - f(x_k) / f'(x_k). Сходится квадратично вблизи простого корня,
+ * но только при удачном начальном приближении. Остановка: |x_{k+1} - x_k| < epsilon и |f(x_{k+1})| < epsilon
+ * (одной малой поправки недостаточно: вдали от корня при большой производной поправки тоже малы).
+ * Если корень можно заключить в отрезок, надежнее newton_safeguarded.
+ */
+template <typename F, typename DF, typename Observer = NoRootObserver>
+RootResult newton(F&& f, DF&& df, double x0, double epsilon,
+                  Observer&& observer = {}, int max_iterations = ROOT_MAX_ITERATIONS) {
+    RootResult result;
+    double x = x0;
+    double fx = f(x);
+    ++result.evaluations;
+    for (result.iterations = 1; result.iterations <= max_iterations; ++result.iterations) {
+        const double dfx = df(x);
+        ++result.evaluations;
+        if (!std::isfinite(fx) || !std::isfinite(dfx)) {
+            result.status = RootStatus::BadValue;
+            break;
+        }
+        if (std::abs(dfx) < 1e-15) {
+            result.status = RootStatus::ZeroDerivative;
+            break;
+        }
+        const double delta = fx / dfx;
+        observer(RootIteration{result.iterations, x, fx, std::abs(delta), roots_detail::nan(), roots_detail::nan()});
+        trace("newton", TraceEvent::Iteration, result.iterations, x, std::abs(fx), std::abs(delta), result.evaluations);
+
+        x -= delta;
+        fx = f(x);
+        ++result.evaluations;
+        if (std::abs(delta) < epsilon && std::abs(fx) < epsilon) {
+            result.status = RootStatus::Converged;
+            break;
+        }
+    }
+    result.iterations = std::min(result.iterations, max_iterations);
+
+    result.root = x;
+    result.f_root = fx;
+    return result;
+}
+
+/**
+ * @brief Метод простой итерации x_{k+1} = g(x_k).
+ *
+ * @details
+ * Сходится, если |g'(x)| < 1 в окрестности корня; скорость линейная со знаменателем max|g'|.
+ * Остановка: |x_{k+1} - x_k| < epsilon. В RootResult::f_root записывается g(root) - root.
+ */
+template <typename G, typename Observer = NoRootObserver>
+RootResult simple_iteration(G&& g, double x0, double epsilon,
+                            Observer&& observer = {}, int max_iterations = ROOT_MAX_ITERATIONS) {
+    RootResult result;
+    double x = x0;
+    for (result.iterations = 1; result.iterations <= max_iterations; ++result.iterations) {
+        const double x_next = g(x);
+        ++result.evaluations;
+        if (!std::isfinite(x_next)) {
+            result.status = RootStatus::BadValue;
+            break;
+        }
+        const double diff = std::abs(x_next - x);
+        observer(RootIteration{result.iterations, x, x_next, diff, roots_detail::nan(), roots_detail::nan()});
+        trace("simple-iteration", TraceEvent::Iteration, result.iterations, x, std::abs(x_next - x), diff,
+              result.evaluations);
+        x = x_next;
+        if (diff < epsilon) {
+            result.status = RootStatus::Converged;
+            break;
+        }
+    }
+    result.iterations = std::min(result.iterations, max_iterations);
+
+    result.root = x;
+    result.f_root = g(x) - x;
+    ++result.evaluations;
+    return result;
+}
+
+// --- Пакетный режим: много независимых уравнений f_i(x) = 0 ---
+// Функция блока - пакетный вызов f(first, xs, fx, lanes): fx[l] = f_{first + l}(xs[l]), l = 0..lanes-1
+// (так, например, обращается калибровочная кривая: f_i(x) = c(x) - y_i).
+// У каждого уравнения свой отрезок [a_i, b_i]; результаты - roots[i] и, если передан, results[i].
+// Уравнения распределяются по потокам пула блоками; результат не зависит от числа потоков.
+
+// Число уравнений, решаемых синхронно в одном блоке
+constexpr std::size_t ROOT_BATCH_LANES = 64;
+
+namespace roots_detail {
+
+// Общий цикл пакетных методов по блокам уравнений.
+// Block(first, lanes, a, b, roots, results) решает уравнения first .. first + lanes - 1.
+template <typename Block>
+void for_each_root_block(std::size_t count, std::span<const double> a, std::span<const double> b,
+                         std::span<double> roots, std::span<RootResult> results, ThreadPool& pool, Block&& block) {
+    if (a.size() != count || b.size() != count || roots.size() != count
+        || (!results.empty() && results.size() != count)) {
+        throw std::invalid_argument("Размеры буферов не соответствуют числу уравнений.");
+    }
+    const std::size_t blocks = (count + ROOT_BATCH_LANES - 1) / ROOT_BATCH_LANES;
+    pool.parallel_for(0, blocks, 1, [&](std::size_t first_block, std::size_t last_block) {
+        for (std::size_t blk = first_block; blk < last_block; ++blk) {
+            const std::size_t first = blk * ROOT_BATCH_LANES;
+            const std::size_t lanes = std::min(ROOT_BATCH_LANES, count - first);
+            block(first, lanes, a.data() + first, b.data() + first, roots.data() + first,
+                  results.empty() ? nullptr : results.data() + first);
+        }
+    });
+}
+
+// Состояние блока уравнений: отрезки, значения на концах и маска активных уравнений
+struct RootLanes {
+    double a[ROOT_BATCH_LANES], b[ROOT_BATCH_LANES];
+    double fa[ROOT_BATCH_LANES], fb[ROOT_BATCH_LANES];
+    double x[ROOT_BATCH_LANES], fx[ROOT_BATCH_LANES];
+    int side[ROOT_BATCH_LANES];         // Какой конец сдвигался на прошлой итерации (метод Иллинойс)
+    int iterations[ROOT_BATCH_LANES];
+    unsigned char active[ROOT_BATCH_LANES];
+    unsigned char bracketed[ROOT_BATCH_LANES]; // Проверка отрезка пройдена (уравнение вычислялось внутри)
+    RootStatus status[ROOT_BATCH_LANES];
+};
+
+// Начальная проверка отрезков блока; возвращает число активных уравнений
+inline std::size_t init_lanes(RootLanes& s, std::size_t lanes, const double* a, const double* b) {
+    std::size_t active = 0;
+    for (std::size_t l = 0; l < lanes; ++l) {
+        s.a[l] = std::min(a[l], b[l]);
+        s.b[l] = std::max(a[l], b[l]);
+        s.side[l] = 0;
+        s.iterations[l] = 0;
+        RootResult check;
+        const bool bracketed = bracket_endpoints(s.a[l], s.b[l], s.fa[l], s.fb[l], check);
+        s.status[l] = check.status;
+        s.x[l] = bracketed ? 0.5 * (s.a[l] + s.b[l]) : check.root;
+        s.fx[l] = bracketed ? nan() : check.f_root;
+        s.active[l] = bracketed;
+        s.bracketed[l] = bracketed;
+        active += bracketed;
+    }
+    return active;
+}
+
+// Точки для неактивных уравнений блока: в пользовательскую f не должны попадать NaN из неудачной проверки отрезка
+inline void init_idle_points(const RootLanes& s, std::size_t lanes, const double* a, double* idle_x) {
+    for (std::size_t l = 0; l < lanes; ++l) {
+        idle_x[l] = std::isfinite(s.x[l]) ? s.x[l] : (std::isfinite(a[l]) ? a[l] : 0.0);
+    }
+}
+
+// endpoint_evaluations - вычисления на концах отрезка (у всех уравнений), start_evaluations - в начальной
+// точке (только у прошедших проверку отрезка), per_iteration - на одной итерации
+inline void store_lanes(const RootLanes& s, std::size_t lanes, long long endpoint_evaluations,
+                        long long start_evaluations, long long per_iteration, double* roots, RootResult* results) {
+    for (std::size_t l = 0; l < lanes; ++l) {
+        roots[l] = s.x[l];
+        if (results) {
+            RootResult& r = results[l];
+            r.root = s.x[l];
+            r.f_root = s.fx[l];
+            r.a = s.a[l];
+            r.b = s.b[l];
+            r.iterations = s.iterations[l];
+            r.evaluations = endpoint_evaluations + (s.bracketed[l] ? start_evaluations : 0)
+                            + per_iteration * s.iterations[l];
+            r.status = s.status[l];
+        }
+    }
+}
+
+} // namespace roots_detail
+
+/**
+ * @brief Пакетный поиск корней на отрезках методом Иллинойс с защитой бисекцией.
+ *
+ * @details
+ * Для каждого уравнения хорда (regula falsi) по концам отрезка [a_i, b_i]; если один и тот же конец
+ * остается на месте две итерации подряд, его значение f делится пополам (модификация Иллинойс),
+ * что дает сверхлинейную сходимость без застревания хорды. Если точка хорды не уменьшает отрезок
+ * (вырожденный знаменатель или выход за отрезок), берется середина.
+ * Все шаги блока считаются одним циклом с выбором без ветвлений, f вызывается пакетно по блоку.
+ * Уравнение считается решенным, когда длина отрезка <= 2 * epsilon или f(x) == 0;
+ * его x и отрезок после этого не меняются (маска active), а блок завершается, когда решены все.
+ * Неактивные уравнения передаются в f так же, как в find_roots_newton: решенные - в найденном корне,
+ * остальные - в исходном конце отрезка; их значения отбрасываются.
+ *
+ * @param f Пакетная функция f(first, xs, fx, lanes).
+ * @param count Число уравнений.
+ * @param a, b Концы отрезков (count значений каждый).
+ * @param roots Найденные корни (count значений).
+ * @param results Подробные результаты по уравнениям (пустой span - не нужны).
+ */
+template <typename BatchF>
+void find_roots_bracketed(BatchF&& f, std::size_t count, std::span<const double> a, std::span<const double> b,
+                          std::span<double> roots, double epsilon, std::span<RootResult> results = {},
+                          ThreadPool& pool = default_thread_pool(), int max_iterations = ROOT_MAX_ITERATIONS) {
+    using namespace roots_detail;
+    for_each_root_block(count, a, b, roots, results, pool,
+                        [&](std::size_t first, std::size_t lanes, const double* a_blk, const double* b_blk,
+                            double* roots_blk, RootResult* results_blk) {
+        RootLanes s;
+        f(first, a_blk, s.fa, lanes); // Для init_lanes: f на исходных концах (порядок концов учитывается ниже)
+        f(first, b_blk, s.fb, lanes);
+        for (std::size_t l = 0; l < lanes; ++l) {
+            if (a_blk[l] > b_blk[l]) std::swap(s.fa[l], s.fb[l]);
+        }
+        std::size_t active = init_lanes(s, lanes, a_blk, b_blk);
+        double idle_x[ROOT_BATCH_LANES];
+        init_idle_points(s, lanes, a_blk, idle_x);
+
+        for (int it = 0; it < max_iterations && active > 0; ++it) {
+            // Пробная точка: хорда, при вырождении - середина
+            double xs[ROOT_BATCH_LANES], fx[ROOT_BATCH_LANES];
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const double mid = 0.5 * (s.a[l] + s.b[l]);
+                const double chord = (s.a[l] * s.fb[l] - s.b[l] * s.fa[l]) / (s.fb[l] - s.fa[l]);
+                const bool inside = chord > s.a[l] && chord < s.b[l];
+                s.x[l] = s.active[l] ? (inside ? chord : mid) : s.x[l];
+                xs[l] = s.active[l] ? s.x[l] : idle_x[l];
+            }
+            f(first, xs, fx, lanes);
+            for (std::size_t l = 0; l < lanes; ++l) {
+                s.fx[l] = s.active[l] ? fx[l] : s.fx[l];
+            }
+            active = 0;
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const bool on = s.active[l];
+                const bool left = (s.fx[l] < 0.0) == (s.fa[l] < 0.0); // Корень правее x
+                // Сдвиг конца отрезка; неподвижный второй раз конец - Иллинойс (f / 2)
+                const double a_new = left ? s.x[l] : s.a[l];
+                const double b_new = left ? s.b[l] : s.x[l];
+                const double fa_new = left ? s.fx[l] : (s.side[l] < 0 ? 0.5 * s.fa[l] : s.fa[l]);
+                const double fb_new = left ? (s.side[l] > 0 ? 0.5 * s.fb[l] : s.fb[l]) : s.fx[l];
+                s.a[l] = on ? a_new : s.a[l];
+                s.b[l] = on ? b_new : s.b[l];
+                s.fa[l] = on ? fa_new : s.fa[l];
+                s.fb[l] = on ? fb_new : s.fb[l];
+                s.side[l] = on ? (left ? 1 : -1) : s.side[l];
+                s.iterations[l] += on;
+                const bool bad = !std::isfinite(s.fx[l]);
+                const bool done = s.b[l] - s.a[l] <= 2.0 * epsilon || s.fx[l] == 0.0;
+                s.status[l] = on ? (bad ? RootStatus::BadValue : (done ? RootStatus::Converged : s.status[l]))
+                                 : s.status[l];
+                s.active[l] = on && !bad && !done;
+                idle_x[l] = on && done && !bad ? s.x[l] : idle_x[l];
+                active += s.active[l];
+            }
+        }
+        store_lanes(s, lanes, 2, 0, 1, roots_blk, results_blk);
+    });
+}
+
+/**
+ * @brief Пакетный метод Ньютона с защитой бисекцией.
+ *
+ * @details
+ * То же, что newton_safeguarded, для каждого уравнения блока: шаг Ньютона принимается,
+ * если он остается внутри текущего отрезка и уменьшает шаг хотя бы вдвое по сравнению с позапрошлым,
+ * иначе берется середина; после каждого вычисления отрезок сужается по знаку f.
+ * Начальное приближение - середина [a_i, b_i].
+ * Остановка уравнения: |x_{k+1} - x_k| < epsilon или f(x) == 0.
+ * Неактивные уравнения передаются в fdf в фиксированной точке, а их результаты отбрасываются:
+ * решенные - в найденном корне, остальные (без смены знака, с некорректным значением) -
+ * в исходном конце отрезка.
+ *
+ * @param fdf Пакетная функция fdf(first, xs, fx, dfx, lanes): значения и производные уравнений блока.
+ */
+template <typename BatchFdF>
+void find_roots_newton(BatchFdF&& fdf, std::size_t count, std::span<const double> a, std::span<const double> b,
+                       std::span<double> roots, double epsilon, std::span<RootResult> results = {},
+                       ThreadPool& pool = default_thread_pool(), int max_iterations = ROOT_MAX_ITERATIONS) {
+    using namespace roots_detail;
+    for_each_root_block(count, a, b, roots, results, pool,
+                        [&](std::size_t first, std::size_t lanes, const double* a_blk, const double* b_blk,
+                            double* roots_blk, RootResult* results_blk) {
+        RootLanes s;
+        double dfx[ROOT_BATCH_LANES];
+        fdf(first, a_blk, s.fa, dfx, lanes);
+        fdf(first, b_blk, s.fb, dfx, lanes);
+        for (std::size_t l = 0; l < lanes; ++l) {
+            if (a_blk[l] > b_blk[l]) std::swap(s.fa[l], s.fb[l]);
+        }
+        std::size_t active = init_lanes(s, lanes, a_blk, b_blk);
+        double idle_x[ROOT_BATCH_LANES];
+        init_idle_points(s, lanes, a_blk, idle_x);
+        // Вычисление f и f' для активных уравнений; значения остальных не меняются
+        auto evaluate = [&] {
+            double xs[ROOT_BATCH_LANES], fx[ROOT_BATCH_LANES];
+            for (std::size_t l = 0; l < lanes; ++l) {
+                xs[l] = s.active[l] ? s.x[l] : idle_x[l];
+            }
+            fdf(first, xs, fx, dfx, lanes);
+            for (std::size_t l = 0; l < lanes; ++l) {
+                s.fx[l] = s.active[l] ? fx[l] : s.fx[l];
+            }
+        };
+        if (active > 0) {
+            evaluate();
+            active = 0;
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const bool exact = s.active[l] && s.fx[l] == 0.0; // Середина отрезка - точный корень
+                s.status[l] = exact ? RootStatus::Converged : s.status[l];
+                idle_x[l] = exact ? s.x[l] : idle_x[l];
+                s.active[l] = s.active[l] && !exact;
+                active += s.active[l];
+            }
+        }
+
+        double dx[ROOT_BATCH_LANES], dx_old[ROOT_BATCH_LANES];
+        for (std::size_t l = 0; l < lanes; ++l) {
+            dx[l] = dx_old[l] = s.b[l] - s.a[l];
+        }
+        for (int it = 0; it < max_iterations && active > 0; ++it) {
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const bool on = s.active[l];
+                const bool left = (s.fx[l] < 0.0) == (s.fa[l] < 0.0);
+                s.a[l] = on && left ? s.x[l] : s.a[l];
+                s.fa[l] = on && left ? s.fx[l] : s.fa[l];
+                s.b[l] = on && !left ? s.x[l] : s.b[l];
+                const double x_newton = s.x[l] - s.fx[l] / dfx[l];
+                const bool newton_ok = dfx[l] != 0.0 && x_newton > s.a[l] && x_newton < s.b[l]
+                                       && std::abs(2.0 * s.fx[l]) <= std::abs(dx_old[l] * dfx[l]);
+                const double x_next = newton_ok ? x_newton : 0.5 * (s.a[l] + s.b[l]);
+                dx_old[l] = on ? dx[l] : dx_old[l];
+                dx[l] = on ? x_next - s.x[l] : 0.0;
+                s.x[l] = on ? x_next : s.x[l];
+            }
+            evaluate();
+            active = 0;
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const bool on = s.active[l];
+                s.iterations[l] += on;
+                const bool bad = !std::isfinite(s.fx[l]) || !std::isfinite(dfx[l]);
+                const bool done = std::abs(dx[l]) < epsilon || s.fx[l] == 0.0;
+                s.status[l] = on ? (bad ? RootStatus::BadValue : (done ? RootStatus::Converged : s.status[l]))
+                                 : s.status[l];
+                s.active[l] = on && !bad && !done;
+                idle_x[l] = on && done && !bad ? s.x[l] : idle_x[l];
+                active += s.active[l];
+            }
+        }
+        store_lanes(s, lanes, 4, 2, 2, roots_blk, results_blk);
+    });
+}
+
+#endif //COMP_MATH_ROOTS_H
@@ -0,0 +1,71 @@
+#ifndef COMP_MATH_SOLVER_OUTPUT_H
+#define COMP_MATH_SOLVER_OUTPUT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <span>
+#include <algorithm>    // Для std::min, std::copy
+#include <stdexcept>    // Для std::invalid_argument
+#include <utility>      // Для std::move
+
+#include "binary_io.h"
+#include "ode.h"
+#include "spline.h"
+
+// Потоковая запись результатов решателей в двоичный формат (binary_io.h) без хранения их в памяти:
+// траектории ОДУ - по мере принятия шагов, значения сплайна на мелкой сетке - кусками.
+// Результат читается через BinaryFile(path).matrix<double>().
+
+// Наблюдатель solve_ode_auto_step / solve_ode_stiff: каждый принятый шаг - строка [x, y_0, ..., y_{n-1}]
+// (первая строка - начальная точка). Файл закрывается в деструкторе или вызовом close().
+class OdeTrajectoryWriter {
+public:
+    explicit OdeTrajectoryWriter(std::string path) : path_(std::move(path)) {}
+
+    void operator()(const OdeStep& step) {
+        const std::size_t n = step.y_end.size();
+        if (step.index == 0) {
+            writer_.open(path_, n + 1);
+            row_.resize(n + 1);
+        }
+        row_[0] = step.x_end;
+        std::copy(step.y_end.begin(), step.y_end.end(), row_.begin() + 1);
+        writer_.append(row_.data());
+    }
+
+    std::size_t rows() const { return writer_.rows(); }
+    void close() { writer_.close(); }
+
+private:
+    std::string path_;
+    BinaryRowWriter<double> writer_;
+    std::vector<double> row_;
+};
+
+// Длина куска точек при записи значений сплайна
+constexpr std::size_t SPLINE_RESAMPLE_CHUNK = 4096;
+
+// Значения сплайна в count равноотстоящих точках [a, b]: строки [x, S(x)].
+// Точки обрабатываются кусками пакетной оценкой evaluate_spline, память - O(куска).
+inline void write_spline_resample(const std::string& path, const SplineData& spline,
+                                  double a, double b, std::size_t count) {
+    if (count < 2) {
+        throw std::invalid_argument("Для записи значений сплайна нужно минимум 2 точки.");
+    }
+    BinaryRowWriter<double> writer(path, 2);
+    const double h = (b - a) / static_cast<double>(count - 1);
+    std::vector<double> xs(SPLINE_RESAMPLE_CHUNK), values(SPLINE_RESAMPLE_CHUNK);
+    for (std::size_t first = 0; first < count; first += SPLINE_RESAMPLE_CHUNK) {
+        const std::size_t length = std::min(SPLINE_RESAMPLE_CHUNK, count - first);
+        for (std::size_t k = 0; k < length; ++k) xs[k] = a + static_cast<double>(first + k) * h;
+        evaluate_spline(spline, std::span<const double>(xs.data(), length), std::span<double>(values.data(), length));
+        for (std::size_t k = 0; k < length; ++k) {
+            const double row[2] = {xs[k], values[k]};
+            writer.append(row);
+        }
+    }
+    writer.close();
+}
+
+#endif //COMP_MATH_SOLVER_OUTPUT_H
@@ -0,0 +1,592 @@
+#ifndef COMP_MATH_SPARSE_H
+#define COMP_MATH_SPARSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>        // Для std::abs, std::sqrt
+#include <vector>
+#include <limits>       // Для std::numeric_limits
+#include <stdexcept>    // Для std::runtime_error, std::invalid_argument
+#include <algorithm>    // Для std::sort, std::max, std::lower_bound
+#include <utility>      // Для std::move
+
+#include "matrix.h"
+#include "thread_pool.h"
+#include "summation.h"  // Скалярные произведения по кускам
+#include "trace.h"      // Трассировка итераций
+
+// Разреженные матрицы в формате CSR (построчно сжатое хранение) и итерационные методы на них.
+// Столбцы хранятся 32-битными индексами: на элемент приходится 12 байт вместо 16,
+// что для умножения на вектор (ограничено пропускной способностью памяти) заметно.
+// Умножение на вектор и векторные операции итерационных методов выполняются в пуле потоков;
+// скалярные произведения - компенсированные суммы по кускам (chunked_sum), поэтому итерации
+// не зависят от числа потоков.
+
+using SparseIndex = std::uint32_t;
+
+// Ненулевой элемент (i, j, value) для сборки матрицы
+struct SparseEntry {
+    std::size_t row;
+    std::size_t col;
+    double value;
+};
+
+// Минимальное число ненулевых элементов в куске параллельного умножения на вектор
+constexpr std::size_t SPMV_GRAIN_NNZ = 32768;
+
+// Минимальное число элементов в куске параллельных векторных операций
+constexpr std::size_t SPARSE_VECTOR_GRAIN = 16384;
+
+// Матрица в формате CSR: ненулевые элементы строки i - values[row_ptr[i] .. row_ptr[i + 1]),
+// их столбцы - col_idx в том же диапазоне, по возрастанию.
+class CsrMatrix {
+public:
+    CsrMatrix() : row_ptr_(1, 0) {}
+
+    // Сборка из списка элементов (в любом порядке); элементы с одинаковыми (i, j) суммируются
+    static CsrMatrix from_entries(std::size_t rows, std::size_t cols, std::vector<SparseEntry> entries) {
+        check_dimensions(rows, cols);
+        for (const SparseEntry& e : entries) {
+            if (e.row >= rows || e.col >= cols) {
+                throw std::invalid_argument("Индекс элемента вне размеров разреженной матрицы.");
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const SparseEntry& l, const SparseEntry& r) {
+            return l.row != r.row ? l.row < r.row : l.col < r.col;
+        });
+
+        CsrMatrix A;
+        A.rows_ = rows;
+        A.cols_ = cols;
+        A.row_ptr_.assign(rows + 1, 0);
+        A.col_idx_.reserve(entries.size());
+        A.values_.reserve(entries.size());
+        for (std::size_t k = 0; k < entries.size(); ++k) {
+            const SparseEntry& e = entries[k];
+            if (k > 0 && e.row == entries[k - 1].row && e.col == entries[k - 1].col) {
+                A.values_.back() += e.value;
+                continue;
+            }
+            A.col_idx_.push_back(static_cast<SparseIndex>(e.col));
+            A.values_.push_back(e.value);
+            A.row_ptr_[e.row + 1] += 1;
+        }
+        for (std::size_t i = 0; i < rows; ++i) A.row_ptr_[i + 1] += A.row_ptr_[i];
+        return A;
+    }
+
+    // Из плотной матрицы: сохраняются элементы с |a_ij| > drop_tolerance
+    static CsrMatrix from_dense(const Matrix& dense, double drop_tolerance = 0.0) {
+        check_dimensions(dense.rows(), dense.cols());
+        CsrMatrix A;
+        A.rows_ = dense.rows();
+        A.cols_ = dense.cols();
+        A.row_ptr_.assign(A.rows_ + 1, 0);
+        for (std::size_t i = 0; i < A.rows_; ++i) {
+            const double* row = dense.row_data(i);
+            for (std::size_t j = 0; j < A.cols_; ++j) {
+                if (std::abs(row[j]) > drop_tolerance) {
+                    A.col_idx_.push_back(static_cast<SparseIndex>(j));
+                    A.values_.push_back(row[j]);
+                }
+            }
+            A.row_ptr_[i + 1] = A.values_.size();
+        }
+        return A;
+    }
+
+    // Из готовых массивов CSR (например, прочитанных из файла, см. binary_io.h); портрет проверяется
+    static CsrMatrix from_arrays(std::size_t rows, std::size_t cols, std::vector<std::size_t> row_ptr,
+                                 std::vector<SparseIndex> col_idx, std::vector<double> values) {
+        check_dimensions(rows, cols);
+        if (row_ptr.size() != rows + 1 || row_ptr.front() != 0 || row_ptr.back() != values.size() ||
+            col_idx.size() != values.size()) {
+            throw std::invalid_argument("Некорректные размеры массивов CSR.");
+        }
+        for (std::size_t i = 0; i < rows; ++i) {
+            if (row_ptr[i] > row_ptr[i + 1]) {
+                throw std::invalid_argument("Указатели строк CSR должны не убывать.");
+            }
+            for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                if (col_idx[k] >= cols || (k > row_ptr[i] && col_idx[k] <= col_idx[k - 1])) {
+                    throw std::invalid_argument("Столбцы строки CSR должны возрастать и не выходить за размер матрицы.");
+                }
+            }
+        }
+        CsrMatrix A;
+        A.rows_ = rows;
+        A.cols_ = cols;
+        A.row_ptr_ = std::move(row_ptr);
+        A.col_idx_ = std::move(col_idx);
+        A.values_ = std::move(values);
+        return A;
+    }
+
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t nonzeros() const { return values_.size(); }
+
+    const std::vector<std::size_t>& row_ptr() const { return row_ptr_; }
+    const std::vector<SparseIndex>& col_idx() const { return col_idx_; }
+    const std::vector<double>& values() const { return values_; }
+    std::vector<double>& values() { return values_; } // Портрет менять нельзя, значения - можно
+
+    // Элемент a_ij (0, если не хранится); двоичный поиск по строке
+    double at(std::size_t i, std::size_t j) const {
+        const SparseIndex* begin = col_idx_.data() + row_ptr_[i];
+        const SparseIndex* end = col_idx_.data() + row_ptr_[i + 1];
+        const SparseIndex* it = std::lower_bound(begin, end, static_cast<SparseIndex>(j));
+        return (it != end && *it == j) ? values_[static_cast<std::size_t>(it - col_idx_.data())] : 0.0;
+    }
+
+    // Позиции диагональных элементов в values (для квадратной матрицы); отсутствие диагонали - ошибка
+    std::vector<std::size_t> diagonal_positions() const {
+        if (rows_ != cols_) {
+            throw std::invalid_argument("Матрица должна быть квадратной.");
+        }
+        std::vector<std::size_t> positions(rows_);
+        for (std::size_t i = 0; i < rows_; ++i) {
+            const SparseIndex* begin = col_idx_.data() + row_ptr_[i];
+            const SparseIndex* end = col_idx_.data() + row_ptr_[i + 1];
+            const SparseIndex* it = std::lower_bound(begin, end, static_cast<SparseIndex>(i));
+            if (it == end || *it != i) {
+                throw std::runtime_error("Диагональный элемент отсутствует в разреженной матрице.");
+            }
+            positions[i] = static_cast<std::size_t>(it - col_idx_.data());
+        }
+        return positions;
+    }
+
+    // Транспонированная матрица в формате CSR (то же, что исходная в формате CSC)
+    CsrMatrix transpose() const {
+        CsrMatrix T;
+        T.rows_ = cols_;
+        T.cols_ = rows_;
+        T.row_ptr_.assign(cols_ + 1, 0);
+        T.col_idx_.resize(values_.size());
+        T.values_.resize(values_.size());
+        for (SparseIndex j : col_idx_) T.row_ptr_[j + 1] += 1;
+        for (std::size_t j = 0; j < cols_; ++j) T.row_ptr_[j + 1] += T.row_ptr_[j];
+        std::vector<std::size_t> next(T.row_ptr_.begin(), T.row_ptr_.end() - 1);
+        for (std::size_t i = 0; i < rows_; ++i) { // Строки идут по порядку - столбцы T остаются отсортированными
+            for (std::size_t k = row_ptr_[i]; k < row_ptr_[i + 1]; ++k) {
+                const std::size_t dst = next[col_idx_[k]]++;
+                T.col_idx_[dst] = static_cast<SparseIndex>(i);
+                T.values_[dst] = values_[k];
+            }
+        }
+        return T;
+    }
+
+private:
+    static void check_dimensions(std::size_t rows, std::size_t cols) {
+        if (cols > std::numeric_limits<SparseIndex>::max()) {
+            throw std::invalid_argument("Число столбцов разреженной матрицы превышает диапазон индексов.");
+        }
+        (void)rows;
+    }
+
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::vector<std::size_t> row_ptr_;
+    std::vector<SparseIndex> col_idx_;
+    std::vector<double> values_;
+};
+
+// Матрица в формате CSC (по столбцам) - хранится как CSR транспонированной матрицы.
+// Удобна, когда нужен доступ к столбцам (A^T x, построение по столбцам).
+struct CscMatrix {
+    CsrMatrix transposed;
+
+    explicit CscMatrix(const CsrMatrix& A) : transposed(A.transpose()) {}
+
+    std::size_t rows() const { return transposed.cols(); }
+    std::size_t cols() const { return transposed.rows(); }
+    std::size_t nonzeros() const { return transposed.nonzeros(); }
+    const std::vector<std::size_t>& col_ptr() const { return transposed.row_ptr(); }
+    const std::vector<SparseIndex>& row_idx() const { return transposed.col_idx(); }
+    const std::vector<double>& values() const { return transposed.values(); }
+
+    CsrMatrix to_csr() const { return transposed.transpose(); }
+};
+
+// Минимальное число строк в куске умножения на вектор: кусок содержит около SPMV_GRAIN_NNZ элементов
+inline std::size_t spmv_grain(const CsrMatrix& A) {
+    const std::size_t per_row = std::max<std::size_t>(1, A.nonzeros() / std::max<std::size_t>(A.rows(), 1));
+    return std::max<std::size_t>(1, SPMV_GRAIN_NNZ / per_row);
+}
+
+// y = A x; строки распределяются по потокам пула (pool == nullptr - последовательно)
+inline void spmv(const CsrMatrix& A, const double* x, double* y, ThreadPool* pool = &default_thread_pool()) {
+    const std::size_t* row_ptr = A.row_ptr().data();
+    const SparseIndex* col_idx = A.col_idx().data();
+    const double* values = A.values().data();
+    auto rows = [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            double sum = 0.0;
+            for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                sum += values[k] * x[col_idx[k]];
+            }
+            y[i] = sum;
+        }
+    };
+    if (pool) pool->parallel_for(0, A.rows(), spmv_grain(A), rows);
+    else rows(0, A.rows());
+}
+
+inline std::vector<double> spmv(const CsrMatrix& A, const std::vector<double>& x,
+                                ThreadPool* pool = &default_thread_pool()) {
+    if (x.size() != A.cols()) {
+        throw std::invalid_argument("Размер вектора не совпадает с числом столбцов разреженной матрицы.");
+    }
+    std::vector<double> y(A.rows());
+    spmv(A, x.data(), y.data(), pool);
+    return y;
+}
+
+// --- Итерационные методы ---
+
+// Параметры итерационных методов. Остановка: ||b - A x||_inf <= epsilon * ||b||_inf.
+struct IterativeControl {
+    double epsilon = 1e-10;
+    int max_iterations = 10000;
+    ThreadPool* pool = &default_thread_pool(); // nullptr - последовательно
+};
+
+struct IterativeResult {
+    int iterations = 0;
+    double residual_norm = 0.0;  // ||b - A x||_inf после последней итерации
+    long long spmv_count = 0;    // Число умножений матрицы на вектор
+    bool converged = false;
+};
+
+namespace sparse_detail {
+
+inline void check_system(const CsrMatrix& A, const std::vector<double>& b, const std::vector<double>& x) {
+    if (A.rows() != A.cols() || b.size() != A.rows() || x.size() != A.rows()) {
+        throw std::invalid_argument("Некорректные размеры разреженной системы.");
+    }
+}
+
+// body(first, last) по кускам [0, n)
+template <typename Body>
+void for_range(std::size_t n, ThreadPool* pool, Body&& body) {
+    if (pool) pool->parallel_for(0, n, SPARSE_VECTOR_GRAIN, body);
+    else body(std::size_t(0), n);
+}
+
+inline double dot(const std::vector<double>& u, const std::vector<double>& v, ThreadPool* pool) {
+    return chunked_sum(0, u.size(), SPARSE_VECTOR_GRAIN, pool,
+                       [&](std::size_t first, std::size_t last, CompensatedSum& partial) {
+                           for (std::size_t i = first; i < last; ++i) partial.add(u[i] * v[i]);
+                       }).value();
+}
+
+// r = b - A x
+inline void residual(const CsrMatrix& A, const std::vector<double>& x, const std::vector<double>& b,
+                     std::vector<double>& r, ThreadPool* pool) {
+    spmv(A, x.data(), r.data(), pool);
+    for_range(r.size(), pool, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) r[i] = b[i] - r[i];
+    });
+}
+
+// Порог остановки; для b = 0 - абсолютный
+inline double threshold(const std::vector<double>& b, double epsilon) {
+    const double norm_b = vector_norm_inf(b);
+    return epsilon * (norm_b > 0.0 ? norm_b : 1.0);
+}
+
+} // namespace sparse_detail
+
+// Предобусловливатель Якоби: z = D^{-1} r
+class JacobiPreconditioner {
+public:
+    explicit JacobiPreconditioner(const CsrMatrix& A) : inverse_diagonal_(A.rows()) {
+        const std::vector<std::size_t> diagonal = A.diagonal_positions();
+        for (std::size_t i = 0; i < A.rows(); ++i) {
+            const double d = A.values()[diagonal[i]];
+            if (d == 0.0) throw std::runtime_error("Нулевой диагональный элемент (предобусловливатель Якоби).");
+            inverse_diagonal_[i] = 1.0 / d;
+        }
+    }
+
+    void apply(const std::vector<double>& r, std::vector<double>& z, ThreadPool* pool) const {
+        sparse_detail::for_range(r.size(), pool, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) z[i] = inverse_diagonal_[i] * r[i];
+        });
+    }
+
+private:
+    std::vector<double> inverse_diagonal_;
+};
+
+// Неполное LU-разложение ILU(0): L и U на портрете A (без заполнения), z = U^{-1} L^{-1} r.
+// Прямой и обратный ход последовательны.
+class Ilu0Preconditioner {
+public:
+    explicit Ilu0Preconditioner(const CsrMatrix& A) : lu_(A), diagonal_(A.diagonal_positions()) {
+        const std::size_t n = lu_.rows();
+        const std::vector<std::size_t>& row_ptr = lu_.row_ptr();
+        const std::vector<SparseIndex>& col_idx = lu_.col_idx();
+        std::vector<double>& values = lu_.values();
+        std::vector<std::size_t> position(n, NONE); // Позиция столбца j в текущей строке i
+
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) position[col_idx[k]] = k;
+            // a_ij -= l_ik * u_kj для k < i по портрету строки i
+            for (std::size_t kk = row_ptr[i]; kk < row_ptr[i + 1] && col_idx[kk] < i; ++kk) {
+                const std::size_t k = col_idx[kk];
+                const double pivot = values[diagonal_[k]];
+                if (pivot == 0.0) throw std::runtime_error("Нулевой ведущий элемент (ILU(0)).");
+                const double l_ik = values[kk] / pivot;
+                values[kk] = l_ik;
+                for (std::size_t kj = diagonal_[k] + 1; kj < row_ptr[k + 1]; ++kj) {
+                    const std::size_t p = position[col_idx[kj]];
+                    if (p != NONE) values[p] -= l_ik * values[kj];
+                }
+            }
+            for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) position[col_idx[k]] = NONE;
+            if (values[diagonal_[i]] == 0.0) throw std::runtime_error("Нулевой ведущий элемент (ILU(0)).");
+        }
+    }
+
+    void apply(const std::vector<double>& r, std::vector<double>& z, ThreadPool*) const {
+        const std::size_t n = lu_.rows();
+        const std::size_t* row_ptr = lu_.row_ptr().data();
+        const SparseIndex* col_idx = lu_.col_idx().data();
+        const double* values = lu_.values().data();
+        for (std::size_t i = 0; i < n; ++i) { // L y = r (единичная диагональ)
+            double sum = r[i];
+            for (std::size_t k = row_ptr[i]; k < diagonal_[i]; ++k) sum -= values[k] * z[col_idx[k]];
+            z[i] = sum;
+        }
+        for (std::size_t i = n; i-- > 0;) { // U z = y
+            double sum = z[i];
+            for (std::size_t k = diagonal_[i] + 1; k < row_ptr[i + 1]; ++k) sum -= values[k] * z[col_idx[k]];
+            z[i] = sum / values[diagonal_[i]];
+        }
+    }
+
+private:
+    static constexpr std::size_t NONE = std::numeric_limits<std::size_t>::max();
+
+    CsrMatrix lu_;
+    std::vector<std::size_t> diagonal_;
+};
+
+// Без предобусловливания: z = r
+struct IdentityPreconditioner {
+    void apply(const std::vector<double>& r, std::vector<double>& z, ThreadPool*) const { z = r; }
+};
+
+/**
+ * @brief Метод Якоби: x_i^{k+1} = (b_i - sum_{j != i} a_ij x_j^k) / a_ii.
+ *
+ * @details Сходится для матриц с диагональным преобладанием. Все строки вычисляются независимо
+ * (параллельно); невязка считается на каждой итерации тем же умножением на вектор.
+ *
+ * @param x Начальное приближение; на выходе - решение.
+ */
+inline IterativeResult solve_jacobi(const CsrMatrix& A, const std::vector<double>& b, std::vector<double>& x,
+                                    const IterativeControl& control = IterativeControl()) {
+    using namespace sparse_detail;
+    check_system(A, b, x);
+    const std::size_t n = A.rows();
+    const std::vector<std::size_t> diagonal = A.diagonal_positions();
+    const double* values = A.values().data();
+    const double stop = threshold(b, control.epsilon);
+    std::vector<double> r(n);
+    IterativeResult result;
+
+    residual(A, x, b, r, control.pool);
+    result.spmv_count = 1;
+    result.residual_norm = vector_norm_inf(r);
+    while (result.residual_norm > stop && result.iterations < control.max_iterations) {
+        // x^{k+1} = x^k + D^{-1} (b - A x^k)
+        for_range(n, control.pool, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) x[i] += r[i] / values[diagonal[i]];
+        });
+        residual(A, x, b, r, control.pool);
+        ++result.spmv_count;
+        ++result.iterations;
+        result.residual_norm = vector_norm_inf(r);
+        trace("jacobi", TraceEvent::Iteration, result.iterations, 0.0, result.residual_norm, 0.0, result.spmv_count);
+    }
+    result.converged = result.residual_norm <= stop;
+    return result;
+}
+
+/**
+ * @brief Метод Гаусса-Зейделя: как Якоби, но новые x_j (j < i) используются сразу.
+ *
+ * @details Обычно сходится примерно вдвое быстрее Якоби; проход по строкам последователен.
+ */
+inline IterativeResult solve_gauss_seidel(const CsrMatrix& A, const std::vector<double>& b, std::vector<double>& x,
+                                          const IterativeControl& control = IterativeControl()) {
+    using namespace sparse_detail;
+    check_system(A, b, x);
+    const std::size_t n = A.rows();
+    const std::vector<std::size_t> diagonal = A.diagonal_positions();
+    const std::size_t* row_ptr = A.row_ptr().data();
+    const SparseIndex* col_idx = A.col_idx().data();
+    const double* values = A.values().data();
+    const double stop = threshold(b, control.epsilon);
+    std::vector<double> r(n);
+    IterativeResult result;
+
+    residual(A, x, b, r, control.pool);
+    result.spmv_count = 1;
+    result.residual_norm = vector_norm_inf(r);
+    while (result.residual_norm > stop && result.iterations < control.max_iterations) {
+        for (std::size_t i = 0; i < n; ++i) {
+            double sum = b[i];
+            for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                if (k != diagonal[i]) sum -= values[k] * x[col_idx[k]];
+            }
+            x[i] = sum / values[diagonal[i]];
+        }
+        residual(A, x, b, r, control.pool);
+        ++result.spmv_count;
+        ++result.iterations;
+        result.residual_norm = vector_norm_inf(r);
+        trace("gauss-seidel", TraceEvent::Iteration, result.iterations, 0.0, result.residual_norm, 0.0,
+              result.spmv_count);
+    }
+    result.converged = result.residual_norm <= stop;
+    return result;
+}
+
+/**
+ * @brief Метод сопряженных градиентов с предобусловливанием (для симметричных положительно
+ * определенных матриц).
+ *
+ * @details На итерации одно умножение на вектор, одно применение предобусловливателя M
+ * и два скалярных произведения. В точной арифметике сходится не более чем за n итераций,
+ * на практике - за O(sqrt(cond(M^{-1} A))).
+ *
+ * @param preconditioner JacobiPreconditioner, Ilu0Preconditioner или IdentityPreconditioner.
+ */
+template <typename Preconditioner = IdentityPreconditioner>
+IterativeResult solve_cg(const CsrMatrix& A, const std::vector<double>& b, std::vector<double>& x,
+                         const Preconditioner& preconditioner = Preconditioner(),
+                         const IterativeControl& control = IterativeControl()) {
+    using namespace sparse_detail;
+    check_system(A, b, x);
+    const std::size_t n = A.rows();
+    ThreadPool* pool = control.pool;
+    const double stop = threshold(b, control.epsilon);
+    std::vector<double> r(n), z(n), p(n), q(n);
+    IterativeResult result;
+
+    residual(A, x, b, r, pool);
+    result.spmv_count = 1;
+    result.residual_norm = vector_norm_inf(r);
+    preconditioner.apply(r, z, pool);
+    p = z;
+    double rz = dot(r, z, pool);
+    while (result.residual_norm > stop && result.iterations < control.max_iterations) {
+        spmv(A, p.data(), q.data(), pool);
+        ++result.spmv_count;
+        const double pq = dot(p, q, pool);
+        if (pq == 0.0) break; // Вырождение (матрица не положительно определена)
+        const double alpha = rz / pq;
+        for_range(n, pool, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+            }
+        });
+        ++result.iterations;
+        result.residual_norm = vector_norm_inf(r);
+        trace("cg", TraceEvent::Iteration, result.iterations, 0.0, result.residual_norm, alpha, result.spmv_count);
+        if (result.residual_norm <= stop) break;
+
+        preconditioner.apply(r, z, pool);
+        const double rz_next = dot(r, z, pool);
+        const double beta = rz_next / rz;
+        rz = rz_next;
+        for_range(n, pool, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) p[i] = z[i] + beta * p[i];
+        });
+    }
+    // Итоговая невязка пересчитывается явно (рекуррентная может отличаться из-за округлений)
+    residual(A, x, b, r, pool);
+    ++result.spmv_count;
+    result.residual_norm = vector_norm_inf(r);
+    result.converged = result.residual_norm <= stop;
+    return result;
+}
+
+/**
+ * @brief Стабилизированный метод бисопряженных градиентов BiCGSTAB с правым предобусловливанием
+ * (для несимметричных матриц).
+ *
+ * @details На итерации два умножения на вектор и два применения предобусловливателя.
+ * Остановка по рекуррентной невязке, итоговая невязка пересчитывается явно.
+ */
+template <typename Preconditioner = IdentityPreconditioner>
+IterativeResult solve_bicgstab(const CsrMatrix& A, const std::vector<double>& b, std::vector<double>& x,
+                               const Preconditioner& preconditioner = Preconditioner(),
+                               const IterativeControl& control = IterativeControl()) {
+    using namespace sparse_detail;
+    check_system(A, b, x);
+    const std::size_t n = A.rows();
+    ThreadPool* pool = control.pool;
+    const double stop = threshold(b, control.epsilon);
+    std::vector<double> r(n), r_hat(n), p(n, 0.0), v(n, 0.0), s(n), t(n), p_hat(n), s_hat(n);
+    IterativeResult result;
+
+    residual(A, x, b, r, pool);
+    result.spmv_count = 1;
+    result.residual_norm = vector_norm_inf(r);
+    r_hat = r;
+    double rho = 1.0, alpha = 1.0, omega = 1.0;
+    while (result.residual_norm > stop && result.iterations < control.max_iterations) {
+        const double rho_next = dot(r_hat, r, pool);
+        if (rho_next == 0.0 || omega == 0.0) break; // Срыв метода
+        const double beta = (rho_next / rho) * (alpha / omega);
+        rho = rho_next;
+        for_range(n, pool, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+        });
+        preconditioner.apply(p, p_hat, pool);
+        spmv(A, p_hat.data(), v.data(), pool);
+        const double r_hat_v = dot(r_hat, v, pool);
+        if (r_hat_v == 0.0) break;
+        alpha = rho / r_hat_v;
+        for_range(n, pool, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) s[i] = r[i] - alpha * v[i];
+        });
+        ++result.iterations;
+        result.spmv_count += 1;
+        if (vector_norm_inf(s) <= stop) {
+            for_range(n, pool, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) x[i] += alpha * p_hat[i];
+            });
+            break;
+        }
+
+        preconditioner.apply(s, s_hat, pool);
+        spmv(A, s_hat.data(), t.data(), pool);
+        result.spmv_count += 1;
+        const double tt = dot(t, t, pool);
+        omega = tt > 0.0 ? dot(t, s, pool) / tt : 0.0;
+        for_range(n, pool, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                x[i] += alpha * p_hat[i] + omega * s_hat[i];
+                r[i] = s[i] - omega * t[i];
+            }
+        });
+        result.residual_norm = vector_norm_inf(r);
+        trace("bicgstab", TraceEvent::Iteration, result.iterations, 0.0, result.residual_norm, omega,
+              result.spmv_count);
+    }
+    residual(A, x, b, r, pool);
+    ++result.spmv_count;
+    result.residual_norm = vector_norm_inf(r);
+    result.converged = result.residual_norm <= stop;
+    return result;
+}
+
+#endif //COMP_MATH_SPARSE_H
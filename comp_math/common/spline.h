@@ -0,0 +1,166 @@
+#ifndef COMP_MATH_SPLINE_H
+#define COMP_MATH_SPLINE_H
+
+#include <cstddef>
+#include <cmath>        // Для std::abs
+#include <algorithm>    // Для std::min, std::max
+#include <vector>
+#include <span>
+#include <stdexcept>    // Для std::runtime_error, std::invalid_argument
+#include <limits>       // Для std::numeric_limits
+
+#include "tridiagonal.h" // Прогонка для вторых производных
+#include "dispatch.h"    // Варианты цикла под набор команд процессора
+
+// Естественный кубический сплайн на равномерной сетке: построение по значениям в узлах
+// (одна прогонка для вторых производных M_i) и вычисление значений по коэффициентам интервалов.
+// Рабочая память построения (SplineWorkspace) переиспользуется между перестроениями.
+
+// Структура для хранения данных сплайна.
+// Сетка обязана быть равномерной: x[i] = x[0] + i * h. Это проверяется при вычислении коэффициентов,
+// а evaluate_spline находит интервал только по x[0] и h, поэтому после построения x и h менять нельзя
+// (для новых узлов сплайн строится заново).
+struct SplineData {
+    std::vector<double> x; // Узлы xi
+    std::vector<double> y; // Значения yi = f(xi)
+    std::vector<double> M; // Вторые производные Mi в узлах
+    double h;              // Шаг равномерной сетки: номер интервала вычисляется по h
+    // Коэффициенты кубического многочлена на каждом интервале, по 4 на интервал:
+    // S(x) = ((c3 t + c2) t + c1) t + c0, t = x - xi
+    std::vector<double> coeffs;
+};
+
+// Допустимое относительное отклонение шага сетки от spline.h; к нему добавляется ошибка округления
+// узлов x[i] = a + i * h, пропорциональная |x[i]|
+constexpr double SPLINE_UNIFORM_TOLERANCE = 1e-9;
+
+// Вычисление коэффициентов многочлена на каждом интервале по y и M.
+// Заодно проверяется, что сетка равномерна с шагом spline.h (иначе поиск интервала дал бы неверный номер).
+inline void compute_spline_coefficients(SplineData& spline) {
+    const std::size_t intervals = spline.x.size() - 1;
+    spline.coeffs.resize(4 * intervals);
+    for (std::size_t i = 0; i < intervals; ++i) {
+        const double h = spline.x[i + 1] - spline.x[i];
+        if (std::abs(h) < 1e-9) {
+            throw std::runtime_error("Нулевая ширина интервала сплайна.");
+        }
+        const double rounding = 8.0 * std::numeric_limits<double>::epsilon()
+                                * std::max(std::abs(spline.x[i]), std::abs(spline.x[i + 1]));
+        if (std::abs(h - spline.h) > SPLINE_UNIFORM_TOLERANCE * std::abs(spline.h) + rounding) {
+            throw std::invalid_argument("Сетка сплайна неравномерна или не согласована с шагом h.");
+        }
+        const double Mi = spline.M[i];
+        const double Mi1 = spline.M[i + 1];
+        double* c = spline.coeffs.data() + 4 * i;
+        c[0] = spline.y[i];
+        c[1] = (spline.y[i + 1] - spline.y[i]) / h - h * (2.0 * Mi + Mi1) / 6.0;
+        c[2] = 0.5 * Mi;
+        c[3] = (Mi1 - Mi) / (6.0 * h);
+    }
+}
+
+// Рабочая память для построения сплайна. Переиспользуется между перестроениями:
+// при том же или меньшем числе узлов память не выделяется.
+struct SplineWorkspace {
+    std::vector<double> diag;     // Главная диагональ системы для M1..M_{n-2} (после деления на h: 4)
+    std::vector<double> offdiag;  // Под- и наддиагональ (после деления на h: 1)
+    TridiagonalWorkspace<double> tridiagonal; // Прогоночные коэффициенты
+};
+
+// Вторые производные M естественного сплайна по spline.y и spline.h.
+// Система h M_{i-1} + 4h M_i + h M_{i+1} = 6/h (y_{i+1} - 2y_i + y_{i-1}) делится на h,
+// правая часть собирается сразу в M[1..n-2], и прогонка решает ее на месте.
+inline void solve_spline_moments(SplineData& spline, SplineWorkspace& workspace) {
+    const std::size_t n = spline.y.size();
+    const std::size_t system_size = n - 2; // Решаем для M1..M_{n-2}
+    spline.M.resize(n);
+
+    // Коэффициенты системы постоянны, поэтому заполняются только при увеличении размера
+    if (workspace.diag.size() < system_size) {
+        workspace.diag.assign(system_size, 4.0);
+        workspace.offdiag.assign(system_size, 1.0);
+    }
+
+    const double scale = 6.0 / (spline.h * spline.h);
+    double* M = spline.M.data();
+    const double* y = spline.y.data();
+    for (std::size_t i = 1; i + 1 < n; ++i) {
+        M[i] = scale * (y[i + 1] - 2.0 * y[i] + y[i - 1]);
+    }
+    solve_tridiagonal_system(system_size, workspace.offdiag.data(), workspace.diag.data(),
+                             workspace.offdiag.data(), M + 1, M + 1, workspace.tridiagonal);
+
+    // Естественные граничные условия
+    M[0] = 0.0;
+    M[n - 1] = 0.0;
+
+    compute_spline_coefficients(spline);
+}
+
+// Построение естественного кубического сплайна по значениям y на равномерной сетке [a, b].
+// Векторы spline и workspace переиспользуются, поэтому перестроение для нового кадра данных
+// того же размера не выделяет память.
+inline void build_natural_cubic_spline(SplineData& spline, double a, double b,
+                                const std::vector<double>& y, SplineWorkspace& workspace) {
+    const std::size_t n = y.size();
+    if (n < 3) {
+        throw std::invalid_argument("Для кубического сплайна нужно минимум 3 точки.");
+    }
+
+    spline.h = (b - a) / (n - 1);
+    spline.x.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        spline.x[i] = a + i * spline.h;
+    }
+    spline.y.assign(y.begin(), y.end());
+    solve_spline_moments(spline, workspace);
+}
+
+// Номер интервала [xi, x_{i+1}] для точки xp; точки вне сетки относятся к крайним интервалам.
+// Сетка равномерная (solve_spline_moments рассчитан на постоянный шаг), номер вычисляется за O(1).
+// NaN относится к первому интервалу: std::max(0.0, NaN) дает 0.0, поэтому приведение к size_t определено.
+inline std::size_t spline_interval_uniform(const SplineData& spline, double xp, double inv_h) {
+    const double last = static_cast<double>(spline.x.size() - 2);
+    const double t = std::min(last, std::max(0.0, (xp - spline.x[0]) * inv_h));
+    return static_cast<std::size_t>(t);
+}
+
+// Значение многочлена интервала i в точке xp (схема Горнера)
+inline double spline_value(const SplineData& spline, std::size_t i, double xp) {
+    const double* c = spline.coeffs.data() + 4 * i;
+    const double t = xp - spline.x[i];
+    return ((c[3] * t + c[2]) * t + c[1]) * t + c[0];
+}
+
+// Оценка значения сплайна S(xp) в точке xp
+inline double evaluate_spline(const SplineData& spline, double xp) {
+    std::size_t n = spline.x.size();
+    if (n < 2 || spline.coeffs.size() != 4 * (n - 1)) {
+        throw std::runtime_error("Сплайн не построен или содержит слишком мало точек.");
+    }
+    return spline_value(spline, spline_interval_uniform(spline, xp, 1.0 / spline.h), xp);
+}
+
+// Оценка значений сплайна сразу во многих точках: out[k] = S(xs[k]).
+// Как и для одной точки, интервал находится за O(1) по x[0] и h - сетка должна быть равномерной (см. SplineData).
+// Итерации независимы, поэтому цикл векторизуется по точкам
+// (в вариантах под AVX-512/AVX2, см. dispatch.h). xs и out могут совпадать (вычисление на месте).
+COMP_MATH_TARGET_CLONES
+inline void evaluate_spline(const SplineData& spline, std::span<const double> xs, std::span<double> out) {
+    std::size_t n = spline.x.size();
+    if (n < 2 || spline.coeffs.size() != 4 * (n - 1)) {
+        throw std::runtime_error("Сплайн не построен или содержит слишком мало точек.");
+    }
+    if (xs.size() != out.size()) {
+        throw std::invalid_argument("Размеры массивов точек и значений сплайна не совпадают.");
+    }
+
+    const double* points = xs.data();
+    double* values = out.data();
+    const double inv_h = 1.0 / spline.h;
+    for (std::size_t k = 0; k < xs.size(); ++k) {
+        values[k] = spline_value(spline, spline_interval_uniform(spline, points[k], inv_h), points[k]);
+    }
+}
+
+#endif //COMP_MATH_SPLINE_H
@@ -0,0 +1,61 @@
+#ifndef COMP_MATH_SUMMATION_H
+#define COMP_MATH_SUMMATION_H
+
+#include <cstddef>
+#include <cmath>        // Для std::abs
+#include <array>
+
+#include "thread_pool.h"
+
+// Компенсированное суммирование Ноймайера (улучшенный алгоритм Кэхэна):
+// ошибка округления каждого сложения накапливается отдельно и добавляется в конце,
+// поэтому погрешность суммы почти не зависит от числа слагаемых.
+struct CompensatedSum {
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    void add(double x) {
+        const double t = sum + x;
+        compensation += (std::abs(sum) >= std::abs(x)) ? (sum - t) + x : (x - t) + sum;
+        sum = t;
+    }
+
+    // Объединение с частичной суммой другого куска
+    void add(const CompensatedSum& other) {
+        add(other.sum);
+        compensation += other.compensation;
+    }
+
+    double value() const { return sum + compensation; }
+};
+
+// Минимальное число слагаемых в одном куске параллельной суммы
+constexpr std::size_t SUMMATION_GRAIN = 4096;
+
+// Сумма по диапазону [first, last): body(begin, end, partial) добавляет слагаемые куска в partial.
+// Разбиение на куски такое же, как у ThreadPool::parallel_for_chunks, а частичные суммы
+// объединяются по порядку кусков, поэтому результат одинаков без пула (pool == nullptr)
+// и при любом числе потоков.
+template <typename Body>
+CompensatedSum chunked_sum(std::size_t first, std::size_t last, std::size_t grain, ThreadPool* pool, Body&& body) {
+    const std::size_t chunks = ThreadPool::chunk_count(first, last, grain);
+    std::array<CompensatedSum, THREAD_POOL_MAX_CHUNKS> partial{};
+    if (pool) {
+        pool->parallel_for_chunks(first, last, grain, [&](std::size_t c, std::size_t begin, std::size_t end) {
+            body(begin, end, partial[c]);
+        });
+    } else {
+        for (std::size_t c = 0; c < chunks; ++c) {
+            body(ThreadPool::chunk_begin(first, last, chunks, c),
+                 ThreadPool::chunk_begin(first, last, chunks, c + 1), partial[c]);
+        }
+    }
+
+    CompensatedSum total;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        total.add(partial[c]);
+    }
+    return total;
+}
+
+#endif //COMP_MATH_SUMMATION_H
@@ -0,0 +1,37 @@
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "spline.h"
+
+// Точка NaN не должна давать номер интервала вне сетки, а значение сплайна в ней - NaN
+// (в том числе при вычислении на месте, когда xs и out совпадают).
+int main() {
+    std::vector<double> y(16);
+    for (std::size_t i = 0; i < y.size(); ++i) y[i] = std::sin(0.2 * i);
+    SplineData spline;
+    SplineWorkspace workspace;
+    build_natural_cubic_spline(spline, 0.0, 3.0, y, workspace);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    int failures = 0;
+    const std::size_t interval = spline_interval_uniform(spline, nan, 1.0 / spline.h);
+    if (interval > spline.x.size() - 2) {
+        std::cerr << "spline_interval_uniform(NaN) = " << interval << " вне сетки" << std::endl;
+        ++failures;
+    }
+    if (!std::isnan(evaluate_spline(spline, nan))) {
+        std::cerr << "evaluate_spline(NaN) не NaN" << std::endl;
+        ++failures;
+    }
+
+    std::vector<double> points = {nan, 0.5, 2.5};
+    const double expected = evaluate_spline(spline, 2.5);
+    evaluate_spline(spline, points, points);
+    if (!std::isnan(points[0]) || points[2] != expected) {
+        std::cerr << "Пакетное вычисление на месте дало неверные значения" << std::endl;
+        ++failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+#ifndef COMP_MATH_THREAD_POOL_H
+#define COMP_MATH_THREAD_POOL_H
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>    // Для std::exception_ptr
+#include <memory>       // Для std::unique_ptr
+#include <type_traits>  // Для std::remove_reference
+#include <algorithm>    // Для std::min, std::max
+
+// Наибольшее число кусков в одном параллельном цикле
+constexpr std::size_t THREAD_POOL_MAX_CHUNKS = 256;
+
+// Число потоков по умолчанию: число аппаратных потоков (не меньше 1)
+inline std::size_t default_thread_count() {
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+// Пул потоков для параллельных циклов с разбиением диапазона на куски.
+// Вызывающий поток тоже выполняет куски, поэтому пул размера 1 работает без дополнительных потоков.
+// Разбиение на куски зависит только от диапазона и grain, а не от числа потоков,
+// поэтому частичные результаты по кускам можно объединять детерминированно.
+// Вложенный вызов (из тела цикла) или одновременный вызов из другого потока выполняется последовательно.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t num_threads = default_thread_count()) {
+        const std::size_t workers = std::max<std::size_t>(num_threads, 1) - 1;
+        workers_.reserve(workers);
+        for (std::size_t i = 0; i < workers; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Общее число потоков, выполняющих работу (включая вызывающий)
+    std::size_t size() const { return workers_.size() + 1; }
+
+    // Число кусков, на которые будет разбит диапазон [first, last) при заданном минимальном размере куска
+    static std::size_t chunk_count(std::size_t first, std::size_t last, std::size_t grain) {
+        if (first >= last) return 0;
+        const std::size_t count = last - first;
+        const std::size_t by_grain = (count + std::max<std::size_t>(grain, 1) - 1) / std::max<std::size_t>(grain, 1);
+        return std::max<std::size_t>(1, std::min(by_grain, THREAD_POOL_MAX_CHUNKS));
+    }
+
+    // Начало куска c из chunks (конец куска - начало следующего)
+    static std::size_t chunk_begin(std::size_t first, std::size_t last, std::size_t chunks, std::size_t c) {
+        return first + (last - first) * c / chunks;
+    }
+
+    // body(chunk, begin, end) для каждого куска [begin, end) диапазона [first, last).
+    // Возвращается после завершения всех кусков; первое исключение из тела пробрасывается вызывающему.
+    template <typename Body>
+    void parallel_for_chunks(std::size_t first, std::size_t last, std::size_t grain, Body&& body) {
+        const std::size_t chunks = chunk_count(first, last, grain);
+        if (chunks == 0) return;
+
+        bool expected = false;
+        if (chunks == 1 || workers_.empty() || !busy_.compare_exchange_strong(expected, true)) {
+            for (std::size_t c = 0; c < chunks; ++c) {
+                body(c, chunk_begin(first, last, chunks, c), chunk_begin(first, last, chunks, c + 1));
+            }
+            return;
+        }
+
+        Job job;
+        job.call = &invoke_body<typename std::remove_reference<Body>::type>;
+        job.body = &body;
+        job.first = first;
+        job.last = last;
+        job.chunks = chunks;
+
+        struct BusyGuard {
+            std::atomic<bool>& flag;
+            ~BusyGuard() { flag.store(false); }
+        } guard{busy_};
+        run(job);
+    }
+
+    // body(begin, end) для каждого куска диапазона [first, last)
+    template <typename Body>
+    void parallel_for(std::size_t first, std::size_t last, std::size_t grain, Body&& body) {
+        parallel_for_chunks(first, last, grain, [&body](std::size_t, std::size_t begin, std::size_t end) {
+            body(begin, end);
+        });
+    }
+
+private:
+    struct Job {
+        void (*call)(void* body, std::size_t chunk, std::size_t begin, std::size_t end) = nullptr;
+        void* body = nullptr;
+        std::size_t first = 0;
+        std::size_t last = 0;
+        std::size_t chunks = 0;
+    };
+
+    template <typename Body>
+    static void invoke_body(void* body, std::size_t chunk, std::size_t begin, std::size_t end) {
+        (*static_cast<Body*>(body))(chunk, begin, end);
+    }
+
+    void run(const Job& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = job;
+            next_chunk_.store(0);
+            remaining_ = job.chunks;
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_cv_.notify_all();
+
+        execute(job);
+
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Ждем не только все куски, но и выхода всех потоков из задания,
+            // чтобы ни один не взял кусок следующего задания со старым телом
+            done_cv_.wait(lock, [this] { return remaining_ == 0 && active_workers_ == 0; });
+            error = error_;
+            error_ = nullptr;
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void execute(const Job& job) {
+        for (;;) {
+            const std::size_t c = next_chunk_.fetch_add(1);
+            if (c >= job.chunks) break;
+            try {
+                job.call(job.body, c, chunk_begin(job.first, job.last, job.chunks, c),
+                         chunk_begin(job.first, job.last, job.chunks, c + 1));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--remaining_ == 0) done_cv_.notify_all();
+        }
+    }
+
+    void worker_loop() {
+        std::size_t seen_generation = 0;
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+                if (stop_) return;
+                seen_generation = generation_;
+                // Задание уже выполнено другими потоками - ждем следующего
+                if (remaining_ == 0) continue;
+                job = job_;
+                ++active_workers_;
+            }
+            execute(job);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--active_workers_ == 0) done_cv_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    Job job_;
+    std::atomic<std::size_t> next_chunk_{0};
+    std::size_t remaining_ = 0;
+    std::size_t active_workers_ = 0;
+    std::size_t generation_ = 0;
+    std::exception_ptr error_;
+    std::atomic<bool> busy_{false};
+    bool stop_ = false;
+};
+
+// Хранилище общего пула. Само хранилище - локальная static-переменная (инициализация потокобезопасна),
+// создание и замена пула идут под mutex, а готовый пул читается через атомарный указатель без блокировки.
+struct DefaultThreadPoolStorage {
+    std::mutex mutex;
+    std::unique_ptr<ThreadPool> pool;
+    std::atomic<ThreadPool*> current{nullptr};
+};
+
+inline DefaultThreadPoolStorage& default_thread_pool_storage() {
+    static DefaultThreadPoolStorage storage;
+    return storage;
+}
+
+// Общий пул потоков (создается при первом обращении; одновременные первые обращения создают один пул)
+inline ThreadPool& default_thread_pool() {
+    auto& storage = default_thread_pool_storage();
+    if (ThreadPool* pool = storage.current.load(std::memory_order_acquire)) return *pool;
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    if (!storage.pool) {
+        storage.pool = std::make_unique<ThreadPool>();
+        storage.current.store(storage.pool.get(), std::memory_order_release);
+    }
+    return *storage.pool;
+}
+
+// Изменение числа потоков общего пула; вызывать, пока пул не используется
+inline void set_default_thread_pool_size(std::size_t num_threads) {
+    auto& storage = default_thread_pool_storage();
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    storage.current.store(nullptr, std::memory_order_release);
+    storage.pool = std::make_unique<ThreadPool>(num_threads);
+    storage.current.store(storage.pool.get(), std::memory_order_release);
+}
+
+#endif //COMP_MATH_THREAD_POOL_H
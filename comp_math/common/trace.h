@@ -0,0 +1,151 @@
+#ifndef COMP_MATH_TRACE_H
+#define COMP_MATH_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <ostream>      // Для TraceBuffer::dump
+#include <iomanip>      // Для std::setw
+#include <algorithm>    // Для std::min
+
+// Трассировка итераций решателей без вывода в поток внутри циклов.
+// Решатели вызывают trace(...) на каждой итерации и при нештатных ситуациях, а записи
+// попадают в заранее выделенный кольцевой буфер TraceBuffer, если он подключен (TraceScope).
+// Без подключенного буфера trace(...) - одна проверка указателя; при сборке с COMP_MATH_TRACE=0
+// вызовы исчезают полностью. Содержимое буфера выводится после расчета (TraceBuffer::dump).
+
+#ifndef COMP_MATH_TRACE
+#define COMP_MATH_TRACE 1
+#endif
+
+enum class TraceEvent : std::uint8_t {
+    Iteration,      // Очередная итерация (корни, правило Рунге, ...)
+    StepAccepted,   // Шаг ОДУ принят
+    StepRejected,   // Шаг ОДУ отвергнут
+    StepTooSmall,   // Шаг стал меньше допустимого - расчет остановлен
+    MaxIterations,  // Исчерпано число итераций
+    NotConverged,   // Точность не достигнута
+    Mismatch        // Элемент, нарушивший допуск при сравнении
+};
+
+inline const char* trace_event_name(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::Iteration: return "iteration";
+        case TraceEvent::StepAccepted: return "accepted";
+        case TraceEvent::StepRejected: return "rejected";
+        case TraceEvent::StepTooSmall: return "step-too-small";
+        case TraceEvent::MaxIterations: return "max-iterations";
+        case TraceEvent::NotConverged: return "not-converged";
+        case TraceEvent::Mismatch: return "mismatch";
+    }
+    return "?";
+}
+
+// Одна запись трассы. Смысл полей зависит от источника: для ОДУ x - узел, residual - оценка
+// локальной погрешности, step - шаг h; для корней x - приближение, residual - |f(x)|;
+// для квадратур - см. quadrature.h.
+struct TraceRecord {
+    const char* source;      // Имя решателя (строковый литерал)
+    TraceEvent event;
+    long long iteration;
+    double x;
+    double residual;
+    double step;
+    long long evaluations;   // Число вычислений функции к моменту записи
+};
+
+// Кольцевой буфер записей: емкость - степень двойки, память выделяется один раз в конструкторе.
+// При переполнении старые записи перезаписываются (их число - dropped()).
+// Запись из нескольких потоков допустима (индекс выдается атомарно); читать буфер (for_each, dump)
+// можно только после завершения записи.
+class TraceBuffer {
+public:
+    explicit TraceBuffer(std::size_t capacity = 4096) {
+        std::size_t size = 1;
+        while (size < capacity) size <<= 1;
+        records_.resize(size);
+        mask_ = size - 1;
+    }
+
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    void record(const TraceRecord& r) {
+        const std::uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+        records_[index & mask_] = r;
+    }
+
+    std::size_t capacity() const { return records_.size(); }
+    std::uint64_t total() const { return head_.load(std::memory_order_acquire); }
+    std::size_t size() const { return static_cast<std::size_t>(std::min<std::uint64_t>(total(), capacity())); }
+    std::uint64_t dropped() const { return total() - size(); }
+    void clear() { head_.store(0, std::memory_order_release); }
+
+    // visit(const TraceRecord&) для сохранившихся записей от старых к новым
+    template <typename Visit>
+    void for_each(Visit&& visit) const {
+        const std::uint64_t end = total();
+        for (std::uint64_t i = end - size(); i < end; ++i) {
+            visit(records_[i & mask_]);
+        }
+    }
+
+    // Таблица записей (по одной на строку)
+    void dump(std::ostream& out) const {
+        if (dropped() > 0) out << "# dropped " << dropped() << " older records\n";
+        out << std::setw(24) << "source" << std::setw(16) << "event" << std::setw(10) << "iter"
+            << std::setw(16) << "x" << std::setw(16) << "residual" << std::setw(16) << "step"
+            << std::setw(12) << "evals" << "\n";
+        for_each([&out](const TraceRecord& r) {
+            out << std::setw(24) << r.source << std::setw(16) << trace_event_name(r.event) << std::setw(10)
+                << r.iteration << std::setw(16) << r.x << std::setw(16) << r.residual << std::setw(16) << r.step
+                << std::setw(12) << r.evaluations << "\n";
+        });
+    }
+
+private:
+    std::vector<TraceRecord> records_;
+    std::size_t mask_ = 0;
+    std::atomic<std::uint64_t> head_{0};
+};
+
+namespace trace_detail {
+inline std::atomic<TraceBuffer*> sink{nullptr};
+}
+
+// Текущий буфер трассы (nullptr - трассировка выключена)
+inline TraceBuffer* trace_sink() {
+#if COMP_MATH_TRACE
+    return trace_detail::sink.load(std::memory_order_relaxed);
+#else
+    return nullptr;
+#endif
+}
+
+// Подключение буфера на время жизни объекта; предыдущий буфер восстанавливается в деструкторе
+class TraceScope {
+public:
+    explicit TraceScope(TraceBuffer& buffer) : previous_(trace_detail::sink.exchange(&buffer)) {}
+    ~TraceScope() { trace_detail::sink.store(previous_); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceBuffer* previous_;
+};
+
+// Точка трассировки в решателе
+inline void trace(const char* source, TraceEvent event, long long iteration,
+                  double x, double residual, double step, long long evaluations) {
+#if COMP_MATH_TRACE
+    if (TraceBuffer* sink = trace_sink()) {
+        sink->record(TraceRecord{source, event, iteration, x, residual, step, evaluations});
+    }
+#else
+    (void)source; (void)event; (void)iteration; (void)x; (void)residual; (void)step; (void)evaluations;
+#endif
+}
+
+#endif //COMP_MATH_TRACE_H
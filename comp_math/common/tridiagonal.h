@@ -0,0 +1,278 @@
+#ifndef COMP_MATH_TRIDIAGONAL_H
+#define COMP_MATH_TRIDIAGONAL_H
+
+#include <cstddef>
+#include <cmath>        // Для std::abs
+#include <vector>
+#include <stdexcept>    // Для std::runtime_error, std::invalid_argument
+#include <algorithm>    // Для std::min, std::max
+
+#include "thread_pool.h"
+#include "dispatch.h"     // Варианты цикла под набор команд процессора
+
+// Подсказка компилятору, что итерации цикла независимы (для векторизации по системам)
+#if defined(__GNUC__) && !defined(__clang__)
+#define COMP_MATH_IVDEP _Pragma("GCC ivdep")
+#elif defined(__clang__)
+#define COMP_MATH_IVDEP _Pragma("clang loop vectorize(enable)")
+#else
+#define COMP_MATH_IVDEP
+#endif
+
+// Порог для знаменателя прогоночных коэффициентов
+constexpr double TRIDIAGONAL_EPSILON = 1e-9;
+
+// Минимальная длина блока в параллельной (блочной) прогонке
+constexpr std::size_t TRIDIAGONAL_PARTITION_BLOCK = 32768;
+
+// Способ решения одной трехдиагональной системы
+enum class TridiagonalEngine {
+    Thomas,      // Последовательная прогонка
+    Partitioned  // Разбиение на блоки с разделителями, блоки решаются параллельно
+};
+
+// Метод прогонки (алгоритм Томаса) сразу для batch независимых трехдиагональных систем
+//   a_i x_{i-1} + b_i x_i + c_i x_{i+1} = d_i,  i = 0..n-1.
+//
+// Данные хранятся в виде структуры массивов: элемент i системы s лежит по индексу i * batch + s,
+// поэтому внутренние циклы идут по системам подряд в памяти и векторизуются,
+// а рекуррентность остается только по i.
+//   sub   - поддиагональ a_1..a_{n-1}:   (n-1) * batch, sub[(i-1) * batch + s] = a_i
+//   diag  - главная диагональ b_0..b_{n-1}: n * batch
+//   super - наддиагональ c_0..c_{n-2}:   (n-1) * batch
+//   rhs   - правые части: n * batch
+//   x     - решение: n * batch (может совпадать с rhs)
+//   work  - рабочая память вызывающего: n * batch (прогоночные коэффициенты c'_i)
+// Память внутри не выделяется. Цикл по системам собирается в вариантах под AVX-512/AVX2 (dispatch.h).
+template <typename T>
+COMP_MATH_TARGET_CLONES
+void solve_tridiagonal_batch(std::size_t n, std::size_t batch,
+                             const T* sub, const T* diag, const T* super,
+                             const T* rhs, T* x, T* work,
+                             double epsilon = TRIDIAGONAL_EPSILON) {
+    if (n == 0 || batch == 0) {
+        throw std::invalid_argument("Некорректные размеры для метода прогонки.");
+    }
+
+    // Прямой ход, первая строка
+    int bad = 0;
+    COMP_MATH_IVDEP
+    for (std::size_t s = 0; s < batch; ++s) {
+        bad |= std::abs(diag[s]) < epsilon;
+    }
+    if (bad) {
+        throw std::runtime_error("Нулевой элемент b[0] в методе прогонки.");
+    }
+    if (n == 1) {
+        COMP_MATH_IVDEP
+        for (std::size_t s = 0; s < batch; ++s) {
+            x[s] = rhs[s] / diag[s];
+        }
+        return;
+    }
+    COMP_MATH_IVDEP
+    for (std::size_t s = 0; s < batch; ++s) {
+        const T inv = T(1) / diag[s];
+        work[s] = super[s] * inv;
+        x[s] = rhs[s] * inv;
+    }
+
+    // Прямой ход, строки 1..n-1: c'_i = c_i / (b_i - a_i c'_{i-1}), d'_i = (d_i - a_i d'_{i-1}) / (...)
+    for (std::size_t i = 1; i < n; ++i) {
+        const std::size_t cur = i * batch;
+        const std::size_t prev = cur - batch;
+        const T* __restrict a_i = sub + prev;
+        const T* __restrict b_i = diag + cur;
+        // Указатели на x и rhs без __restrict: x может совпадать с rhs (цикл векторизуется по COMP_MATH_IVDEP)
+        const T* d_i = rhs + cur;
+        const T* __restrict cp_prev = work + prev;
+        const T* x_prev = x + prev;
+        T* __restrict cp_i = work + cur;
+        T* x_i = x + cur;
+
+        if (i < n - 1) {
+            const T* __restrict c_i = super + cur;
+            COMP_MATH_IVDEP
+            for (std::size_t s = 0; s < batch; ++s) {
+                const T denominator = b_i[s] - a_i[s] * cp_prev[s];
+                bad |= std::abs(denominator) < epsilon;
+                const T inv = T(1) / denominator;
+                cp_i[s] = c_i[s] * inv;
+                x_i[s] = (d_i[s] - a_i[s] * x_prev[s]) * inv;
+            }
+        } else {
+            COMP_MATH_IVDEP
+            for (std::size_t s = 0; s < batch; ++s) {
+                const T denominator = b_i[s] - a_i[s] * cp_prev[s];
+                bad |= std::abs(denominator) < epsilon;
+                cp_i[s] = T(0);
+                x_i[s] = (d_i[s] - a_i[s] * x_prev[s]) / denominator;
+            }
+        }
+        if (bad) {
+            throw std::runtime_error("Нулевой знаменатель при вычислении прогоночных коэффициентов.");
+        }
+    }
+
+    // Обратный ход: x_i = d'_i - c'_i x_{i+1}
+    for (std::size_t i = n - 1; i-- > 0;) {
+        const T* __restrict cp_i = work + i * batch;
+        const T* x_next = x + (i + 1) * batch;
+        T* x_i = x + i * batch;
+        COMP_MATH_IVDEP
+        for (std::size_t s = 0; s < batch; ++s) {
+            x_i[s] -= cp_i[s] * x_next[s];
+        }
+    }
+}
+
+// Переиспользуемая рабочая память для решателей трехдиагональных систем:
+// буфер растет только при увеличении запрошенного размера, повторные вызовы не выделяют память
+template <typename T>
+class TridiagonalWorkspace {
+public:
+    T* reserve(std::size_t count) {
+        if (buffer_.size() < count) {
+            buffer_.resize(count);
+        }
+        return buffer_.data();
+    }
+
+    T* reserve(std::size_t n, std::size_t batch) { return reserve(n * batch); }
+
+private:
+    std::vector<T> buffer_;
+};
+
+// Прогонка внутреннего блока [lo, hi) с тремя правыми частями:
+//   y - обычная правая часть (записывается в x),
+//   v - влияние левого разделителя (правая часть alpha * e_first),
+//   w - влияние правого разделителя (правая часть gamma * e_last, записывается поверх cp).
+// Коэффициенты c'_i и столбец w используют один буфер: w_i считается из c'_i и w_{i+1}.
+template <typename T>
+void tridiagonal_partition_block(std::size_t lo, std::size_t hi,
+                                 const T* sub, const T* diag, const T* super, const T* rhs,
+                                 T alpha, T gamma, T* x, T* v, T* cp, double epsilon) {
+    T denominator = diag[lo];
+    if (std::abs(denominator) < epsilon) {
+        throw std::runtime_error("Нулевой знаменатель при вычислении прогоночных коэффициентов.");
+    }
+    cp[lo] = (lo + 1 < hi) ? super[lo] / denominator : T(0);
+    x[lo] = rhs[lo] / denominator;
+    v[lo] = alpha / denominator;
+    for (std::size_t i = lo + 1; i < hi; ++i) {
+        const T a_i = sub[i - 1];
+        denominator = diag[i] - a_i * cp[i - 1];
+        if (std::abs(denominator) < epsilon) {
+            throw std::runtime_error("Нулевой знаменатель при вычислении прогоночных коэффициентов.");
+        }
+        const T inv = T(1) / denominator;
+        cp[i] = (i + 1 < hi) ? super[i] * inv : T(0);
+        x[i] = (rhs[i] - a_i * x[i - 1]) * inv;
+        v[i] = -a_i * v[i - 1] * inv;
+    }
+
+    cp[hi - 1] = gamma / denominator;
+    for (std::size_t i = hi - 1; i-- > lo;) {
+        const T c_prime = cp[i];
+        x[i] -= c_prime * x[i + 1];
+        v[i] -= c_prime * v[i + 1];
+        cp[i] = -c_prime * cp[i + 1];
+    }
+}
+
+// Параллельная прогонка одной длинной системы (те же обозначения, что в solve_tridiagonal_batch).
+// Система делится на p блоков, последняя строка каждого блока (кроме последнего) - разделитель.
+// При известных значениях в разделителях внутренние части блоков независимы:
+//   x = y - x_left * v - x_right * w,
+// поэтому все блоки решаются параллельно, а значения в разделителях находятся из
+// трехдиагональной системы размера p - 1 (дополнение Шура), которая решается обычной прогонкой.
+// Число блоков зависит только от n и block_size, поэтому результат не зависит от числа потоков.
+// Короткие системы (меньше двух блоков) решаются последовательной прогонкой.
+// Рабочая память: 2n + 5p элементов; x может совпадать с rhs.
+template <typename T>
+void solve_tridiagonal_partitioned(std::size_t n, const T* sub, const T* diag, const T* super,
+                                   const T* rhs, T* x, TridiagonalWorkspace<T>& workspace,
+                                   ThreadPool& pool = default_thread_pool(),
+                                   double epsilon = TRIDIAGONAL_EPSILON,
+                                   std::size_t block_size = TRIDIAGONAL_PARTITION_BLOCK) {
+    if (n == 0) {
+        throw std::invalid_argument("Некорректные размеры для метода прогонки.");
+    }
+    block_size = std::max<std::size_t>(block_size, 2); // В блоке должна остаться хотя бы одна внутренняя строка
+    const std::size_t p = std::min(n / block_size, THREAD_POOL_MAX_CHUNKS);
+    if (p < 2) {
+        solve_tridiagonal_batch(n, 1, sub, diag, super, rhs, x, workspace.reserve(n), epsilon);
+        return;
+    }
+
+    const std::size_t m = p - 1; // Число разделителей
+    T* const cp = workspace.reserve(2 * n + 5 * p);
+    T* const v = cp + n;
+    T* const r_sub = v + n;
+    T* const r_diag = r_sub + p;
+    T* const r_super = r_diag + p;
+    T* const r_x = r_super + p;
+    T* const r_work = r_x + p;
+
+    // Блок k занимает строки [block_begin(k), block_begin(k + 1)), разделитель - последняя из них
+    auto block_begin = [n, p](std::size_t k) { return n * k / p; };
+    auto interior_end = [&](std::size_t k) { return k + 1 < p ? block_begin(k + 1) - 1 : n; };
+
+    // 1. Внутренние части блоков
+    pool.parallel_for(0, p, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            const std::size_t lo = block_begin(k);
+            const std::size_t hi = interior_end(k);
+            const T alpha = k > 0 ? sub[lo - 1] : T(0);
+            const T gamma = k + 1 < p ? super[hi - 1] : T(0);
+            tridiagonal_partition_block(lo, hi, sub, diag, super, rhs, alpha, gamma, x, v, cp, epsilon);
+        }
+    });
+
+    // 2. Система для разделителей s_k = interior_end(k):
+    //    -a_s v_{s-1} x_{s_{k-1}} + (b_s - a_s w_{s-1} - c_s v_{s+1}) x_s - c_s w_{s+1} x_{s_{k+1}}
+    //        = d_s - a_s y_{s-1} - c_s y_{s+1}
+    for (std::size_t k = 0; k < m; ++k) {
+        const std::size_t s = interior_end(k);
+        const T a_s = sub[s - 1];
+        const T c_s = super[s];
+        if (k > 0) r_sub[k - 1] = -a_s * v[s - 1];
+        r_diag[k] = diag[s] - a_s * cp[s - 1] - c_s * v[s + 1];
+        if (k + 1 < m) r_super[k] = -c_s * cp[s + 1];
+        r_x[k] = rhs[s] - a_s * x[s - 1] - c_s * x[s + 1];
+    }
+    solve_tridiagonal_batch(m, 1, r_sub, r_diag, r_super, r_x, r_x, r_work, epsilon);
+
+    // 3. Восстановление внутренних частей по значениям в разделителях
+    pool.parallel_for(0, p, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            const T x_left = k > 0 ? r_x[k - 1] : T(0);
+            const T x_right = k + 1 < p ? r_x[k] : T(0);
+            const std::size_t hi = interior_end(k);
+            for (std::size_t i = block_begin(k); i < hi; ++i) {
+                x[i] -= x_left * v[i] + x_right * cp[i];
+            }
+            if (k + 1 < p) x[hi] = x_right;
+        }
+    });
+}
+
+// Одна система выбранным способом с рабочей памятью вызывающего.
+// pool нужен только для TridiagonalEngine::Partitioned (nullptr - общий пул); последовательная прогонка
+// к пулу не обращается и не создает его.
+template <typename T>
+void solve_tridiagonal_system(std::size_t n, const T* sub, const T* diag, const T* super,
+                              const T* rhs, T* x, TridiagonalWorkspace<T>& workspace,
+                              TridiagonalEngine engine = TridiagonalEngine::Thomas,
+                              double epsilon = TRIDIAGONAL_EPSILON,
+                              ThreadPool* pool = nullptr) {
+    if (engine == TridiagonalEngine::Partitioned) {
+        solve_tridiagonal_partitioned(n, sub, diag, super, rhs, x, workspace,
+                                      pool ? *pool : default_thread_pool(), epsilon);
+    } else {
+        solve_tridiagonal_batch(n, 1, sub, diag, super, rhs, x, workspace.reserve(n), epsilon);
+    }
+}
+
+#endif //COMP_MATH_TRIDIAGONAL_H
@@ -8,11 +8,21 @@
 #include <limits>       // Для std::numeric_limits
 #include <algorithm>    // Для std::swap, std::max_element
 
+#include "matrix.h"     // Плотная матрица с непрерывным выровненным хранением
+#include "gemm.h"       // Блочное умножение матриц
+#include "lu.h"         // Блочное LU-разложение с выбором главного элемента
+#include "elimination.h" // Параллельные метод Гаусса и обращение матрицы (gauss, inverse_matrix)
+#include "tridiagonal.h" // Пакетный метод прогонки
+#include "trace.h"      // Трассировка (вместо вывода в цикле сравнения матриц)
+#include "sparse.h"     // Разреженные матрицы (CSR) и итерационные методы
+#include "binary_io.h"  // Двоичный формат матриц и векторов (отображение файла в память)
+
 
-typedef std::vector<std::vector<double>> Matrix;
 const double EPSILON = 1e-9;
 
-void print_vector(const std::vector<double>& v, const std::string& name = "", int precision = 15) {
+// Печать вектора или строки матрицы (любой контейнер с size() и operator[])
+template <typename Vector>
+void print_vector(const Vector& v, const std::string& name = "", int precision = 15) {
     if (!name.empty()) {
         std::cout<< name << ": ";
     }
@@ -29,7 +39,7 @@ void print_matrix(const Matrix& matrix, const std::string& name = "", int precis
         std::cout << name << ":" << std::endl;
     }
     std::cout << std::fixed << std::setprecision(precision);
-    for (size_t i = 0; i < matrix.size(); ++i) {
+    for (size_t i = 0; i < matrix.rows(); ++i) {
         std::cout << "  "; // Отступ для строки матрицы
         print_vector(matrix[i], "", precision);
     }
@@ -44,15 +54,6 @@ double compute_vector_norm_1(const std::vector<double>& v) {
     return norm;
 }
 
-// Вычисление infinity-нормы вектора: max(|v_i|)
-double compute_vector_norm_inf(const std::vector<double>& v) {
-    double norm = 0.0;
-    for (double val : v) {
-        norm = std::max(norm, std::abs(val));
-    }
-    return norm;
-}
-
 // Вычисление разности векторов: A - B
 std::vector<double> diff_vector(const std::vector<double>& A, const std::vector<double>& B) {
     if (A.size() != B.size()) {
@@ -68,16 +69,20 @@ std::vector<double> diff_vector(const std::vector<double>& A, const std::vector<
 
 // Вычисление 1-нормы матрицы: max по столбцам (sum(|a_ij|))
 double compute_matrix_norm_1(const Matrix& matrix) {
-    if (matrix.empty() || matrix[0].empty()) return 0.0;
-    const size_t N = matrix.size();
-    const size_t M = matrix[0].size();
-    double max_col_sum = 0.0;
+    if (matrix.empty()) return 0.0;
+    const size_t N = matrix.rows();
+    const size_t M = matrix.cols();
 
-    for (size_t j = 0; j < M; ++j) {
-        double current_col_sum = 0.0;
-        for (size_t i = 0; i < N; ++i) {
-            current_col_sum += std::abs(matrix[i][j]);
+    // Суммы по столбцам накапливаются построчно, чтобы обходить память последовательно
+    std::vector<double> col_sums(M, 0.0);
+    for (size_t i = 0; i < N; ++i) {
+        const double* row = matrix.row_data(i);
+        for (size_t j = 0; j < M; ++j) {
+            col_sums[j] += std::abs(row[j]);
         }
+    }
+    double max_col_sum = 0.0;
+    for (double current_col_sum : col_sums) {
         max_col_sum = std::max(max_col_sum, current_col_sum);
     }
     return max_col_sum;
@@ -86,16 +91,15 @@ double compute_matrix_norm_1(const Matrix& matrix) {
 // Вычисление infinity-нормы матрицы: max по строкам (sum(|a_ij|))
 double compute_matrix_norm_inf(const Matrix& matrix) {
     if (matrix.empty()) return 0.0;
-    const size_t N = matrix.size();
-    const size_t M = matrix[0].size(); // Предполагаем, что матрица не пустая
+    const size_t N = matrix.rows();
+    const size_t M = matrix.cols();
     double max_row_sum = 0.0;
 
     for (size_t i = 0; i < N; ++i) {
+        const double* row = matrix.row_data(i);
         double current_row_sum = 0.0;
         for (size_t j = 0; j < M; ++j) {
-             if (j < matrix[i].size()) {
-                 current_row_sum += std::abs(matrix[i][j]);
-             }
+            current_row_sum += std::abs(row[j]);
         }
         max_row_sum = std::max(max_row_sum, current_row_sum);
     }
@@ -103,11 +107,11 @@ double compute_matrix_norm_inf(const Matrix& matrix) {
 }
 
 
-// Умножение матрицы на вектор: y = A * x
-std::vector<double> multiply_matrix_vector(const Matrix& A, const std::vector<double>& x) {
-    const size_t rowsA = A.size();
+// Умножение матрицы на вектор: y = A * x (A - DenseMatrix::view() или отображенная из файла матрица)
+std::vector<double> multiply_matrix_vector(MatrixView<const double> A, const std::vector<double>& x) {
+    const size_t rowsA = A.rows();
     if (rowsA == 0) return {};
-    const size_t colsA = A[0].size();
+    const size_t colsA = A.cols();
     const size_t sizeX = x.size();
 
     if (colsA != sizeX) {
@@ -116,40 +120,39 @@ std::vector<double> multiply_matrix_vector(const Matrix& A, const std::vector<do
 
     std::vector<double> y(rowsA, 0.0);
     for (size_t i = 0; i < rowsA; ++i) {
+        const double* row = A.row_data(i);
+        double sum = 0.0;
         for (size_t j = 0; j < colsA; ++j) {
-            y[i] += A[i][j] * x[j];
+            sum += row[j] * x[j];
         }
+        y[i] = sum;
     }
     return y;
 }
 
 // Умножение матриц: C = A * B
 Matrix multiply(const Matrix& A, const Matrix& B) {
-    const size_t rowsA = A.size();
+    const size_t rowsA = A.rows();
     if (rowsA == 0) return {};
-    const size_t colsA = A[0].size();
-    const size_t rowsB = B.size();
+    const size_t colsA = A.cols();
+    const size_t rowsB = B.rows();
     if (rowsB == 0) return {};
-    const size_t colsB = B[0].size();
+    const size_t colsB = B.cols();
 
     if (colsA != rowsB) {
          throw std::invalid_argument("Несовместимые размеры матриц для умножения.");
     }
 
-    Matrix result(rowsA, std::vector<double>(colsB, 0.0));
-    for (size_t i = 0; i < rowsA; ++i) {
-        for (size_t j = 0; j < colsB; ++j) {
-            for (size_t k = 0; k < colsA; ++k) {
-                result[i][j] += A[i][k] * B[k][j];
-            }
-        }
-    }
+    // Блочное умножение с упаковкой панелей и векторным микроядром (см. gemm.h)
+    Matrix result(rowsA, colsB);
+    gemm(rowsA, colsB, colsA, 1.0, A.data(), A.stride(), B.data(), B.stride(),
+         0.0, result.data(), result.stride());
     return result;
 }
 
 // Создание единичной матрицы
 Matrix create_identity_matrix(size_t n) {
-    Matrix I(n, std::vector<double>(n, 0.0));
+    Matrix I(n, n);
     for (size_t i = 0; i < n; ++i) {
         I[i][i] = 1.0;
     }
@@ -159,191 +162,51 @@ Matrix create_identity_matrix(size_t n) {
 
 // Сравнение двух матриц с допуском epsilon
 bool are_matrices_close(const Matrix& A, const Matrix& B, double tolerance = EPSILON) {
-    if (A.size() != B.size() || (A.empty() && !B.empty()) || (!A.empty() && B.empty())) {
+    if (A.rows() != B.rows() || A.cols() != B.cols()) {
         return false;
     }
     if (A.empty()) return true; // Обе пустые
-    if (A[0].size() != B[0].size()) {
-        return false;
-    }
 
-    const size_t rows = A.size();
-    const size_t cols = A[0].size();
+    const size_t rows = A.rows();
+    const size_t cols = A.cols();
 
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
-            std::cout << std::abs(A[i][j] - B[i][j]) << ' ';
-
-            if (std::abs(A[i][j] - B[i][j]) > tolerance) {
+            const double difference = std::abs(A[i][j] - B[i][j]);
+            if (difference > tolerance) {
+                // Номер нарушившего допуск элемента (i * cols + j) - в трассу, если она подключена
+                trace("are_matrices_close", TraceEvent::Mismatch, static_cast<long long>(i * cols + j),
+                      A[i][j], difference, tolerance, 0);
                 return false;
             }
         }
-
-        std::cout << std::endl;
     }
     return true;
 }
 
 
-// Решение СЛАУ методом Гаусса с выбором главного элемента по столбцу
-std::vector<double> gauss(Matrix A, std::vector<double> b) { // Принимаем копии, т.к. будем их изменять
-    const size_t n = A.size();
-    if (n == 0 || A[0].size() != n || b.size() != n) {
-        throw std::invalid_argument("Некорректные размеры матрицы или вектора для метода Гаусса.");
-    }
-
-    // Прямой ход
-    for (size_t i = 0; i < n; ++i) {
-        // Выбор главного элемента в текущем столбце (начиная с i-й строки)
-        size_t maxRow = i;
-        for (size_t k = i + 1; k < n; ++k) {
-            if (std::abs(A[k][i]) > std::abs(A[maxRow][i])) {
-                maxRow = k;
-            }
-        }
-
-        // Проверка на вырожденность (с учетом погрешности)
-        if (std::abs(A[maxRow][i]) < EPSILON) {
-             bool found_pivot = false;
-             for(size_t check_col = i + 1; check_col < n; ++check_col) {
-                 if (std::abs(A[maxRow][check_col]) >= EPSILON) {
-                     found_pivot = true; // Нашли потенциальный опорный, но в другом столбце
-                     break;
-                 }
-             }
-             if (!found_pivot) {
-                 throw std::runtime_error("Матрица вырождена или близка к вырожденной (метод Гаусса).");
-             }
-             throw std::runtime_error("Матрица вырождена или требует перестановки столбцов (метод Гаусса).");
-        }
-
-
-        // Перестановка строк (матрицы A и вектора b)
-        std::swap(A[i], A[maxRow]);
-        std::swap(b[i], b[maxRow]);
-
-        // Обнуление элементов под главным элементом
-        double pivot = A[i][i]; // Обновляем pivot после возможной перестановки
-        for (size_t k = i + 1; k < n; ++k) {
-            const double factor = A[k][i] / pivot;
-            if (std::abs(factor) < EPSILON) continue; // Пропускаем, если множитель почти нулевой
-            for (size_t j = i; j < n; ++j) { // Начинаем с j=i, т.к. A[k][i] обнулится
-                A[k][j] -= factor * A[i][j];
-            }
-            b[k] -= factor * b[i];
-            // Явно обнуляем для точности (хотя математически уже должно быть 0)
-            A[k][i] = 0.0;
-        }
-    }
-
-    // Обратный ход
-    std::vector<double> x(n);
-    for (int i = static_cast<int>(n) - 1; i >= 0; --i) {
-        if (std::abs(A[i][i]) < EPSILON) {
-             throw std::runtime_error("Нулевой элемент на диагонали после прямого хода (метод Гаусса).");
-        }
-        double sum = 0.0;
-        for (size_t j = i + 1; j < n; ++j) {
-            sum += A[i][j] * x[j];
-        }
-        x[i] = (b[i] - sum) / A[i][i];
-    }
-
-    return x;
-}
-
-
-// LU-разложение (Doolittle's method: L имеет 1 на диагонали)
-// Возвращает пару {L, U}
-std::pair<Matrix, Matrix> LU_dec(const Matrix& matrix) {
-    const size_t n = matrix.size();
-    if (n == 0 || matrix[0].size() != n) {
+// LU-разложение PA = LU с частичным выбором главного элемента (блочный алгоритм, см. lu.h).
+// L (с единичной диагональю) и U хранятся в одной матрице, перестановки строк - в векторе pivots.
+LUFactorization<double> LU_dec(const Matrix& matrix) {
+    const size_t n = matrix.rows();
+    if (n == 0 || matrix.cols() != n) {
         throw std::invalid_argument("Матрица должна быть квадратной для LU-разложения.");
     }
-
-    Matrix L(n, std::vector<double>(n, 0.0));
-    Matrix U(n, std::vector<double>(n, 0.0));
-
-    for (size_t i = 0; i < n; ++i) {
-        // Расчет U
-        for (size_t j = i; j < n; ++j) {
-            double sum = 0.0;
-            for (size_t k = 0; k < i; ++k) {
-                sum += L[i][k] * U[k][j];
-            }
-            U[i][j] = matrix[i][j] - sum;
-        }
-
-        // Проверка на ноль на диагонали U
-        if (std::abs(U[i][i]) < EPSILON) {
-            // LU-разложение без перестановок не существует или матрица вырождена
-            throw std::runtime_error("Нулевой диагональный элемент в U при LU-разложении без перестановок.");
-        }
-
-        // Расчет L
-        L[i][i] = 1.0; // Диагональ L равна 1 для Doolittle
-        for (size_t j = i + 1; j < n; ++j) {
-            double sum = 0.0;
-            for (size_t k = 0; k < i; ++k) {
-                sum += L[j][k] * U[k][i];
-            }
-            L[j][i] = (matrix[j][i] - sum) / U[i][i];
-        }
-    }
-
-    return {L, U};
-}
-
-// Прямая подстановка для решения Ly = b (L - нижнетреугольная)
-std::vector<double> solve_forward_L(const Matrix& L, const std::vector<double>& b) {
-    const size_t n = L.size();
-    if (n == 0 || L[0].size() != n || b.size() != n) {
-         throw std::invalid_argument("Некорректные размеры для прямой подстановки.");
-    }
-    std::vector<double> y(n);
-
-    for (size_t i = 0; i < n; ++i) {
-        double sum = 0.0;
-        for (size_t j = 0; j < i; ++j) {
-            sum += L[i][j] * y[j];
-        }
-        // Проверка на ноль на диагонали L (хотя в Doolittle L[i][i]=1)
-        if (std::abs(L[i][i]) < EPSILON) {
-            throw std::runtime_error("Нулевой диагональный элемент в L при прямой подстановке.");
-        }
-        y[i] = (b[i] - sum) / L[i][i];
-    }
-    return y;
+    return LUFactorization<double>(matrix, EPSILON);
 }
 
-// Обратная подстановка для решения Ux = y (U - верхнетреугольная)
-std::vector<double> solve_backward_U(const Matrix& U, const std::vector<double>& y) {
-    const size_t n = U.size();
-     if (n == 0 || U[0].size() != n || y.size() != n) {
-         throw std::invalid_argument("Некорректные размеры для обратной подстановки.");
+// Решение СЛАУ Ax=b по готовому LU-разложению: O(n^2) на каждую правую часть
+std::vector<double> solve_lu(const LUFactorization<double>& lu, const std::vector<double>& b) {
+    if (b.size() != lu.size()) {
+        throw std::invalid_argument("Некорректные размеры для решения по LU-разложению.");
     }
-    std::vector<double> x(n);
-
-    for (int i = static_cast<int>(n) - 1; i >= 0; --i) {
-        double sum = 0.0;
-        for (size_t j = i + 1; j < n; ++j) {
-            sum += U[i][j] * x[j];
-        }
-         if (std::abs(U[i][i]) < EPSILON) {
-            throw std::runtime_error("Нулевой диагональный элемент в U при обратной подстановке.");
-        }
-        x[i] = (y[i] - sum) / U[i][i];
-    }
-    return x;
+    return lu.solve(b);
 }
 
 // Решение СЛАУ Ax=b с использованием LU-разложения
 std::vector<double> solve_lu(const Matrix& A, const std::vector<double>& b) {
     try {
-        auto [L, U] = LU_dec(A);
-        std::vector<double> y = solve_forward_L(L, b);
-        std::vector<double> x = solve_backward_U(U, y);
-        return x;
+        return solve_lu(LU_dec(A), b);
     } catch (const std::runtime_error& e) {
         // Перебрасываем исключение с добавлением информации
         throw std::runtime_error(std::string("Ошибка при решении методом LU: ") + e.what());
@@ -352,74 +215,83 @@ std::vector<double> solve_lu(const Matrix& A, const std::vector<double>& b) {
     }
 }
 
-// Нахождение обратной матрицы методом Гаусса-Жордана
-Matrix inverse_matrix(Matrix matrix) { // Принимаем копию
-    const size_t n = matrix.size();
-     if (n == 0 || matrix[0].size() != n) {
-        throw std::invalid_argument("Матрица должна быть квадратной для нахождения обратной.");
-    }
+// Вычисление вектора невязки r = Ax - b
+std::vector<double> compute_residual(MatrixView<const double> A, const std::vector<double>& x, const std::vector<double>& b) {
+    std::vector<double> Ax = multiply_matrix_vector(A, x);
+    return diff_vector(Ax, b);
+}
 
-    // Создаем расширенную матрицу [A | E]
-    Matrix augmented(n, std::vector<double>(2 * n));
-    for (size_t i = 0; i < n; ++i) {
-        for (size_t j = 0; j < n; ++j) {
-            augmented[i][j] = matrix[i][j];
-        }
-        augmented[i][i + n] = 1.0; // Формируем единичную матрицу справа
-    }
+std::vector<double> compute_residual(const Matrix& A, const std::vector<double>& x, const std::vector<double>& b) {
+    return compute_residual(A.view(), x, b);
+}
 
-    // Прямой ход (приведение левой части к верхнетреугольной)
-    for (size_t i = 0; i < n; ++i) {
-        // Выбор главного элемента
-        size_t maxRow = i;
-        for (size_t k = i + 1; k < n; ++k) {
-            if (std::abs(augmented[k][i]) > std::abs(augmented[maxRow][i])) {
-                maxRow = k;
-            }
-        }
+// Оценка числа обусловленности cond_1(A) по готовому LU-разложению (метод Хейгера-Хайэма, см. lu.h):
+// несколько треугольных решений за O(n^2) вместо обращения матрицы за O(n^3)
+double estimate_condition_number_1(const Matrix& A, const LUFactorization<double>& lu) {
+    return lu_condition_estimate_1(lu, compute_matrix_norm_1(A));
+}
 
-        if (std::abs(augmented[maxRow][i]) < EPSILON) {
-            throw std::runtime_error("Матрица вырождена, обратной не существует.");
-        }
+// То же для cond_inf(A)
+double estimate_condition_number_inf(const Matrix& A, const LUFactorization<double>& lu) {
+    return lu_condition_estimate_inf(lu, compute_matrix_norm_inf(A));
+}
 
-        // Перестановка строк
-        std::swap(augmented[i], augmented[maxRow]);
+// Решение СЛАУ Ax=b в смешанной точности: LU-разложение во float, уточнение невязки compute_residual в double;
+// при плохой обусловленности - переход к LU-разложению в double (см. lu_solve_mixed в lu.h)
+MixedPrecisionResult solve_lu_mixed(const Matrix& A, const std::vector<double>& b) {
+    MixedPrecisionControl control;
+    control.tolerance = EPSILON;
+    return lu_solve_mixed(A, b, [&A, &b](const std::vector<double>& x) { return compute_residual(A, x, b); },
+                          control);
+}
 
-        // Нормализация i-й строки (делим на ведущий элемент)
-        double pivot = augmented[i][i];
-        for (size_t j = i; j < 2 * n; ++j) { // Делим всю строку
-            augmented[i][j] /= pivot;
-        }
-         augmented[i][i] = 1.0; // Убедимся, что диагональный элемент ровно 1
-
-        // Обнуление элементов под главным элементом
-        for (size_t k = 0; k < n; ++k) {
-            if (k != i) { // Для всех строк, кроме текущей
-                double factor = augmented[k][i];
-                if (std::abs(factor) < EPSILON) continue; // Пропускаем, если множитель мал
-                for (size_t j = i; j < 2 * n; ++j) { // Начинаем с j=i
-                    augmented[k][j] -= factor * augmented[i][j];
-                }
-                augmented[k][i] = 0.0; // Явно обнуляем для точности
-            }
-        }
-    }
+// Вывод результата решения в смешанной точности
+void report_mixed_precision(const MixedPrecisionResult& result, const Matrix& A, const std::vector<double>& b,
+                            const std::vector<double>& x_exact, int precision) {
+    std::cout << "--- LU смешанной точности (float + уточнение в double) ---" << std::endl;
+    print_vector(result.x, "Решение x_mixed");
+    std::cout << "Шагов уточнения: " << result.refinements
+              << (result.double_fallback ? " (обусловленность слишком велика для float - разложение в double)" : "")
+              << std::endl;
+    std::cout << std::setprecision(precision);
+    std::cout << "||r_mixed||_inf   = " << vector_norm_inf(compute_residual(A, result.x, b)) << std::endl;
+    std::cout << "||err_mixed||_inf = " << vector_norm_inf(diff_vector(result.x, x_exact)) << std::endl;
+    std::cout << std::endl;
+}
 
-    // Извлечение обратной матрицы (правая часть расширенной матрицы)
-    Matrix inv(n, std::vector<double>(n));
-    for (size_t i = 0; i < n; ++i) {
-        for (size_t j = 0; j < n; ++j) {
-            inv[i][j] = augmented[i][j + n];
+// Невязка r = Ax - b для разреженной матрицы (умножение в пуле потоков, см. sparse.h)
+std::vector<double> compute_residual(const CsrMatrix& A, const std::vector<double>& x, const std::vector<double>& b) {
+    std::vector<double> Ax = spmv(A, x);
+    return diff_vector(Ax, b);
+}
+
+// Матрица разностной задачи -div(grad u) + convection * du/dx на сетке grid x grid (пятиточечный шаблон);
+// при convection = 0 - симметричная положительно определенная (уравнение Пуассона)
+CsrMatrix build_grid_operator(size_t grid, double convection) {
+    std::vector<SparseEntry> entries;
+    entries.reserve(5 * grid * grid);
+    const double h = 1.0 / static_cast<double>(grid + 1);
+    for (size_t iy = 0; iy < grid; ++iy) {
+        for (size_t ix = 0; ix < grid; ++ix) {
+            const size_t k = iy * grid + ix;
+            entries.push_back({k, k, 4.0});
+            if (ix > 0) entries.push_back({k, k - 1, -1.0 - 0.5 * convection * h});
+            if (ix + 1 < grid) entries.push_back({k, k + 1, -1.0 + 0.5 * convection * h});
+            if (iy > 0) entries.push_back({k, k - grid, -1.0});
+            if (iy + 1 < grid) entries.push_back({k, k + grid, -1.0});
         }
     }
-
-    return inv;
+    return CsrMatrix::from_entries(grid * grid, grid * grid, std::move(entries));
 }
 
-// Вычисление вектора невязки r = Ax - b
-std::vector<double> compute_residual(const Matrix& A, const std::vector<double>& x, const std::vector<double>& b) {
-    std::vector<double> Ax = multiply_matrix_vector(A, x);
-    return diff_vector(Ax, b);
+// Строка отчета об итерационном методе: невязка пересчитывается через compute_residual
+void report_iterative(const std::string& name, const CsrMatrix& A, const std::vector<double>& x,
+                      const std::vector<double>& b, const IterativeResult& result) {
+    const double residual_norm = vector_norm_inf(compute_residual(A, x, b));
+    std::cout << "  " << name << ": итераций " << result.iterations
+              << ", умножений A*x " << result.spmv_count
+              << ", ||r||_inf = " << std::scientific << std::setprecision(3) << residual_norm << std::fixed
+              << (result.converged ? "" : "  (не сошелся)") << std::endl;
 }
 
 
@@ -428,50 +300,17 @@ std::vector<double> solve_tridiagonal(
     const std::vector<double>& a, // под-диагональ (индексы 1..n-1 в матрице)
     const std::vector<double>& b, // главная диагональ (индексы 0..n-1)
     const std::vector<double>& c, // над-диагональ (индексы 0..n-2)
-    const std::vector<double>& d)
+    const std::vector<double>& d,
+    TridiagonalEngine engine = TridiagonalEngine::Thomas) // Thomas - последовательно, Partitioned - по блокам в пуле потоков
 {
     const size_t n = b.size();
     if (a.size() != n - 1 || c.size() != n - 1 || d.size() != n || n == 0) {
         throw std::invalid_argument("Некорректные размеры векторов для метода прогонки.");
     }
 
-    std::vector<double> P(n); // Прогоночные коэффициенты P_i
-    std::vector<double> Q(n); // Прогоночные коэффициенты Q_i
     std::vector<double> x(n); // Решение
-
-    // Прямой ход (вычисление P и Q)
-    if (std::abs(b[0]) < EPSILON) {
-         throw std::runtime_error("Нулевой элемент b[0] в методе прогонки.");
-    }
-    P[0] = -c[0] / b[0];
-    Q[0] = d[0] / b[0];
-
-    for (size_t i = 1; i < n; ++i) {
-        double denominator;
-        // Индексы для a и c: a[i-1] соответствует a_i в формулах, c[i-1] соответствует c_{i-1}
-        if (i < n - 1) { // Для всех, кроме последней строки
-             denominator = b[i] + a[i-1] * P[i-1];
-             if (std::abs(denominator) < EPSILON) {
-                 throw std::runtime_error("Нулевой знаменатель при вычислении прогоночных коэффициентов.");
-             }
-             P[i] = -c[i] / denominator; // c[i] соответствует c_i в формулах
-             Q[i] = (d[i] - a[i-1] * Q[i-1]) / denominator;
-        } else { // Последняя строка (i = n - 1)
-             denominator = b[i] + a[i-1] * P[i-1];
-             if (std::abs(denominator) < EPSILON) {
-                 throw std::runtime_error("Нулевой знаменатель при вычислении последнего прогоночного коэффициента Q.");
-             }
-             // P[n-1] не нужен для обратного хода (или можно считать его 0)
-             P[n-1] = 0.0; // По определению или по отсутствию c[n-1]
-             Q[i] = (d[i] - a[i-1] * Q[i-1]) / denominator;
-        }
-    }
-
-    // Обратный ход (вычисление x)
-    x[n - 1] = Q[n - 1];
-    for (int i = static_cast<int>(n) - 2; i >= 0; --i) {
-        x[i] = P[i] * x[i + 1] + Q[i];
-    }
+    TridiagonalWorkspace<double> workspace;
+    solve_tridiagonal_system(n, a.data(), b.data(), c.data(), d.data(), x.data(), workspace, engine, EPSILON);
 
     return x;
 }
@@ -487,7 +326,7 @@ Matrix build_tridiagonal_matrix(
     if (a.size() != n - 1 || c.size() != n - 1 || n == 0) {
          throw std::invalid_argument("Некорректные размеры векторов для построения трехдиагональной матрицы.");
     }
-    Matrix T(n, std::vector<double>(n, 0.0));
+    Matrix T(n, n);
     for (size_t i = 0; i < n; ++i) {
         T[i][i] = b[i];
         if (i > 0) {
@@ -503,7 +342,50 @@ Matrix build_tridiagonal_matrix(
 
 // --- Основная программа ---
 
-int main() {
+// Решение системы из двоичных файлов (см. binary_io.h): плотная матрица - LU-разложением,
+// разреженная (CSR) - BiCGSTAB с ILU(0). Файлы отображаются в память, вектор b читается без копирования.
+int solve_binary_system(const std::string& matrix_path, const std::string& rhs_path) {
+    try {
+        const BinaryFile matrix_file(matrix_path);
+        const BinaryFile rhs_file(rhs_path);
+        const RowView<const double> rhs = rhs_file.vector<double>();
+        const std::vector<double> b(rhs.begin(), rhs.end());
+        std::vector<double> x;
+        double residual_norm = 0.0;
+        if (matrix_file.layout() == BinaryLayout::Csr) {
+            const CsrMatrix A = matrix_file.csr();
+            IterativeControl control;
+            control.epsilon = EPSILON;
+            x.assign(A.rows(), 0.0);
+            report_iterative("BiCGSTAB + ILU(0)", A, x, b, solve_bicgstab(A, b, x, Ilu0Preconditioner(A), control));
+            residual_norm = vector_norm_inf(compute_residual(A, x, b));
+        } else {
+            // LU изменяет матрицу, поэтому отображение копируется один раз в выровненную DenseMatrix,
+            // которая переходит в разложение; невязка считается по отображению
+            const MatrixView<const double> A = matrix_file.matrix<double>();
+            if (A.rows() != A.cols()) {
+                throw std::invalid_argument("Матрица должна быть квадратной для LU-разложения.");
+            }
+            const LUFactorization<double> lu(Matrix(A), EPSILON);
+            x = solve_lu(lu, b);
+            residual_norm = vector_norm_inf(compute_residual(A, x, b));
+        }
+        std::cout << "Система " << matrix_path << ": n = " << x.size() << ", ||r||_inf = " << std::scientific
+                  << std::setprecision(3) << residual_norm << std::endl;
+        if (x.size() <= 16) print_vector(x, "Решение x");
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка при решении системы из файлов: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // Система из двоичных файлов: task <матрица> <вектор b>
+    if (argc > 2) {
+        return solve_binary_system(argv[1], argv[2]);
+    }
+
     // Устанавливаем точность вывода по умолчанию
     const int precision = 15;
     std::cout << std::fixed << std::setprecision(precision);
@@ -537,7 +419,7 @@ int main() {
         std::vector<double> r_gauss_good = compute_residual(A_good, x_gauss_good, b_good);
         print_vector(r_gauss_good, "Невязка r_gauss_good", precision); // Повышенная точность для невязки
         double norm1_r_gauss_good = compute_vector_norm_1(r_gauss_good);
-        double normInf_r_gauss_good = compute_vector_norm_inf(r_gauss_good);
+        double normInf_r_gauss_good = vector_norm_inf(r_gauss_good);
         std::cout << "||r_gauss_good||_1   = " << norm1_r_gauss_good << std::endl;
         std::cout << "||r_gauss_good||_inf = " << normInf_r_gauss_good << std::endl;
 
@@ -545,13 +427,13 @@ int main() {
         std::vector<double> err_gauss_good = diff_vector(x_gauss_good, x_exact_good);
         print_vector(err_gauss_good, "Абс. погрешность err_gauss_good", precision);
         double norm1_err_gauss_good = compute_vector_norm_1(err_gauss_good);
-        double normInf_err_gauss_good = compute_vector_norm_inf(err_gauss_good);
+        double normInf_err_gauss_good = vector_norm_inf(err_gauss_good);
         std::cout << "||err_gauss_good||_1   = " << norm1_err_gauss_good << std::endl;
         std::cout << "||err_gauss_good||_inf = " << normInf_err_gauss_good << std::endl;
 
         // 4. Вычисление относительной погрешности для Гаусса
         double norm1_exact_good = compute_vector_norm_1(x_exact_good);
-        double normInf_exact_good = compute_vector_norm_inf(x_exact_good);
+        double normInf_exact_good = vector_norm_inf(x_exact_good);
         std::cout << "||x_exact_good||_1   = " << norm1_exact_good << std::endl;
         std::cout << "||x_exact_good||_inf = " << normInf_exact_good << std::endl;
         if (norm1_exact_good > EPSILON)
@@ -561,16 +443,17 @@ int main() {
         std::cout << std::endl;
 
 
-        // 5. Решение методом LU
+        // 5. Решение методом LU (разложение строится один раз и может использоваться для других правых частей)
         std::cout << "--- Метод LU ---" << std::endl;
-        std::vector<double> x_lu_good = solve_lu(A_good, b_good);
+        LUFactorization<double> lu_good = LU_dec(A_good);
+        std::vector<double> x_lu_good = solve_lu(lu_good, b_good);
         print_vector(x_lu_good, "Решение x_lu_good");
 
         // 6. Вычисление невязки для LU
         std::vector<double> r_lu_good = compute_residual(A_good, x_lu_good, b_good);
         print_vector(r_lu_good, "Невязка r_lu_good", precision);
         double norm1_r_lu_good = compute_vector_norm_1(r_lu_good);
-        double normInf_r_lu_good = compute_vector_norm_inf(r_lu_good);
+        double normInf_r_lu_good = vector_norm_inf(r_lu_good);
         std::cout << "||r_lu_good||_1   = " << norm1_r_lu_good << std::endl;
         std::cout << "||r_lu_good||_inf = " << normInf_r_lu_good << std::endl;
 
@@ -578,7 +461,7 @@ int main() {
         std::vector<double> err_lu_good = diff_vector(x_lu_good, x_exact_good);
         print_vector(err_lu_good, "Абс. погрешность err_lu_good", precision);
         double norm1_err_lu_good = compute_vector_norm_1(err_lu_good);
-        double normInf_err_lu_good = compute_vector_norm_inf(err_lu_good);
+        double normInf_err_lu_good = vector_norm_inf(err_lu_good);
         std::cout << "||err_lu_good||_1   = " << norm1_err_lu_good << std::endl;
         std::cout << "||err_lu_good||_inf = " << normInf_err_lu_good << std::endl;
 
@@ -589,6 +472,8 @@ int main() {
              std::cout << "Отн. погрешность (inf-норма) = " << normInf_err_lu_good / normInf_exact_good << std::endl;
         std::cout << std::endl;
 
+        report_mixed_precision(solve_lu_mixed(A_good, b_good), A_good, b_good, x_exact_good, precision);
+
         // 9. Нахождение обратной матрицы
         std::cout << "--- Обратная матрица и число обусловленности ---" << std::endl;
         Matrix A_inv_good = inverse_matrix(A_good);
@@ -596,7 +481,7 @@ int main() {
 
         // 10. Проверка A * A_inv = E
         Matrix Product_good = multiply(A_good, A_inv_good);
-        Matrix E_good = create_identity_matrix(A_good.size());
+        Matrix E_good = create_identity_matrix(A_good.rows());
         std::cout << "Проверка A_good * A_inv_good:" << std::endl;
         // print_matrix(Product_good, "Результат A*A_inv", 15); // Можно раскомментировать для детального просмотра
         if (are_matrices_close(Product_good, E_good)) {
@@ -621,6 +506,9 @@ int main() {
         std::cout << "||A_inv_good||_inf = " << normInf_A_inv_good << std::endl;
         std::cout << "cond_1(A_good)   = " << cond1_good << std::endl;
         std::cout << "cond_inf(A_good) = " << condInf_good << std::endl;
+        std::cout << "Оценка по LU-разложению (без обращения матрицы):" << std::endl;
+        std::cout << "cond_1(A_good)   ~ " << estimate_condition_number_1(A_good, lu_good) << std::endl;
+        std::cout << "cond_inf(A_good) ~ " << estimate_condition_number_inf(A_good, lu_good) << std::endl;
 
     } catch (const std::exception& e) {
         std::cerr << "Ошибка при обработке хорошо обусловленной матрицы: " << e.what() << std::endl;
@@ -657,7 +545,7 @@ int main() {
         std::vector<double> r_gauss_bad = compute_residual(A_bad, x_gauss_bad, b_bad);
         print_vector(r_gauss_bad, "Невязка r_gauss_bad", precision); // Повышенная точность
         double norm1_r_gauss_bad = compute_vector_norm_1(r_gauss_bad);
-        double normInf_r_gauss_bad = compute_vector_norm_inf(r_gauss_bad);
+        double normInf_r_gauss_bad = vector_norm_inf(r_gauss_bad);
         std::cout << "||r_gauss_bad||_1   = " << norm1_r_gauss_bad << std::endl;
         std::cout << "||r_gauss_bad||_inf = " << normInf_r_gauss_bad << std::endl;
 
@@ -665,13 +553,13 @@ int main() {
         std::vector<double> err_gauss_bad = diff_vector(x_gauss_bad, x_exact_bad);
         print_vector(err_gauss_bad, "Абс. погрешность err_gauss_bad", precision);
         double norm1_err_gauss_bad = compute_vector_norm_1(err_gauss_bad);
-        double normInf_err_gauss_bad = compute_vector_norm_inf(err_gauss_bad);
+        double normInf_err_gauss_bad = vector_norm_inf(err_gauss_bad);
         std::cout << "||err_gauss_bad||_1   = " << norm1_err_gauss_bad << std::endl;
         std::cout << "||err_gauss_bad||_inf = " << normInf_err_gauss_bad << std::endl;
 
         // 4. Вычисление относительной погрешности для Гаусса
         double norm1_exact_bad = compute_vector_norm_1(x_exact_bad);
-        double normInf_exact_bad = compute_vector_norm_inf(x_exact_bad);
+        double normInf_exact_bad = vector_norm_inf(x_exact_bad);
         std::cout << "||x_exact_bad||_1   = " << norm1_exact_bad << std::endl;
         std::cout << "||x_exact_bad||_inf = " << normInf_exact_bad << std::endl;
          if (norm1_exact_bad > EPSILON)
@@ -682,17 +570,19 @@ int main() {
 
         // 5. Решение методом LU
         std::cout << "--- Метод LU ---" << std::endl;
-         // Для плохо обусловленной матрицы LU без перестановок может не сработать или дать плохой результат
-         // Попробуем, но ожидаем возможных проблем
+         // Для плохо обусловленной матрицы LU-разложение может дать большую погрешность решения.
+         // Разложение сохраняется для оценки числа обусловленности (пункт 11).
+         LUFactorization<double> lu_bad;
          try {
-            std::vector<double> x_lu_bad = solve_lu(A_bad, b_bad);
+            lu_bad = LU_dec(A_bad);
+            std::vector<double> x_lu_bad = solve_lu(lu_bad, b_bad);
             print_vector(x_lu_bad, "Решение x_lu_bad");
 
              // 6. Вычисление невязки для LU
             std::vector<double> r_lu_bad = compute_residual(A_bad, x_lu_bad, b_bad);
             print_vector(r_lu_bad, "Невязка r_lu_bad", precision);
             double norm1_r_lu_bad = compute_vector_norm_1(r_lu_bad);
-            double normInf_r_lu_bad = compute_vector_norm_inf(r_lu_bad);
+            double normInf_r_lu_bad = vector_norm_inf(r_lu_bad);
             std::cout << "||r_lu_bad||_1   = " << norm1_r_lu_bad << std::endl;
             std::cout << "||r_lu_bad||_inf = " << normInf_r_lu_bad << std::endl;
 
@@ -700,7 +590,7 @@ int main() {
             std::vector<double> err_lu_bad = diff_vector(x_lu_bad, x_exact_bad);
             print_vector(err_lu_bad, "Абс. погрешность err_lu_bad", precision);
             double norm1_err_lu_bad = compute_vector_norm_1(err_lu_bad);
-            double normInf_err_lu_bad = compute_vector_norm_inf(err_lu_bad);
+            double normInf_err_lu_bad = vector_norm_inf(err_lu_bad);
             std::cout << "||err_lu_bad||_1   = " << norm1_err_lu_bad << std::endl;
             std::cout << "||err_lu_bad||_inf = " << normInf_err_lu_bad << std::endl;
 
@@ -712,10 +602,11 @@ int main() {
 
          } catch (const std::runtime_error& e) {
              std::cerr << "Ошибка при решении методом LU для плохо обусловленной матрицы: " << e.what() << std::endl;
-             std::cerr << "Это ожидаемо для LU без перестановок для таких матриц." << std::endl;
          }
         std::cout << std::endl;
 
+        report_mixed_precision(solve_lu_mixed(A_bad, b_bad), A_bad, b_bad, x_exact_bad, precision);
+
 
         // 9. Нахождение обратной матрицы
         std::cout << "--- Обратная матрица и число обусловленности ---" << std::endl;
@@ -724,7 +615,7 @@ int main() {
 
         // 10. Проверка A * A_inv = E
         Matrix Product_bad = multiply(A_bad, A_inv_bad);
-        Matrix E_bad = create_identity_matrix(A_bad.size());
+        Matrix E_bad = create_identity_matrix(A_bad.rows());
         std::cout << "Проверка A_bad * A_inv_bad:" << std::endl;
         // print_matrix(Product_bad, "Результат A*A_inv", 15);
         if (are_matrices_close(Product_bad, E_bad, 1e-5)) { // Увеличим допуск для плохой матрицы
@@ -751,6 +642,11 @@ int main() {
         std::cout << "||A_inv_bad||_inf = " << normInf_A_inv_bad << std::endl;
         std::cout << "cond_1(A_bad)   = " << cond1_bad << std::endl;
         std::cout << "cond_inf(A_bad) = " << condInf_bad << std::endl;
+        if (lu_bad.size() == A_bad.rows()) { // Разложение из пункта 5 (если оно удалось)
+            std::cout << "Оценка по LU-разложению (без обращения матрицы):" << std::endl;
+            std::cout << "cond_1(A_bad)   ~ " << estimate_condition_number_1(A_bad, lu_bad) << std::endl;
+            std::cout << "cond_inf(A_bad) ~ " << estimate_condition_number_inf(A_bad, lu_bad) << std::endl;
+        }
         std::cout << std::fixed << std::setprecision(precision); // Вернем обычную нотацию
 
 
@@ -797,7 +693,7 @@ int main() {
         std::vector<double> r_tridiagonal = compute_residual(T_tridiagonal, x_tridiagonal, d_tri);
         print_vector(r_tridiagonal, "Невязка r_tridiagonal", 15);
         double norm1_r_tridiagonal = compute_vector_norm_1(r_tridiagonal);
-        double normInf_r_tridiagonal = compute_vector_norm_inf(r_tridiagonal);
+        double normInf_r_tridiagonal = vector_norm_inf(r_tridiagonal);
         std::cout << "||r_tridiagonal||_1   = " << norm1_r_tridiagonal << std::endl;
         std::cout << "||r_tridiagonal||_inf = " << normInf_r_tridiagonal << std::endl;
 
@@ -805,6 +701,54 @@ int main() {
     } catch (const std::exception& e) {
          std::cerr << "Ошибка при решении трехдиагональной системы: " << e.what() << std::endl;
     }
+    std::cout << std::endl;
+
+    // --- ЗАДАЧА 4: Разреженные системы (CSR) и итерационные методы ---
+    std::cout << "======================================================" << std::endl;
+    std::cout << "   Разреженные системы: уравнение Пуассона на сетке 64 x 64" << std::endl;
+    std::cout << "======================================================" << std::endl;
+
+    try {
+        constexpr size_t GRID = 64;
+        const CsrMatrix poisson = build_grid_operator(GRID, 0.0);
+        const CsrMatrix convection = build_grid_operator(GRID, 50.0);
+        const std::vector<double> b_sparse(poisson.rows(), 1.0);
+        std::cout << "Неизвестных: " << poisson.rows() << ", ненулевых элементов: " << poisson.nonzeros()
+                  << " (заполнение " << std::setprecision(3)
+                  << 100.0 * poisson.nonzeros() / (static_cast<double>(poisson.rows()) * poisson.cols()) << "%)" << std::endl;
+
+        IterativeControl iterative;
+        iterative.epsilon = 1e-8;
+        iterative.max_iterations = 20000;
+        const JacobiPreconditioner jacobi_poisson(poisson);
+        const Ilu0Preconditioner ilu_poisson(poisson);
+        const Ilu0Preconditioner ilu_convection(convection);
+
+        std::vector<double> x_sparse(poisson.rows(), 0.0);
+        report_iterative("Якоби", poisson, x_sparse, b_sparse, solve_jacobi(poisson, b_sparse, x_sparse, iterative));
+        x_sparse.assign(poisson.rows(), 0.0);
+        report_iterative("Гаусс-Зейдель", poisson, x_sparse, b_sparse,
+                         solve_gauss_seidel(poisson, b_sparse, x_sparse, iterative));
+        x_sparse.assign(poisson.rows(), 0.0);
+        report_iterative("CG", poisson, x_sparse, b_sparse,
+                         solve_cg(poisson, b_sparse, x_sparse, IdentityPreconditioner(), iterative));
+        x_sparse.assign(poisson.rows(), 0.0);
+        report_iterative("CG + Якоби", poisson, x_sparse, b_sparse,
+                         solve_cg(poisson, b_sparse, x_sparse, jacobi_poisson, iterative));
+        x_sparse.assign(poisson.rows(), 0.0);
+        report_iterative("CG + ILU(0)", poisson, x_sparse, b_sparse,
+                         solve_cg(poisson, b_sparse, x_sparse, ilu_poisson, iterative));
+
+        std::cout << "Несимметричная задача (конвекция-диффузия):" << std::endl;
+        x_sparse.assign(convection.rows(), 0.0);
+        report_iterative("BiCGSTAB", convection, x_sparse, b_sparse,
+                         solve_bicgstab(convection, b_sparse, x_sparse, IdentityPreconditioner(), iterative));
+        x_sparse.assign(convection.rows(), 0.0);
+        report_iterative("BiCGSTAB + ILU(0)", convection, x_sparse, b_sparse,
+                         solve_bicgstab(convection, b_sparse, x_sparse, ilu_convection, iterative));
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка при решении разреженной системы: " << e.what() << std::endl;
+    }
 
     return 0;
 }
\ No newline at end of file
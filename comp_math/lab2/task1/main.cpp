@@ -12,68 +12,91 @@
 #include <iostream>
 #include <cmath>
 #include <iomanip>
+#include <vector>
+#include <chrono>     // Для замера пакетного режима
+#include <algorithm>  // Для std::max
+
+#include "roots.h"
 
 double f1(double x) {
     return x * x * x - 2 * x + 4;
 }
 
-// Метод Половинного Деления
-void bisection_method(double a, double b, double epsilon) {
-    if (f1(a) * f1(b) >= 0) {
-        std::cout << "Ошибка: f(a) и f(b) должны иметь разные знаки." << std::endl;
-        // Дополнительная проверка на случай точного корня на границе
-        if (std::fabs(f1(a)) < 1e-9) {
-             std::cout << "Точный корень найден на границе a: " << a << std::endl;
-             return;
-        }
-
-        if (std::fabs(f1(b)) < 1e-9) {
-             std::cout << "Точный корень найден на границе b: " << b << std::endl;
-             return;
-        }
-
-        return;
+// Вывод строки таблицы итераций метода половинного деления
+struct BisectionTable {
+    void operator()(const RootIteration& it) const {
+        std::cout << std::fixed << std::setprecision(7);
+        std::cout << std::setw(5) << it.iteration << std::setw(15) << it.a << std::setw(15) << it.b << std::setw(15)
+                  << it.x << std::setw(15) << it.fx << std::setw(15) << it.step << "\n";
     }
+};
 
-    double c = a;
-    int iterations = 0;
-
+// Метод Половинного Деления
+void bisection_method(double a, double b, double epsilon) {
     std::cout << "Метод Половинного Деления для f(x) = x^3 - 2x + 4\n";
     std::cout << "Интервал: [" << a << ", " << b << "], Точность: " << epsilon << "\n";
     std::cout << "---------------------------------------------------\n";
     std::cout << std::setw(5) << "Iter" << std::setw(15) << "a" << std::setw(15) << "b" << std::setw(15) << "c=(a+b)/2" << std::setw(15) << "f(c)" << std::setw(15) << "|b-a|/2" << "\n";
     std::cout << "---------------------------------------------------\n";
 
-
-    while ((b - a) > epsilon) {
-        ++iterations;
-        c = (a + b) / 2.0;
-
-        std::cout << std::fixed << std::setprecision(7);
-        std::cout << std::setw(5) << iterations << std::setw(15) << a << std::setw(15) << b << std::setw(15) << c << std::setw(15) << f1(c) << std::setw(15) << (b-a)/2.0 << "\n";
-
-        // Проверка, если корень найден точно (маловероятно с double)
-        if (std::fabs(f1(c)) < 1e-15) {
-            std::cout << "Точный корень найден: " << c << std::endl;
-            break;
-        }
-
-        if (f1(c) * f1(a) < 0)
-            b = c;
-        else
-            a = c;
-
+    const RootResult result = bisection(f1, a, b, epsilon, BisectionTable{});
+    if (result.status == RootStatus::NoSignChange) {
+        std::cout << "Ошибка: f(a) и f(b) должны иметь разные знаки." << std::endl;
+        return;
+    }
+    if (result.status == RootStatus::BadValue) {
+        std::cout << "Ошибка: f(a) или f(b) - NaN или бесконечность." << std::endl;
+        return;
+    }
+    // f(a) или f(b) равно нулю: bisection сразу возвращает этот конец как найденный корень (Converged)
+    // без итераций. Отрезок короче epsilon тоже дает 0 итераций, но f_root != 0 - для него обычный вывод ниже.
+    if (result.f_root == 0.0 && result.iterations == 0) {
+        std::cout << "Точный корень найден на границе: " << result.root << std::endl;
+        return;
     }
-
-     c = (a + b) / 2.0;
 
     std::cout << "---------------------------------------------------\n";
     std::cout << "Результат:\n";
-    std::cout << "Приближенный корень: " << std::fixed << std::setprecision(7) << c << std::endl;
-    std::cout << "Количество итераций: " << iterations << std::endl;
-    std::cout << "f(корень) = " << f1(c) << std::endl;
-    std::cout << "корень в диапазоне: {" << a << " " << b<<"}" << std::endl;
-    std::cout << "Достигнутая точность |b-a|/2 = " << (b-a)/2.0 << std::endl;
+    std::cout << "Приближенный корень: " << std::fixed << std::setprecision(7) << result.root << std::endl;
+    std::cout << "Количество итераций: " << result.iterations << std::endl;
+    std::cout << "f(корень) = " << result.f_root << std::endl;
+    std::cout << "корень в диапазоне: {" << result.a << " " << result.b << "}" << std::endl;
+    std::cout << "Достигнутая точность |b-a|/2 = " << (result.b - result.a) / 2.0 << std::endl;
+}
+
+// Обращение кривой y = f1(x) для набора значений y_i: f1(x) - y_i = 0 на отрезке [a, b]
+// сразу для всех значений (пакетный режим, уравнения решаются блоками в пуле потоков)
+void batch_inversion(double a, double b, double epsilon, std::size_t count) {
+    std::vector<double> y(count), lower(count, a), upper(count, b), roots(count);
+    std::vector<RootResult> results(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        y[i] = -100.0 + 200.0 * static_cast<double>(i) / static_cast<double>(count - 1);
+    }
+    auto equations = [&y](std::size_t first, const double* xs, double* fx, std::size_t lanes) {
+        for (std::size_t l = 0; l < lanes; ++l) fx[l] = f1(xs[l]) - y[first + l];
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    find_roots_bracketed(equations, count, lower, upper, roots, epsilon, results);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double max_residual = 0.0;
+    std::size_t converged = 0;
+    long long evaluations = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        max_residual = std::max(max_residual, std::fabs(f1(roots[i]) - y[i]));
+        converged += results[i].converged();
+        evaluations += results[i].evaluations;
+    }
+    std::cout << "\nПакетное обращение f(x) = y для " << count << " значений y в [-100, 100], отрезок ["
+              << a << ", " << b << "], точность " << std::scientific << std::setprecision(0) << epsilon
+              << std::fixed << " (метод Иллинойс)\n";
+    std::cout << "Сошлось: " << converged << " из " << count << ", вычислений f в среднем: "
+              << std::setprecision(1) << static_cast<double>(evaluations) / static_cast<double>(count) << std::endl;
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "Макс. |f(x_i) - y_i| = " << max_residual << ", " << static_cast<double>(count) / seconds
+              << " корней/с" << std::endl;
+    std::cout << std::fixed << std::setprecision(7);
 }
 
 int main() {
@@ -81,5 +104,11 @@ int main() {
 
     bisection_method(a1, b1, eps1);
 
+    const RootResult brent_result = brent(f1, a1, b1, eps1);
+    std::cout << "\nМетод Брента: корень " << brent_result.root << ", итераций " << brent_result.iterations
+              << ", вычислений f " << brent_result.evaluations << std::endl;
+
+    batch_inversion(a1, b1, 1e-12, 100000);
+
     return 0;
-}
\ No newline at end of file
+}
@@ -2,6 +2,12 @@
 #include <cmath>
 #include <iomanip>
 #include <limits> // Для numeric_limits
+#include <vector>
+#include <chrono>     // Для замера пакетного режима
+#include <algorithm>  // Для std::max
+
+#include "roots.h"
+#include "chebyshev.h" // Аппроксимация f2 и ее производной
 
 // --- Функции для Задачи 2 ---
 const double LN10 = std::log(10.0); // Натуральный логарифм 10
@@ -47,41 +53,23 @@ void simple_iteration_method(double x0, double epsilon, double (*g)(double), int
     std::cout << std::setw(5) << "Iter" << std::setw(20) << "x_k" << std::setw(20) << "x_{k+1}=g(x_k)" << std::setw(20) << "|x_{k+1}-x_k|" << "\n";
     std::cout << "---------------------------------------------------\n";
 
-    double x_prev = x0;
-    double x_next;
-    int iterations = 0;
-    bool converged = false;
-
-    for (iterations = 1; iterations <= max_iterations; ++iterations) {
-        x_next = g(x_prev);
-
-        // Проверка на NaN или бесконечность
-        if (std::isnan(x_next) || std::isinf(x_next)) {
-            std::cout << "Ошибка: Получено NaN или бесконечность на итерации " << iterations << std::endl;
-            break;
-        }
-
-        double diff = std::fabs(x_next - x_prev);
-
+    auto table = [](const RootIteration& it) {
         std::cout << std::fixed << std::setprecision(7);
-        std::cout << std::setw(5) << iterations << std::setw(20) << x_prev << std::setw(20) << x_next << std::setw(20) << diff << "\n";
-
-        if (diff < epsilon) {
-            converged = true;
-            break;
-        }
-        x_prev = x_next;
-    }
+        std::cout << std::setw(5) << it.iteration << std::setw(20) << it.x << std::setw(20) << it.fx << std::setw(20) << it.step << "\n";
+    };
+    const RootResult result = simple_iteration(g, x0, epsilon, table, max_iterations);
 
     std::cout << "---------------------------------------------------\n";
-    if (converged) {
+    if (result.converged()) {
         std::cout << "Результат:\n";
-        std::cout << "Приближенный корень: " << std::fixed << std::setprecision(7) << x_next << std::endl;
-        std::cout << "Количество итераций: " << iterations << std::endl;
-        std::cout << "f(корень) = " << f2(x_next) << std::endl;
+        std::cout << "Приближенный корень: " << std::fixed << std::setprecision(7) << result.root << std::endl;
+        std::cout << "Количество итераций: " << result.iterations << std::endl;
+        std::cout << "f(корень) = " << f2(result.root) << std::endl;
+    } else if (result.status == RootStatus::BadValue) {
+        std::cout << "Ошибка: Получено NaN или бесконечность на итерации " << result.iterations << std::endl;
     } else {
         std::cout << "Метод не сошелся за " << max_iterations << " итераций." << std::endl;
-        std::cout << "Последнее приближение: " << x_next << std::endl;
+        std::cout << "Последнее приближение: " << result.root << std::endl;
     }
 }
 
@@ -93,53 +81,57 @@ void newton_method(double x0, double epsilon, double (*f)(double), double (*f_pr
     std::cout << std::setw(5) << "Iter" << std::setw(18) << "x_k" << std::setw(18) << "f(x_k)" << std::setw(18) << "f'(x_k)" << std::setw(18) << "|delta_x|" << "\n";
     std::cout << "-------------------------------------------------------------\n";
 
-    double x_prev = x0;
-    double x_next = 0;
-    int iterations = 0;
-    bool converged = false;
-    double diff =0;
-
-    for (iterations = 1; iterations <= max_iterations; ++iterations) {
-        double fx = f(x_prev);
-        double fpx = f_prime(x_prev);
-
-        if (std::isnan(fx) || std::isnan(fpx) || std::isinf(fx) || std::isinf(fpx)) {
-            std::cout << "Ошибка: Получено NaN или бесконечность (f или f') на итерации " << iterations << std::endl;
-            break;
-        }
-
-         if (std::fabs(fpx) < 1e-15) {
-            std::cout << "Ошибка: Производная близка к нулю на итерации " << iterations << ". f'(" << x_prev << ") = " << fpx << std::endl;
-            break;
-        }
-
-        double delta_x = fx / fpx;
-        x_next = x_prev - delta_x;
-        diff = std::fabs(delta_x);
-
+    auto table = [f_prime](const RootIteration& it) {
         std::cout << std::fixed << std::setprecision(7);
-        std::cout << std::setw(5) << iterations << std::setw(18) << x_prev << std::setw(18) << fx << std::setw(18) << fpx << std::setw(18) << diff << "\n";
+        std::cout << std::setw(5) << it.iteration << std::setw(18) << it.x << std::setw(18) << it.fx << std::setw(18) << f_prime(it.x) << std::setw(18) << it.step << "\n";
+    };
+    const RootResult result = newton(f, f_prime, x0, epsilon, table, max_iterations);
 
+    std::cout << "-------------------------------------------------------------\n";
+    if (result.converged()) {
+        std::cout << "Результат:\n";
+        std::cout << "Приближенный корень: " << std::fixed << std::setprecision(7) << result.root << std::endl;
+        std::cout << "Количество итераций: " << result.iterations << std::endl;
+        std::cout << "f(корень) = " << result.f_root << std::endl;
+    } else if (result.status == RootStatus::BadValue) {
+        std::cout << "Ошибка: Получено NaN или бесконечность (f или f') на итерации " << result.iterations << std::endl;
+    } else if (result.status == RootStatus::ZeroDerivative) {
+        std::cout << "Ошибка: Производная близка к нулю на итерации " << result.iterations << std::endl;
+    } else {
+        std::cout << "Метод не сошелся за " << max_iterations << " итераций." << std::endl;
+        std::cout << "Последнее приближение: " << result.root << std::endl;
+    }
+}
 
-        if (f2(x_next) < epsilon) {
-             converged = true;
-            break;
+// --- Пакетный метод Ньютона: уравнения 2x - log10(x) - 2 = c_i на отрезке [a, b] ---
+void batch_newton(double a, double b, double epsilon, std::size_t count) {
+    std::vector<double> c(count), lower(count, a), upper(count, b), roots(count);
+    std::vector<RootResult> results(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        c[i] = static_cast<double>(i) / static_cast<double>(count - 1); // c_i в [0, 1]
+    }
+    auto equations = [&c](std::size_t first, const double* xs, double* fx, double* dfx, std::size_t lanes) {
+        for (std::size_t l = 0; l < lanes; ++l) {
+            fx[l] = 2.0 * xs[l] - std::log(xs[l]) / LN10 - 2.0 - c[first + l];
+            dfx[l] = 2.0 - 1.0 / (xs[l] * LN10);
         }
+    };
 
-        x_prev = x_next;
-    }
+    const auto start = std::chrono::steady_clock::now();
+    find_roots_newton(equations, count, lower, upper, roots, epsilon, results);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
-    std::cout << "-------------------------------------------------------------\n";
-     if (converged) {
-        std::cout << "Результат:\n";
-        std::cout << "Приближенный корень: " << std::fixed << std::setprecision(7) << x_next << std::endl;
-        std::cout << "Количество итераций: " << iterations << std::endl;
-        std::cout << "f(корень) = " << f(x_next) << std::endl;
-         std::cout << "diff = " << diff << std::endl;
-     } else {
-         std::cout << "Метод не сошелся за " << max_iterations << " итераций." << std::endl;
-         std::cout << "Последнее приближение: " << x_next << std::endl;
-     }
+    double max_residual = 0.0;
+    std::size_t converged = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        max_residual = std::max(max_residual, std::fabs(f2(roots[i]) - c[i]));
+        converged += results[i].converged();
+    }
+    std::cout << "Сошлось: " << converged << " из " << count << std::endl;
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "Макс. |f(x_i) - c_i| = " << max_residual << ", " << static_cast<double>(count) / seconds
+              << " корней/с" << std::endl;
+    std::cout << std::fixed << std::setprecision(7);
 }
 
 
@@ -164,5 +156,27 @@ int main() {
     std::cout << "\n\n*** Поиск корня в интервале [0.5, 1.5] (корень x=1) ***\n";
     newton_method(x0_root2, eps2, f2, f2_prime);
 
+    std::cout << "\n--- Метод Ньютона с защитой бисекцией (отрезок [0.5, 2]) ---\n";
+    const RootResult safeguarded = newton_safeguarded(f2, f2_prime, 0.5, 2.0, x0_root2, eps2);
+    std::cout << "Корень: " << safeguarded.root << ", итераций " << safeguarded.iterations
+              << ", вычислений f и f' " << safeguarded.evaluations << std::endl;
+
+    // Тот же метод по аппроксимации Чебышева f2 на [0.5, 2]: логарифм вычисляется только при построении,
+    // производная берется по коэффициентам аппроксимации
+    const ChebyshevApproximation f2_approx = build_chebyshev(f2, 0.5, 2.0, 1e-14);
+    const ChebyshevApproximation f2_approx_prime = f2_approx.derivative();
+    const RootResult approx_result = newton_safeguarded(f2_approx, f2_approx_prime, 0.5, 2.0, x0_root2, eps2);
+    std::cout << "По аппроксимации Чебышева (" << f2_approx.pieces() << " кусков степени " << f2_approx.degree()
+              << ", " << f2_approx.evaluations() << " вычислений f при построении): корень " << approx_result.root
+              << ", итераций " << approx_result.iterations << ", f(корень) = " << f2(approx_result.root) << std::endl;
+
+    std::cout << "\n--- Метод Брента (отрезок [0.001, 0.5]) ---\n";
+    const RootResult brent_result = brent(f2, 0.001, 0.5, eps2);
+    std::cout << "Корень: " << brent_result.root << ", итераций " << brent_result.iterations
+              << ", вычислений f " << brent_result.evaluations << std::endl;
+
+    std::cout << "\n--- Пакетный метод Ньютона: 2x - log10(x) - 2 = c_i, c_i в [0, 1], отрезок [0.5, 3] ---\n";
+    batch_newton(0.5, 3.0, 1e-12, 100000);
+
     return 0;
 }
\ No newline at end of file
@@ -5,33 +5,127 @@
 #include <numeric>   // Для std::iota
 #include <stdexcept> // Для обработки ошибок
 #include <algorithm>
+#include <span>      // Для std::span
+#include <string>    // Для std::stoull
 
+#include "spline.h"      // Естественный кубический сплайн (прогонка - tridiagonal.h)
+#include "solver_output.h" // Запись значений сплайна в двоичный файл
 
-// Вычисляет значение полинома Лагранжа в точке xp
-double lagrange_interpolation(const std::vector<double>& x_nodes,
-                               const std::vector<double>& y_nodes,
-                               double xp) {
-    if (x_nodes.size() != y_nodes.size() || x_nodes.empty()) {
-        throw std::invalid_argument("Некорректные узлы для интерполяции Лагранжа.");
+
+// Интерполяционный многочлен Лагранжа в барицентрической форме.
+// Узлы проверяются и веса w_i = 1 / prod_{j != i} (x_i - x_j) считаются один раз при добавлении,
+// после чего значение в точке вычисляется за O(n):
+//   P(x) = sum(w_i y_i / (x - x_i)) / sum(w_i / (x - x_i)).
+class LagrangeInterpolator {
+public:
+    // Число точек, обрабатываемых вместе в пакетной оценке
+    static constexpr size_t EVALUATION_TILE = 64;
+
+    LagrangeInterpolator() = default;
+
+    LagrangeInterpolator(const std::vector<double>& x_nodes, const std::vector<double>& y_nodes) {
+        if (x_nodes.size() != y_nodes.size() || x_nodes.empty()) {
+            throw std::invalid_argument("Некорректные узлы для интерполяции Лагранжа.");
+        }
+        x_.reserve(x_nodes.size());
+        y_.reserve(x_nodes.size());
+        weights_.reserve(x_nodes.size());
+        for (size_t i = 0; i < x_nodes.size(); ++i) {
+            add_node(x_nodes[i], y_nodes[i]);
+        }
+    }
+
+    // Добавление узла за O(n): старые веса делятся на (x_i - x), вес нового узла считается заново
+    void add_node(double x, double y) {
+        // Проверка на совпадение узлов (до изменения весов, чтобы при ошибке объект остался прежним)
+        for (double x_i : x_) {
+            if (std::abs(x_i - x) < 1e-9) {
+                throw std::runtime_error(
+                    "Обнаружены дублирующиеся x‑узлы, для интерполяции Лагранжа требуются различные узлы.");
+            }
+        }
+        double weight = 1.0;
+        for (size_t i = 0; i < x_.size(); ++i) {
+            const double diff = x_[i] - x;
+            weights_[i] /= diff;
+            weight /= -diff;
+        }
+        x_.push_back(x);
+        y_.push_back(y);
+        weights_.push_back(weight);
+    }
+
+    size_t size() const { return x_.size(); }
+
+    // Значение многочлена в точке xp
+    double operator()(double xp) const {
+        if (x_.empty()) {
+            throw std::invalid_argument("Некорректные узлы для интерполяции Лагранжа.");
+        }
+        double numerator = 0.0;
+        double denominator = 0.0;
+        for (size_t i = 0; i < x_.size(); ++i) {
+            const double diff = xp - x_[i];
+            if (diff == 0.0) return y_[i]; // Точка совпала с узлом
+            const double t = weights_[i] / diff;
+            numerator += t * y_[i];
+            denominator += t;
+        }
+        return numerator / denominator;
     }
-    size_t n = x_nodes.size();
-    double interpolated_value = 0.0;
-
-    for (size_t i = 0; i < n; ++i) {
-        double basis_polynomial = 1.0;
-        for (size_t j = 0; j < n; ++j) {
-            if (i != j) {
-                // Проверка на совпадение узлов
-                if (std::abs(x_nodes[i] - x_nodes[j]) < 1e-9) {
-                    throw std::runtime_error(
-                        "Обнаружены дублирующиеся x‑узлы, для интерполяции Лагранжа требуются различные узлы.");
+
+    // Значения во многих точках: out[k] = P(xs[k]).
+    // Точки обрабатываются блоками, внутренний цикл идет по точкам блока и векторизуется;
+    // порядок суммирования по узлам тот же, что в operator(), поэтому результаты совпадают.
+    void evaluate(std::span<const double> xs, std::span<double> out) const {
+        if (x_.empty()) {
+            throw std::invalid_argument("Некорректные узлы для интерполяции Лагранжа.");
+        }
+        if (xs.size() != out.size()) {
+            throw std::invalid_argument("Размеры массивов точек и значений многочлена не совпадают.");
+        }
+
+        double numerator[EVALUATION_TILE];
+        double denominator[EVALUATION_TILE];
+        size_t hit[EVALUATION_TILE]; // Номер совпавшего узла + 1 (0 - нет совпадения)
+        for (size_t first = 0; first < xs.size(); first += EVALUATION_TILE) {
+            const size_t count = std::min(EVALUATION_TILE, xs.size() - first);
+            const double* points = xs.data() + first;
+            for (size_t p = 0; p < count; ++p) {
+                numerator[p] = 0.0;
+                denominator[p] = 0.0;
+                hit[p] = 0;
+            }
+            for (size_t i = 0; i < x_.size(); ++i) {
+                const double x_i = x_[i];
+                const double y_i = y_[i];
+                const double w_i = weights_[i];
+                for (size_t p = 0; p < count; ++p) {
+                    const double diff = points[p] - x_i;
+                    const double t = w_i / diff;
+                    numerator[p] += t * y_i;
+                    denominator[p] += t;
+                    hit[p] = (diff == 0.0 && hit[p] == 0) ? i + 1 : hit[p];
                 }
-                basis_polynomial *= (xp - x_nodes[j]) / (x_nodes[i] - x_nodes[j]);
+            }
+            for (size_t p = 0; p < count; ++p) {
+                out[first + p] = hit[p] ? y_[hit[p] - 1] : numerator[p] / denominator[p];
             }
         }
-        interpolated_value += y_nodes[i] * basis_polynomial;
     }
-    return interpolated_value;
+
+private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> weights_;
+};
+
+// Вычисляет значение полинома Лагранжа в точке xp (однократный вызов; для многих точек
+// с теми же узлами выгоднее один раз построить LagrangeInterpolator)
+double lagrange_interpolation(const std::vector<double>& x_nodes,
+                               const std::vector<double>& y_nodes,
+                               double xp) {
+    return LagrangeInterpolator(x_nodes, y_nodes)(xp);
 }
 
 void lagrange_method() {
@@ -63,9 +157,12 @@ void lagrange_method() {
     std::cout << "xp\t| P(xp)\n";
     std::cout << "--------|-------------\n";
     try {
-        for (double xp : x_eval) {
-            double yp = lagrange_interpolation(x_nodes, y_nodes, xp);
-            std::cout << xp << "\t " << yp << std::endl;
+        // Веса считаются один раз, затем многочлен вычисляется сразу во всех точках
+        LagrangeInterpolator interpolator(x_nodes, y_nodes);
+        std::vector<double> y_eval(x_eval.size());
+        interpolator.evaluate(x_eval, y_eval);
+        for (size_t k = 0; k < x_eval.size(); ++k) {
+            std::cout << x_eval[k] << "\t " << y_eval[k] << std::endl;
         }
     } catch (const std::exception& e) {
         std::cerr << "Ошибка интерполяции Лагранжа: " << e.what() << std::endl;
@@ -79,43 +176,7 @@ double func(double x) {
     return sin(x * x) * exp(-x * x);
 }
 
-// Структура для хранения данных сплайна
-struct SplineData {
-    std::vector<double> x; // Узлы xi
-    std::vector<double> y; // Значения yi = f(xi)
-    std::vector<double> M; // Вторые производные Mi в узлах
-    double h;              // Шаг (равномерная сетка)
-};
-
-// Решение трёхдиагональной СЛАУ методом Томаса
-void solve_tridiagonal(const std::vector<double>& a,
-                      const std::vector<double>& b,
-                      const std::vector<double>& c,
-                      const std::vector<double>& d,
-                      std::vector<double>& x,
-                      int n) {
-    if (n <= 0) return;
-
-    std::vector<double> c_prime(n);
-    std::vector<double> d_prime(n);
-
-    // Прямой ход
-    c_prime[0] = c[0] / b[0];
-    d_prime[0] = d[0] / b[0];
-    for (int i = 1; i < n; ++i) {
-        double m = 1.0 / (b[i] - a[i] * c_prime[i - 1]);
-        c_prime[i] = (i < n - 1) ? (c[i] * m) : 0.0;
-        d_prime[i] = (d[i] - a[i] * d_prime[i - 1]) * m;
-    }
-
-    // Обратный ход
-    x[n - 1] = d_prime[n - 1];
-    for (int i = n - 2; i >= 0; --i) {
-        x[i] = d_prime[i] - c_prime[i] * x[i + 1];
-    }
-}
-
-// Построение естественного кубического сплайна
+// Построение естественного кубического сплайна для func по n узлам
 SplineData build_natural_cubic_spline(double a, double b, int n) {
     if (n < 3) {
         throw std::invalid_argument("Для кубического сплайна нужно минимум 3 точки.");
@@ -124,7 +185,6 @@ SplineData build_natural_cubic_spline(double a, double b, int n) {
     SplineData spline;
     spline.x.resize(n);
     spline.y.resize(n);
-    spline.M.resize(n);
     spline.h = (b - a) / (n - 1);
 
     // Генерация узлов и значений функции
@@ -133,97 +193,11 @@ SplineData build_natural_cubic_spline(double a, double b, int n) {
         spline.y[i] = func(spline.x[i]);
     }
 
-    // Настройка трёхдиагональной системы для M1 … M_{n-2}
-    int system_size = n - 2; // Решаем для M1..M_{n-2}
-    if (system_size <= 0) {
-        spline.M[0] = 0.0;
-        if (n > 1) spline.M[n - 1] = 0.0;
-        if (n == 3) { // Отдельный случай n=3
-            double d1 = (6.0 / spline.h) *
-                        ((spline.y[2] - spline.y[1]) / spline.h -
-                         (spline.y[1] - spline.y[0]) / spline.h);
-            double b1 = 4.0 * spline.h;
-            spline.M[1] = d1 / b1;
-        }
-        return spline;
-    }
-
-    // Коэффициенты системы
-    std::vector<double> sub_diag(system_size);
-    std::vector<double> main_diag(system_size);
-    std::vector<double> super_diag(system_size);
-    std::vector<double> rhs(system_size);
-
-    // Формулы для естественного сплайна
-    for (int k = 0; k < system_size; ++k) {
-        int i = k + 1;
-        main_diag[k] = 4.0 * spline.h;
-        rhs[k] = (6.0 / spline.h) *
-                 (spline.y[i + 1] - 2.0 * spline.y[i] + spline.y[i - 1]);
-        if (k > 0) sub_diag[k] = spline.h;
-        if (k < system_size - 1) super_diag[k] = spline.h;
-    }
-
-    // Подготовка к TDMA
-    std::vector<double> tdma_a(system_size), tdma_b(system_size),
-        tdma_c(system_size), tdma_d(system_size), solution_M(system_size);
-
-    for (int k = 0; k < system_size; ++k) {
-        tdma_b[k] = main_diag[k];
-        tdma_d[k] = rhs[k];
-        tdma_a[k] = (k > 0) ? sub_diag[k] : 0;
-        tdma_c[k] = (k < system_size - 1) ? super_diag[k] : 0;
-    }
-
-    solve_tridiagonal(tdma_a, tdma_b, tdma_c, tdma_d, solution_M, system_size);
-
-    // Запись полученных Mi
-    spline.M[0] = 0.0;
-    for (int k = 0; k < system_size; ++k) {
-        spline.M[k + 1] = solution_M[k];
-    }
-    spline.M[n - 1] = 0.0;
-
+    SplineWorkspace workspace;
+    solve_spline_moments(spline, workspace);
     return spline;
 }
 
-// Оценка значения сплайна S(xp) в точке xp
-double evaluate_spline(const SplineData& spline, double xp) {
-    size_t n = spline.x.size();
-    if (n < 2) {
-        throw std::runtime_error("Сплайн не построен или содержит слишком мало точек.");
-    }
-
-    // Поиск интервала [xi, x_{i+1}], в котором находится xp
-    auto it = std::lower_bound(spline.x.begin(), spline.x.end(), xp);
-    int i = std::distance(spline.x.begin(), it);
-
-    if (i == n) i = n - 1;
-    if (i > 0 && (xp < spline.x[i] || std::abs(xp - spline.x[i]) < 1e-9)) --i;
-
-    i = std::max(0, std::min((int)n - 2, i));
-
-    double xi = spline.x[i];
-    double xi1 = spline.x[i + 1];
-    double yi = spline.y[i];
-    double yi1 = spline.y[i + 1];
-    double Mi = spline.M[i];
-    double Mi1 = spline.M[i + 1];
-    double h = spline.h;
-
-    if (std::abs(h) < 1e-9) {
-        throw std::runtime_error("Нулевая ширина интервала сплайна.");
-    }
-
-    // Формула кубического сплайна на [xi, xi+1]
-    double term1 = Mi * pow(xi1 - xp, 3) / (6.0 * h);
-    double term2 = Mi1 * pow(xp - xi, 3) / (6.0 * h);
-    double term3 = (yi / h - Mi * h / 6.0) * (xi1 - xp);
-    double term4 = (yi1 / h - Mi1 * h / 6.0) * (xp - xi);
-
-    return term1 + term2 + term3 + term4;
-}
-
 void сubic_spline_method() {
     std::cout << "============================================" << std::endl;
     std::cout << "     Пример кубической сплайн‑интерполяции   " << std::endl;
@@ -276,12 +250,24 @@ void сubic_spline_method() {
     std::cout << std::endl;
 }
 
-int main() {
+int main(int argc, char** argv) {
     lagrange_method();
 
     std::cout << "\n\n";
 
     сubic_spline_method();
 
+    // Значения сплайна на мелкой сетке - в двоичный файл (путь - первый аргумент, число точек - второй)
+    if (argc > 1) {
+        try {
+            const std::size_t points = argc > 2 ? std::stoull(argv[2]) : 1000000;
+            write_spline_resample(argv[1], build_natural_cubic_spline(0.0, 3.0, 20), 0.0, 3.0, points);
+            std::cout << "Значения сплайна в " << points << " точках записаны в " << argv[1] << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка записи значений сплайна: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     return 0;
 }
@@ -2,9 +2,15 @@
 #include <vector>
 #include <cmath>
 #include <iomanip>
-#include <functional> // Для std::function
 #include <algorithm>  // Для std::min/max
 #include <string>     // Для std::string
+#include <span>       // Для std::span
+#include <limits>     // Для std::numeric_limits
+
+#include "ode.h"
+#include "trace.h"
+#include "solver_output.h" // Потоковая запись траектории в двоичный файл
+#include "chebyshev.h"     // Аппроксимация множителя правой части
 
 // --- Константы и параметры задачи ---
 constexpr double X0 = 0.0;
@@ -20,7 +26,6 @@ constexpr double SHRINK_LIMIT_FACTOR = 0.2; // Минимальное относ
 constexpr double H_MIN_ALLOWED = 1e-7;      // Минимально допустимый абсолютный шаг
 constexpr double H_MAX_ALLOWED = (XN - X0) / 20.0; // Максимально допустимый абсолютный шаг (например, 1/5 интервала)
 
-
 // --- Функция правой части ДУ ---
 // y' = f(x, y) = e^x / ((1 + e^x)y)
 double derivative(double x, double y) {
@@ -46,134 +51,66 @@ double exact_solution(double x) {
     return std::sqrt(term_inside_sqrt);
 }
 
-// --- Вспомогательная структура для возврата результата одного шага метода ---
-struct StepResult {
-    double y_next; // Значение y на следующем шаге
-    int f_evals;   // Количество вычислений функции f(x,y) для этого шага
-};
-
-// --- Реализация одного шага метода Эйлера-Коши (модифицированный Эйлер/Хойна) ---
-// Порядок точности p = 2
-StepResult euler_cauchy_step(double x, double y, double h, const std::function<double(double, double)>& f) {
-    double f_xy = f(x, y);
-    double y_predictor = y + h * f_xy;
-    double f_xph_ypred = f(x + h, y_predictor);
-    double y_next = y + (h / 2.0) * (f_xy + f_xph_ypred);
-    return {y_next, 2}; // 2 вызова функции f(x,y)
+// Правая часть в виде системы размерности 1 для решателей систем ОДУ из ode.h
+void derivative_system(double x, std::span<const double> y, std::span<double> dy) {
+    dy[0] = derivative(x, y[0]);
 }
 
-// --- Реализация одного шага метода Рунге-Кутты 4-го порядка ---
-// Порядок точности p = 4
-StepResult runge_kutta_4_step(double x, double y, double h, const std::function<double(double, double)>& f) {
-    double k1 = f(x, y);
-    double k2 = f(x + h / 2.0, y + h * k1 / 2.0);
-    double k3 = f(x + h / 2.0, y + h * k2 / 2.0);
-    double k4 = f(x + h, y + h * k3);
-    double y_next = y + (h / 6.0) * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
-    return {y_next, 4}; // 4 вызова функции f(x,y)
-}
-
-// --- Общая функция для решения ОДУ с автоматическим выбором шага ---
-void solve_ode_auto_step(
-    const std::string& method_name_debug, // Для отладочных сообщений
-    const std::function<StepResult(double, double, double, const std::function<double(double, double)>&)>& method_step_func,
-    int method_order_p, // Порядок точности метода
-    const std::function<double(double, double)>& deriv_func,
-    double x_start, double y_start, double x_end,
-    double initial_h, double target_epsilon,
-    std::vector<double>& out_x_values, // Вектор для сохранения значений x
-    std::vector<double>& out_y_values, // Вектор для сохранения значений y
-    long long& total_f_evaluations)    // Общее число вычислений f(x,y)
-{
-    out_x_values.clear();
-    out_y_values.clear();
-    total_f_evaluations = 0;
+// --- Жесткая тестовая задача ---
+// y' = -lambda (y - cos x) - sin x, y(0) = 1, точное решение y = cos x.
+// Явные методы устойчивы лишь при h ~ 1/lambda, неявный метод ведет шаг по гладкости решения.
+constexpr double STIFF_LAMBDA = 1e5;
 
-    double x_current = x_start;
-    double y_current = y_start;
-    double h_current = initial_h;
-
-    out_x_values.push_back(x_current);
-    out_y_values.push_back(y_current);
-
-    int max_iterations_safety = 200000; // Защита от бесконечного цикла
-    int iterations_count = 0;
-
-    while (x_current < x_end && iterations_count < max_iterations_safety) {
-        iterations_count++;
+void stiff_derivative(double x, std::span<const double> y, std::span<double> dy) {
+    dy[0] = -STIFF_LAMBDA * (y[0] - std::cos(x)) - std::sin(x);
+}
 
-        if (x_current + h_current > x_end) {
-            h_current = x_end - x_current; // Корректируем последний шаг, чтобы точно попасть в x_end
-        }
-        // Предотвращаем слишком маленький шаг, который может вызвать проблемы
-        if (h_current < H_MIN_ALLOWED / 10.0 && x_current < x_end) { // Добавлено /10.0 для большей устойчивости
-             std::cerr << "Warning (" << method_name_debug << "): Step size h_current (" << h_current
-                       << ") became extremely small at x = " << x_current << ". Stopping to prevent infinite loop." << std::endl;
-             break;
-        }
+void stiff_jacobian(double, std::span<const double>, DenseMatrix<double>& J) {
+    J(0, 0) = -STIFF_LAMBDA;
+}
 
+// Точное решение той же задачи с начальным условием y(X0) = y0 (для ансамбля начальных условий):
+// y^2 / 2 = ln(1 + e^x) + C  =>  y(x) = sqrt(y0^2 + 2 ln((1 + e^x) / (1 + e^X0)))
+double exact_solution_from(double x, double y0) {
+    return std::sqrt(y0 * y0 + 2.0 * std::log((1.0 + std::exp(x)) / (1.0 + std::exp(X0))));
+}
 
-        // 1. Делаем один "большой" шаг h_current
-        //    y1 - результат после одного шага h
-        StepResult res_h = method_step_func(x_current, y_current, h_current, deriv_func);
-        double y1 = res_h.y_next;
-        long long f_evals_for_y1 = res_h.f_evals;
-
-        // 2. Делаем два "маленьких" шага h_current / 2.0
-        //    y2 - результат после двух шагов h/2
-        StepResult res_h_half1 = method_step_func(x_current, y_current, h_current / 2.0, deriv_func);
-        double y_temp_half = res_h_half1.y_next;
-        StepResult res_h_half2 = method_step_func(x_current + h_current / 2.0, y_temp_half, h_current / 2.0, deriv_func);
-        double y2 = res_h_half2.y_next;
-        long long f_evals_for_y2 = res_h_half1.f_evals + res_h_half2.f_evals;
-
-        // Все эти вычисления функции f(x,y) были произведены
-        total_f_evaluations += f_evals_for_y1 + f_evals_for_y2;
-
-        // Оценка локальной погрешности по правилу Рунге
-        // R = |y1 - y2| / (2^p - 1)
-        double error_estimate_R = std::abs(y1 - y2) / (std::pow(2.0, method_order_p) - 1.0);
-
-        // Принимаем шаг, если оценка погрешности в норме ИЛИ если шаг уже предельно мал
-        if (error_estimate_R <= target_epsilon || h_current < H_MIN_ALLOWED) {
-            x_current += h_current;
-            y_current = y2; // y2 (результат с меньшим шагом) обычно точнее
-
-            out_x_values.push_back(x_current);
-            out_y_values.push_back(y_current);
-
-            // Адаптация шага для следующей итерации: пытаемся увеличить шаг
-            if (error_estimate_R == 0.0) { // Если ошибка нулевая (редко, но возможно)
-                h_current = std::min(h_current * GROW_LIMIT_FACTOR, H_MAX_ALLOWED);
-            } else if (error_estimate_R < target_epsilon) {
-                // Формула для оптимального шага, p - порядок метода, p+1 - порядок локальной погрешности O(h^(p+1))
-                double optimal_factor = SAFETY_FACTOR * std::pow(target_epsilon / error_estimate_R, 1.0 / (method_order_p + 1.0));
-                h_current *= std::min(optimal_factor, GROW_LIMIT_FACTOR); // Ограничиваем рост
-            }
-            // Если error_estimate_R был близок к target_epsilon, шаг может не измениться сильно, или даже уменьшится немного из-за SAFETY_FACTOR.
-            // Это нормально. Если error_estimate_R == target_epsilon, optimal_factor = SAFETY_FACTOR.
-            // Если h_current был H_MIN_ALLOWED, то он и останется H_MIN_ALLOWED после этой логики, если не увеличится.
-
-        } else { // Отвергаем шаг: оценка погрешности слишком велика. Уменьшаем h_current.
-            double shrink_factor = SAFETY_FACTOR * std::pow(target_epsilon / error_estimate_R, 1.0 / (method_order_p + 1.0));
-            // shrink_factor будет < SAFETY_FACTOR, так как (target_epsilon / error_estimate_R) < 1.
-            h_current *= std::max(shrink_factor, SHRINK_LIMIT_FACTOR); // Ограничиваем уменьшение
-            // x_current и y_current не меняются, цикл повторится с новым, уменьшенным h_current
-        }
+// --- Ансамбль начальных условий y0 из [ENSEMBLE_Y0_MIN, ENSEMBLE_Y0_MAX] ---
+constexpr std::size_t ENSEMBLE_SIZE = 10000;
+constexpr double ENSEMBLE_Y0_MIN = 0.5;
+constexpr double ENSEMBLE_Y0_MAX = 1.5;
+constexpr std::size_t ENSEMBLE_FIXED_STEPS = 20; // Шагов метода Рунге-Кутты 4 с постоянным шагом
 
-        // Применяем глобальные ограничения на шаг
-        h_current = std::min(h_current, H_MAX_ALLOWED);
-        h_current = std::max(h_current, H_MIN_ALLOWED);
+// Правая часть траектории ансамбля (от номера траектории не зависит)
+void ensemble_derivative(std::size_t, double x, std::span<const double> y, std::span<double> dy) {
+    dy[0] = derivative(x, y[0]);
+}
 
-        if (x_current >= x_end) break; // Выход, если достигли или немного пересекли конец промежутка
+// Правая часть блока синхронных траекторий: множитель e^x / (1 + e^x) общий для всего блока
+void ensemble_batch_derivative(double x, std::size_t, std::size_t lanes,
+                               std::span<const double> y, std::span<double> dy) {
+    const double g = std::exp(x) / (1.0 + std::exp(x));
+    for (std::size_t l = 0; l < lanes; ++l) {
+        dy[l] = g / y[l];
     }
+}
 
-     if (iterations_count >= max_iterations_safety && x_current < x_end) {
-        std::cerr << "Warning (" << method_name_debug << "): Max iterations (" << max_iterations_safety
-                  << ") reached. Solution might be incomplete. x_current = " << x_current << std::endl;
-    }
+// Множитель правой части e^x / (1 + e^x): y' = logistic(x) / y.
+// Зависит только от x, поэтому заменяется аппроксимацией Чебышева на [X0, XN].
+double logistic(double x) {
+    return std::exp(x) / (1.0 + std::exp(x));
 }
 
+// Параметры выбора шага задачи
+OdeStepControl step_control() {
+    OdeStepControl control;
+    control.h_min = H_MIN_ALLOWED;
+    control.h_max = H_MAX_ALLOWED;
+    control.safety_factor = SAFETY_FACTOR;
+    control.grow_limit = GROW_LIMIT_FACTOR;
+    control.shrink_limit = SHRINK_LIMIT_FACTOR;
+    return control;
+}
 
 // --- Функция для вывода результатов в виде таблицы ---
 void print_results_table(const std::string& method_name,
@@ -243,24 +180,45 @@ void print_results_table(const std::string& method_name,
      std::cout << " (Обычно глобальная ошибка для метода порядка p при контроле локальной погрешности eps ~ O(eps) или чуть хуже)" << std::endl;
 }
 
-int main() {
-    std::vector<double> x_euler_cauchy, y_euler_cauchy;
-    long long f_evals_ec = 0;
-
-    std::vector<double> x_rk4, y_rk4;
-    long long f_evals_rk4 = 0;
+int main(int argc, char** argv) {
+    OdeSolution euler_cauchy, rk4, dp54, bs32;
+    OdeWorkspace workspace(1);
+    const OdeStepControl control = step_control();
+    const double y_start[] = {Y0};
 
     std::cout << "Решение ОДУ y' = e^x / ((1 + e^x)y) на [" << X0 << ", " << XN << "]" << std::endl;
     std::cout << "y(" << X0 << ") = " << Y0 << ", epsilon (для контроля локальной погрешности) = " << EPSILON
               << ", H_initial = " << H_INITIAL << std::endl;
 
     // Решение методом Эйлера-Коши
-    solve_ode_auto_step("Euler-Cauchy", euler_cauchy_step, 2, derivative, X0, Y0, XN, H_INITIAL, EPSILON,
-                        x_euler_cauchy, y_euler_cauchy, f_evals_ec);
+    const OdeStats ec_stats = solve_ode_auto_step(EulerCauchyStepper{}, derivative_system, X0, y_start, XN, H_INITIAL, EPSILON,
+                                                  euler_cauchy, workspace, control);
 
     // Решение методом Рунге-Кутты 4
-    solve_ode_auto_step("Runge-Kutta 4", runge_kutta_4_step, 4, derivative, X0, Y0, XN, H_INITIAL, EPSILON,
-                        x_rk4, y_rk4, f_evals_rk4);
+    const OdeStats rk4_stats = solve_ode_auto_step(RungeKutta4Stepper{}, derivative_system, X0, y_start, XN, H_INITIAL, EPSILON,
+                                                   rk4, workspace, control);
+
+    // Вложенные методы: оценка погрешности из одного шага, PI-регулятор шага
+    const OdeStats dp54_stats = solve_ode_auto_step(DORMAND_PRINCE_54, derivative_system, X0, y_start, XN, H_INITIAL, EPSILON,
+                                                    dp54, workspace, control);
+    // Шаги метода Богацкого-Шампина записываются в трассу и выводятся после сравнения методов
+    TraceBuffer bs32_trace(256);
+    OdeStats bs32_stats;
+    {
+        TraceScope tracing(bs32_trace);
+        bs32_stats = solve_ode_auto_step(BOGACKI_SHAMPINE_32, derivative_system, X0, y_start, XN, H_INITIAL, EPSILON,
+                                         bs32, workspace, control);
+    }
+
+    // Система размерности 1: значения y в узлах лежат подряд
+    const std::vector<double>& x_euler_cauchy = euler_cauchy.x;
+    const std::vector<double>& y_euler_cauchy = euler_cauchy.y;
+    const std::vector<double>& x_rk4 = rk4.x;
+    const std::vector<double>& y_rk4 = rk4.y;
+    const long long f_evals_ec = ec_stats.f_evaluations;
+    const long long f_evals_rk4 = rk4_stats.f_evaluations;
+    const long long f_evals_dp54 = dp54_stats.f_evaluations;
+    const long long f_evals_bs32 = bs32_stats.f_evaluations;
 
     // Точное значение в конечной точке
     double y_xn_exact_val = exact_solution(XN);
@@ -268,16 +226,117 @@ int main() {
     // Пункт 2 и 3: Вывод результатов и сравнение
     print_results_table("Метод Эйлера-Коши (с автовыбором шага)", x_euler_cauchy, y_euler_cauchy, f_evals_ec, y_xn_exact_val, EPSILON);
     print_results_table("Метод Рунге-Кутты 4 (с автовыбором шага)", x_rk4, y_rk4, f_evals_rk4, y_xn_exact_val, EPSILON);
+    print_results_table("Метод Дормана-Принса 5(4) (вложенная оценка, PI-регулятор)", dp54.x, dp54.y, f_evals_dp54, y_xn_exact_val, EPSILON);
+    print_results_table("Метод Богацкого-Шампина 3(2) (вложенная оценка, PI-регулятор)", bs32.x, bs32.y, f_evals_bs32, y_xn_exact_val, EPSILON);
 
     std::cout << "\n--- Сравнение общего числа вычислений f(x,y) (Пункт 2) ---" << std::endl;
     std::cout << "Метод Эйлера-Коши: " << f_evals_ec << " вызовов f(x,y)" << std::endl;
     std::cout << "Метод Рунге-Кутты 4: " << f_evals_rk4 << " вызовов f(x,y)" << std::endl;
+    std::cout << "Метод Дормана-Принса 5(4): " << f_evals_dp54 << " вызовов f(x,y)" << std::endl;
+    std::cout << "Метод Богацкого-Шампина 3(2): " << f_evals_bs32 << " вызовов f(x,y)" << std::endl;
 
     std::cout << "\n--- Сравнение числа успешных шагов (Пункт 2) ---" << std::endl;
-    std::cout << "Метод Эйлера-Коши: " << (x_euler_cauchy.empty() ? 0 : x_euler_cauchy.size() - 1) << " шагов" << std::endl;
-    std::cout << "Метод Рунге-Кутты 4: " << (x_rk4.empty() ? 0 : x_rk4.size() - 1) << " шагов" << std::endl;
+    std::cout << "Метод Эйлера-Коши: " << euler_cauchy.steps() << " шагов" << std::endl;
+    std::cout << "Метод Рунге-Кутты 4: " << rk4.steps() << " шагов" << std::endl;
+    std::cout << "Метод Дормана-Принса 5(4): " << dp54.steps() << " шагов" << std::endl;
+    std::cout << "Метод Богацкого-Шампина 3(2): " << bs32.steps() << " шагов" << std::endl;
+
+    std::cout << "\n--- Трасса шагов метода Богацкого-Шампина 3(2) (x - конец шага, residual - оценка погрешности) ---" << std::endl;
+    std::cout << std::scientific << std::setprecision(3);
+    bs32_trace.dump(std::cout);
+    std::cout << std::fixed << std::setprecision(7);
+
+    // Плотный вывод: значения на равномерной сетке по эрмитову интерполянту шагов,
+    // траектория не сохраняется, шаг метода к сетке не привязывается
+    constexpr int DENSE_POINTS = 11;
+    double x_dense[DENSE_POINTS];
+    double y_dense[DENSE_POINTS];
+    for (int i = 0; i < DENSE_POINTS; ++i) {
+        x_dense[i] = X0 + (XN - X0) * i / (DENSE_POINTS - 1);
+    }
+    const OdeStats dense_stats = solve_ode_auto_step(DORMAND_PRINCE_54, derivative_system, X0, y_start, XN, H_INITIAL, EPSILON,
+                                                     OdeGridSampler(x_dense, y_dense), workspace, control);
+    std::cout << "\n--- Плотный вывод метода Дормана-Принса 5(4) (" << dense_stats.accepted_steps << " шагов, "
+              << dense_stats.f_evaluations << " вызовов f(x,y)) ---" << std::endl;
+    std::cout << "   x        y_dense      y_exact(x)   |error(x)|" << std::endl;
+    for (int i = 0; i < DENSE_POINTS; ++i) {
+        std::cout << std::setw(9) << x_dense[i] << "   "
+                  << std::setw(12) << y_dense[i] << "   "
+                  << std::setw(12) << exact_solution(x_dense[i]) << "   "
+                  << std::setw(12) << std::abs(y_dense[i] - exact_solution(x_dense[i])) << std::endl;
+    }
 
 
+    // Жесткая задача: явный вложенный метод против W-метода Розенброка
+    // (нужно только конечное значение - наблюдатель запоминает его, не сохраняя траекторию)
+    OdeStiffWorkspace stiff_workspace;
+    OdeStepControl stiff_control = control;
+    stiff_control.h_max = std::numeric_limits<double>::infinity();
+    double y_stiff_dp54 = 0.0, y_stiff_ros2 = 0.0;
+    const OdeStats stiff_dp54 = solve_ode_auto_step(DORMAND_PRINCE_54, stiff_derivative, X0, y_start, XN, H_INITIAL, EPSILON,
+                                                    [&](const OdeStep& step) { y_stiff_dp54 = step.y_end[0]; },
+                                                    workspace, stiff_control);
+    const OdeStats stiff_ros2 = solve_ode_stiff(stiff_derivative, stiff_jacobian, X0, y_start, XN, H_INITIAL, EPSILON,
+                                                [&](const OdeStep& step) { y_stiff_ros2 = step.y_end[0]; },
+                                                stiff_workspace, stiff_control);
+
+    std::cout << "\n--- Жесткая задача y' = -" << std::setprecision(0) << STIFF_LAMBDA << std::setprecision(7)
+              << "(y - cos x) - sin x, y(0) = 1 ---" << std::endl;
+    std::cout << "Метод Дормана-Принса 5(4): " << stiff_dp54.accepted_steps << " шагов, "
+              << stiff_dp54.f_evaluations << " вызовов f(x,y), погрешность в x_n "
+              << std::abs(y_stiff_dp54 - std::cos(XN)) << std::endl;
+    std::cout << "W-метод Розенброка ROS2:   " << stiff_ros2.accepted_steps << " шагов, "
+              << stiff_ros2.f_evaluations << " вызовов f(x,y), " << stiff_ros2.jacobian_evaluations
+              << " матриц Якоби, " << stiff_ros2.factorizations << " LU-разложений, погрешность в x_n "
+              << std::abs(y_stiff_ros2 - std::cos(XN)) << std::endl;
+
+    // Ансамбль начальных условий: каждая траектория со своим шагом (Дорман-Принс) и все синхронно
+    // с постоянным шагом (Рунге-Кутта 4); результаты - в SoA-буферах, траектории - в пуле потоков
+    std::vector<double> ensemble_y0(ENSEMBLE_SIZE), ensemble_adaptive(ENSEMBLE_SIZE), ensemble_fixed(ENSEMBLE_SIZE);
+    std::vector<OdeStats> ensemble_stats(ENSEMBLE_SIZE);
+    for (std::size_t e = 0; e < ENSEMBLE_SIZE; ++e) {
+        ensemble_y0[e] = ENSEMBLE_Y0_MIN + (ENSEMBLE_Y0_MAX - ENSEMBLE_Y0_MIN) * e / (ENSEMBLE_SIZE - 1);
+    }
+    solve_ode_ensemble(DORMAND_PRINCE_54, ensemble_derivative, X0, XN, H_INITIAL, EPSILON, 1, ENSEMBLE_SIZE,
+                       ensemble_y0, ensemble_adaptive, ensemble_stats, default_thread_pool(), control);
+    solve_ode_ensemble_fixed(RungeKutta4Stepper{}, ensemble_batch_derivative, X0, XN, ENSEMBLE_FIXED_STEPS,
+                             1, ENSEMBLE_SIZE, ensemble_y0, ensemble_fixed);
+    double ensemble_adaptive_error = 0.0, ensemble_fixed_error = 0.0;
+    long long ensemble_f_evals = 0;
+    for (std::size_t e = 0; e < ENSEMBLE_SIZE; ++e) {
+        const double y_exact = exact_solution_from(XN, ensemble_y0[e]);
+        ensemble_adaptive_error = std::max(ensemble_adaptive_error, std::abs(ensemble_adaptive[e] - y_exact));
+        ensemble_fixed_error = std::max(ensemble_fixed_error, std::abs(ensemble_fixed[e] - y_exact));
+        ensemble_f_evals += ensemble_stats[e].f_evaluations;
+    }
+    std::cout << "\n--- Ансамбль из " << ENSEMBLE_SIZE << " начальных условий y0 в [" << ENSEMBLE_Y0_MIN << ", "
+              << ENSEMBLE_Y0_MAX << "] ---" << std::endl;
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "Метод Дормана-Принса 5(4), свой шаг у каждой траектории: макс. погрешность в x_n "
+              << ensemble_adaptive_error << ", " << ensemble_f_evals << " вызовов f(x,y)" << std::endl;
+    std::cout << "Метод Рунге-Кутты 4, " << ENSEMBLE_FIXED_STEPS << " синхронных шагов: макс. погрешность в x_n "
+              << ensemble_fixed_error << std::endl;
+
+    // Тот же ансамбль с аппроксимацией множителя e^x / (1 + e^x): экспоненты вычисляются только при построении
+    const ChebyshevApproximation logistic_approx = build_chebyshev(logistic, X0, XN, 1e-14);
+    auto ensemble_approx_derivative = [&logistic_approx](std::size_t, double x, std::span<const double> y,
+                                                         std::span<double> dy) {
+        dy[0] = logistic_approx(x) / y[0];
+    };
+    std::vector<double> ensemble_approx(ENSEMBLE_SIZE);
+    solve_ode_ensemble(DORMAND_PRINCE_54, ensemble_approx_derivative, X0, XN, H_INITIAL, EPSILON, 1, ENSEMBLE_SIZE,
+                       ensemble_y0, ensemble_approx, {}, default_thread_pool(), control);
+    double ensemble_approx_error = 0.0, ensemble_approx_deviation = 0.0;
+    for (std::size_t e = 0; e < ENSEMBLE_SIZE; ++e) {
+        ensemble_approx_error = std::max(ensemble_approx_error,
+                                         std::abs(ensemble_approx[e] - exact_solution_from(XN, ensemble_y0[e])));
+        ensemble_approx_deviation = std::max(ensemble_approx_deviation, std::abs(ensemble_approx[e] - ensemble_adaptive[e]));
+    }
+    std::cout << "Метод Дормана-Принса 5(4) с аппроксимацией Чебышева множителя (" << logistic_approx.pieces()
+              << " кусков степени " << logistic_approx.degree() << "): макс. погрешность в x_n " << ensemble_approx_error
+              << ", отличие от расчета с exp " << ensemble_approx_deviation << std::endl;
+    std::cout << std::fixed << std::setprecision(7);
+
     // Пункт 4: Данные для построения графиков
     std::cout << "\n\n--- Данные для построения графиков (Пункт 4) ---" << std::endl;
     std::cout << "Скопируйте эти данные в инструмент для построения графиков (например, Python с Matplotlib, Excel, Gnuplot и т.д.)." << std::endl;
@@ -304,5 +363,20 @@ int main() {
         std::cout << x_rk4[i] << ", " << y_rk4[i] << std::endl;
     }
 
+    // Траектория метода Дормана-Принса - в двоичный файл (путь - первый аргумент), по мере принятия шагов
+    if (argc > 1) {
+        try {
+            OdeTrajectoryWriter trajectory(argv[1]);
+            solve_ode_auto_step(DORMAND_PRINCE_54, derivative_system, X0, y_start, XN, H_INITIAL, EPSILON,
+                                trajectory, workspace, control);
+            trajectory.close();
+            std::cout << "\n# Траектория Dormand-Prince (" << trajectory.rows() << " точек) записана в " << argv[1]
+                      << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка записи траектории: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
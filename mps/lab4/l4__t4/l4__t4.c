@@ -1,21 +1,57 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/sleep.h>
 
-#define BUTTON_SHOW 0
+#define BUTTON_SHOW PD2
+#define DEBOUNCE_OCR 71
 
 const unsigned int ubrrValue = 23;
 
 #define DATA_LENGTH 3
 unsigned char data[DATA_LENGTH] = { 0 };
 
-uint8_t receivedBytes = 0;
+volatile uint8_t receivedBytes = 0;
+
+#define EVENT_MSG_COMPLETE (1<<0)
+#define EVENT_BUTTON       (1<<1)
+
+volatile uint8_t pendingEvents = 0;
+
+static inline void post_event(uint8_t event) {
+   pendingEvents |= event;
+}
 
 ISR(USART_RX_vect) {
+   unsigned char byte = UDR;
    if (receivedBytes < DATA_LENGTH) {
-      data[receivedBytes++] = UDR;
+      data[receivedBytes++] = byte;
+      if (receivedBytes == DATA_LENGTH)
+	 post_event(EVENT_MSG_COMPLETE);
    }
 }
 
+uint8_t buttonPressed = 0;
+
+ISR(INT0_vect) {
+   GICR &= ~(1<<INT0);
+   TCNT0 = 0;
+   TCCR0 = (1<<WGM01) | (1<<CS02) | (1<<CS00);
+}
+
+ISR(TIMER0_COMP_vect) {
+   if (!(PIND & (1<<BUTTON_SHOW))) {
+      if (!buttonPressed) {
+	 buttonPressed = 1;
+	 post_event(EVENT_BUTTON);
+      }
+      return;
+   }
+   buttonPressed = 0;
+   TCCR0 = 0;
+   GIFR = (1<<INTF0);
+   GICR |= (1<<INT0);
+}
+
 int main() {
    UBRRH = (unsigned char)(ubrrValue>>8);
    UBRRL = (unsigned char)ubrrValue;
@@ -24,20 +60,40 @@ int main() {
 
    UCSRC = (1<<URSEL) | (3<<UCSZ0);
 
-   PORTB = (1<<BUTTON_SHOW);
+   PORTD = (1<<BUTTON_SHOW);
 
    DDRC = 0xFF;
 
    PORTC = 0xFF;
 
+   MCUCR = (1<<ISC01);
+   GICR = (1<<INT0);
+   OCR0 = DEBOUNCE_OCR;
+   TIMSK = (1<<OCIE0);
+
+   ACSR = (1<<ACD);
+   set_sleep_mode(SLEEP_MODE_IDLE);
+
    sei();
    uint8_t i = 0; 
 
    while (1) {
-      if (!(PINB & (1<<BUTTON_SHOW))) {
-	 while (!(PINB & (1<<BUTTON_SHOW)))
-	 ;
+      cli();
+      uint8_t events = pendingEvents;
+      pendingEvents = 0;
+      if (!events) {
+	 sleep_enable();
+	 sei();
+	 sleep_cpu();
+	 sleep_disable();
+	 continue;
+      }
+      sei();
+
+      if (events & EVENT_MSG_COMPLETE)
+	 i = 0;
 
+      if (events & EVENT_BUTTON) {
 	 PORTC = ~data[i];
 	 i = (i + 1) % DATA_LENGTH;
       }
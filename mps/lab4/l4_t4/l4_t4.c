@@ -1,19 +1,152 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/sleep.h>
 
-#define BUTTON_SHOW 0
+#define BUTTON_SHOW PD2
+#define DEBOUNCE_OCR 71
 
 const unsigned int ubrrValue = 23;
 
-#define DATA_LENGTH 3
-unsigned char data[DATA_LENGTH] = { 0 };
+#define FRAME_START 0x7E
+#define FRAME_MAX_LENGTH 16
+/*   ( task2/task3  uart_write  )  
+   RAW_LENGTH    ;  0x7E      */
+#define RAW_LENGTH 3
 
-uint8_t receivedBytes = 0;
+#define RX_BUFFER_SIZE 64
+#define RX_BUFFER_MASK (RX_BUFFER_SIZE - 1)
+
+volatile unsigned char rxBuffer[RX_BUFFER_SIZE];
+volatile uint8_t rxHead = 0;
+volatile uint8_t rxTail = 0;
+
+volatile uint8_t overrunErrors = 0;
+volatile uint8_t framingErrors = 0;
+uint8_t crcErrors = 0;
+
+unsigned char data[FRAME_MAX_LENGTH] = { 0 };
+uint8_t dataLength = 0;
+
+#define EVENT_RX     (1<<0)
+#define EVENT_BUTTON (1<<1)
+
+volatile uint8_t pendingEvents = 0;
+
+static inline void post_event(uint8_t event) {
+   pendingEvents |= event;
+}
 
 ISR(USART_RX_vect) {
-   if (receivedBytes < DATA_LENGTH) {
-      data[receivedBytes++] = UDR;
+   uint8_t status = UCSRA;
+   unsigned char byte = UDR;
+   if (status & (1<<FE)) {
+      framingErrors++;
+      return;
    }
+   if (status & (1<<DOR))
+      overrunErrors++;
+   uint8_t head = rxHead;
+   uint8_t next = (head + 1) & RX_BUFFER_MASK;
+   if (next == rxTail) {
+      overrunErrors++;
+      return;
+   }
+   rxBuffer[head] = byte;
+   rxHead = next;
+   post_event(EVENT_RX);
+}
+
+uint8_t uart_read(unsigned char *byte) {
+   uint8_t tail = rxTail;
+   if (tail == rxHead)
+      return 0;
+   *byte = rxBuffer[tail];
+   rxTail = (tail + 1) & RX_BUFFER_MASK;
+   return 1;
+}
+
+uint8_t crc8_update(uint8_t crc, unsigned char byte) {
+   crc ^= byte;
+   for (uint8_t bit = 0; bit < 8; bit++)
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+   return crc;
+}
+
+enum { FRAME_WAIT_START, FRAME_LENGTH, FRAME_PAYLOAD, FRAME_CRC };
+uint8_t frameState = FRAME_WAIT_START;
+uint8_t frameLength = 0;
+uint8_t frameReceived = 0;
+uint8_t frameCrc = 0;
+uint8_t rawReceived = 0;
+unsigned char frame[FRAME_MAX_LENGTH];
+
+uint8_t frame_parse(unsigned char byte) {
+   switch (frameState) {
+   case FRAME_WAIT_START:
+      if (byte == FRAME_START) {
+         rawReceived = 0;
+         frameState = FRAME_LENGTH;
+         break;
+      }
+      frame[rawReceived++] = byte;
+      if (rawReceived < RAW_LENGTH)
+         break;
+      rawReceived = 0;
+      for (uint8_t k = 0; k < RAW_LENGTH; k++)
+         data[k] = frame[k];
+      dataLength = RAW_LENGTH;
+      return 1;
+   case FRAME_LENGTH:
+      if (byte == 0 || byte > FRAME_MAX_LENGTH) {
+         crcErrors++;
+         frameState = (byte == FRAME_START) ? FRAME_LENGTH : FRAME_WAIT_START;
+         break;
+      }
+      frameLength = byte;
+      frameReceived = 0;
+      frameCrc = crc8_update(0, byte);
+      frameState = FRAME_PAYLOAD;
+      break;
+   case FRAME_PAYLOAD:
+      frame[frameReceived++] = byte;
+      frameCrc = crc8_update(frameCrc, byte);
+      if (frameReceived == frameLength)
+         frameState = FRAME_CRC;
+      break;
+   case FRAME_CRC:
+      frameState = FRAME_WAIT_START;
+      if (byte != frameCrc) {
+         crcErrors++;
+         break;
+      }
+      for (uint8_t k = 0; k < frameLength; k++)
+         data[k] = frame[k];
+      dataLength = frameLength;
+      return 1;
+   }
+   return 0;
+}
+
+uint8_t buttonPressed = 0;
+
+ISR(INT0_vect) {
+   GICR &= ~(1<<INT0);
+   TCNT0 = 0;
+   TCCR0 = (1<<WGM01) | (1<<CS02) | (1<<CS00);
+}
+
+ISR(TIMER0_COMP_vect) {
+   if (!(PIND & (1<<BUTTON_SHOW))) {
+      if (!buttonPressed) {
+	 buttonPressed = 1;
+	 post_event(EVENT_BUTTON);
+      }
+      return;
+   }
+   buttonPressed = 0;
+   TCCR0 = 0;
+   GIFR = (1<<INTF0);
+   GICR |= (1<<INT0);
 }
 
 int main() {
@@ -24,25 +157,49 @@ int main() {
 
    UCSRC = (1<<URSEL) | (3<<UCSZ0);
 
-   PORTB = (1<<BUTTON_SHOW);
+   PORTD = (1<<BUTTON_SHOW);
 
    DDRC = 0xFF;
 
    PORTC = 0xFF;
 
+   MCUCR = (1<<ISC01);
+   GICR = (1<<INT0);
+   OCR0 = DEBOUNCE_OCR;
+   TIMSK = (1<<OCIE0);
+
+   ACSR = (1<<ACD);
+   set_sleep_mode(SLEEP_MODE_IDLE);
+
    sei();
    uint8_t i = 0; 
+   unsigned char byte;
 
    while (1) {
-      if (!(PINB & (1<<BUTTON_SHOW))) {
-	 while (!(PINB & (1<<BUTTON_SHOW)))
-	 ;
+      cli();
+      uint8_t events = pendingEvents;
+      pendingEvents = 0;
+      if (!events) {
+	 sleep_enable();
+	 sei();
+	 sleep_cpu();
+	 sleep_disable();
+	 continue;
+      }
+      sei();
+
+      if (events & EVENT_RX) {
+	 while (uart_read(&byte)) {
+	    if (frame_parse(byte))
+	       i = 0;
+	 }
+      }
 
+      if ((events & EVENT_BUTTON) && dataLength > 0) {
 	 PORTC = ~data[i];
-	 i = (i + 1) % DATA_LENGTH;
+	 i = (i + 1) % dataLength;
       }
    }
    
    return 0;
 }
-
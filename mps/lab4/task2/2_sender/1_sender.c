@@ -1,50 +1,123 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <stdbool.h>
+
+/*  START - PB0 */
 #define BUTTON_START 0
+/*     : 3,6864  / 1024 / (71 + 1) = 50 , .. 20  */
+#define DEBOUNCE_OCR 71
+
+/*   UBRR  f_clk = 3,69  (3,6864 , U2X = 0):
+UBRR = f_clk / (16 * ) - 1,   0%     */
+enum {
+	BAUD_2400,
+	BAUD_4800,
+	BAUD_9600,
+	BAUD_19200,
+	BAUD_38400,
+	BAUD_57600,
+	BAUD_115200,
+	BAUD_230400
+};
+const unsigned char ubrrTable[] = {95, 47, 23, 11, 5, 3, 1, 0};
 
-const unsigned int ubrrValue = 23;
+/*    */
+#define UART_BAUD BAUD_9600
 
+/*   */
 #define DATA_LENGTH 3
+
 const unsigned char data[DATA_LENGTH] = {65, 86, 82};
 
-uint8_t counter = 0;
-bool flag = false;
+/*   .  -  ,    .
+   uart_write ( ),  -   UDRE,
+           */
+#define TX_BUFFER_SIZE 32
+#define TX_BUFFER_MASK (TX_BUFFER_SIZE - 1)
 
+volatile unsigned char txBuffer[TX_BUFFER_SIZE];
+volatile uint8_t txHead = 0;
+volatile uint8_t txTail = 0;
 
+/*   :     .
+  -  UDRE     */
 ISR(USART_UDRE_vect) {
-   if (flag)
-      UDR = data[counter++];
+	uint8_t tail = txTail;
+	if (tail == txHead) {
+		UCSRB &= ~(1<<UDRIE);
+		return;
+	}
+	UDR = txBuffer[tail];
+	txTail = (tail + 1) & TX_BUFFER_MASK;
+}
+
+/*  len      .
+    ( len,   ) */
+uint8_t uart_write(const unsigned char *buf, uint8_t len) {
+	uint8_t head = txHead;
+	uint8_t written = 0;
+	while (written < len) {
+		uint8_t next = (head + 1) & TX_BUFFER_MASK;
+		if (next == txTail)
+			break;
+		txBuffer[head] = buf[written++];
+		head = next;
+	}
+	txHead = head;
+	/*   UDRE:     */
+	UCSRB |= (1<<UDRIE);
+	return written;
+}
+
+/*       */
+uint8_t uart_tx_free(void) {
+	return (txTail - txHead - 1) & TX_BUFFER_MASK;
 }
 
 int main() {
+	/*  UART */
+	/*    */
+	UBRRH = 0;
+	UBRRL = ubrrTable[UART_BAUD];
 
-   UBRRH = (unsigned char)(ubrrValue>>8);
-   UBRRL = (unsigned char) ubrrValue;
+	/*    */
+	UCSRB = (1<<TXEN);
 
-   UCSRB = (1<<TXEN) | (1<<UDRIE);
-   UCSRC = (1<<URSEL) | (3<<UCSZ0);
+	/*   : 8  , 1   */
+	UCSRC = (1<<URSEL) | (3<<UCSZ0);
 
-   PORTB = (1<<BUTTON_START);
+	/*   - */
+	/*  PB0   */
+	PORTB = (1<<BUTTON_START);
 
-   sei();
-   
- while (1) {
-	 if (!(PINB & (1<<BUTTON_START))) {
-	 	while (!(PINB & (1 << BUTTON_START)))
-		;
-		
-		flag = true;
-		while (counter < 3)
-		;
+	/* Timer0   CTC:  OCF0   20  -    */
+	OCR0 = DEBOUNCE_OCR;
+	TCCR0 = (1<<WGM01) | (1<<CS02) | (1<<CS00);
 
-		counter = 0;
-		
-	 } 
+	sei();
 
+	/*        (1 - ) */
+	uint8_t buttonReleased = 1;
+	uint8_t lastSample = 1;
 
-	 flag = false;
-	 
- }
- return 0;
+	/*  :        */
+	while (1) {
+		if (!(TIFR & (1<<OCF0)))
+			continue;
+		TIFR = (1<<OCF0);
+		/*   ,      (20 ) :
+		      */
+		uint8_t sample = (PINB & (1<<BUTTON_START)) ? 1 : 0;
+		uint8_t stable = (sample == lastSample);
+		lastSample = sample;
+		if (!stable || sample == buttonReleased)
+			continue;
+		uint8_t released = sample;
+		/*   -       */
+		if (buttonReleased && !released) {
+			if (uart_tx_free() >= DATA_LENGTH)
+				uart_write(data, DATA_LENGTH);
+		}
+		buttonReleased = released;
+	}
+	return 0;
 }